@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench_corpus.h"
+#include <stdio.h>
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+// 值使用的字符
+static const char bench_corpus_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-./:";
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+uint32_t bench_random(uint32_t *state)
+{
+    uint32_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+void bench_corpus_group(char *buffer, size_t max, unsigned index)
+{
+    snprintf(buffer, max, "group_%u", index);
+}
+
+void bench_corpus_key(char *buffer, size_t max, unsigned index)
+{
+    snprintf(buffer, max, "key_%u", index);
+}
+
+bool bench_corpus_write(const bench_corpus_t *corpus, const char *path, uint32_t seed, size_t *size)
+{
+    FILE *fd = fopen(path, "wb");
+    if (!fd) {
+        return false;
+    }
+
+    uint32_t state = seed ? seed : 1;
+    unsigned count = 0;
+    char     name[64];
+    char     value[1024];
+    for (unsigned group = 0; group < corpus->groups; ++group) {
+        bench_corpus_group(name, sizeof(name), group);
+        fprintf(fd, "[%s]\n", name);
+        for (unsigned key = 0; key < corpus->keys; ++key) {
+            if (corpus->comment_every && ++count % corpus->comment_every == 0) {
+                fprintf(fd, "; comment %u\n", count);
+            }
+            const unsigned range  = corpus->value_max - corpus->value_min + 1;
+            unsigned       length = corpus->value_min + bench_random(&state) % range;
+            if (length >= sizeof(value)) {
+                length = sizeof(value) - 1;
+            }
+            for (unsigned index = 0; index < length; ++index) {
+                value[index] = bench_corpus_chars[bench_random(&state) % (sizeof(bench_corpus_chars) - 1)];
+            }
+            value[length] = '\0';
+            bench_corpus_key(name, sizeof(name), key);
+            fprintf(fd, "%s=%s\n", name, value);
+        }
+        fputc('\n', fd);
+    }
+
+    const long end  = ftell(fd);
+    const bool isok = !ferror(fd) && end >= 0;
+    if (fclose(fd) != 0 || !isok) {
+        return false;
+    }
+    if (size) {
+        *size = (size_t)end;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _BENCH_CORPUS_H
+#define _BENCH_CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core/cini.h"
+
+// 合成语料的规格
+typedef struct bench_corpus {
+    const char *name;           // 名称
+    unsigned    groups;         // 组数
+    unsigned    keys;           // 每组键数
+    unsigned    value_min;      // 值的最短长度
+    unsigned    value_max;      // 值的最长长度
+    unsigned    comment_every;  // 每隔多少个键插入一行注释, 0 表示不插入
+} bench_corpus_t;
+
+/**
+ * @brief 伪随机数 (xorshift32), 相同种子产生相同序列
+ * @param state 随机数状态, 不能为 0
+ * @return uint32_t 随机数
+ */
+uint32_t bench_random(uint32_t *state);
+
+/**
+ * @brief 生成组名称
+ * @param buffer 存储名称的缓冲区
+ * @param max 缓冲区大小
+ * @param index 组序号
+ */
+void bench_corpus_group(char *buffer, size_t max, unsigned index);
+
+/**
+ * @brief 生成键名称
+ * @param buffer 存储名称的缓冲区
+ * @param max 缓冲区大小
+ * @param index 键序号
+ */
+void bench_corpus_key(char *buffer, size_t max, unsigned index);
+
+/**
+ * @brief 按规格生成语料文件, 相同规格与种子生成的文件完全相同
+ * @param corpus 规格
+ * @param path 文件路径
+ * @param seed 随机数种子
+ * @param size 存储文件大小, 可为 NULL
+ * @return bool 成功返回true，失败返回false
+ */
+bool bench_corpus_write(const bench_corpus_t *corpus, const char *path, uint32_t seed, size_t *size);
+
+#endif
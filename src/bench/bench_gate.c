@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench_gate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#define BENCH_LINE_MAX 1024  // 基线文件中一行的最大长度
+
+/**
+ * @brief 比较数值 (qsort 回调)
+ * @param a 数值
+ * @param b 数值
+ * @return 比较结果
+ */
+static int bench_gate_compare(const void *a, const void *b);
+
+/**
+ * @brief 读取一行中的字符串字段 "name": "value"
+ * @param line 行
+ * @param name 字段名称
+ * @param buffer 存储值的缓冲区
+ * @param max 缓冲区大小
+ * @return 找到返回 true, 否则返回 false
+ */
+static inline bool bench_field_string(const char *line, const char *name, char *buffer, size_t max);
+
+/**
+ * @brief 读取一行中的数值字段 "name": value
+ * @param line 行
+ * @param name 字段名称
+ * @param value 存储值
+ * @return 找到返回 true, 否则返回 false
+ */
+static inline bool bench_field_number(const char *line, const char *name, double *value);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+double bench_median(double *values, size_t count)
+{
+    qsort(values, count, sizeof(values[0]), bench_gate_compare);
+    return count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+double bench_mad(double *values, size_t count, double median)
+{
+    for (size_t index = 0; index < count; ++index) {
+        values[index] = values[index] > median ? values[index] - median : median - values[index];
+    }
+    return bench_median(values, count);
+}
+
+bool bench_baseline_load(const char *path, bench_baseline_t *baseline)
+{
+    FILE *fd = fopen(path, "r");
+    if (!fd) {
+        return false;
+    }
+
+    bench_entry_t entry;
+    char          line[BENCH_LINE_MAX];
+    size_t        capacity = 0;
+    bool          isok     = true;
+
+    baseline->entries = NULL;
+    baseline->count   = 0;
+    while (isok && fgets(line, sizeof(line), fd)) {
+        if (!bench_field_string(line, "corpus", entry.corpus, sizeof(entry.corpus)) ||
+            !bench_field_string(line, "cache", entry.cache, sizeof(entry.cache)) ||
+            !bench_field_string(line, "operation", entry.operation, sizeof(entry.operation)) ||
+            !bench_field_number(line, "median_ns", &entry.median)) {
+            continue;
+        }
+        if (!bench_field_number(line, "mad_ns", &entry.mad)) {
+            entry.mad = 0;
+        }
+        if (!bench_field_number(line, "tolerance", &entry.tolerance)) {
+            entry.tolerance = -1;
+        }
+
+        if (baseline->count == capacity) {
+            capacity             = capacity ? capacity * 2 : 32;
+            bench_entry_t *grown = (bench_entry_t *)realloc(baseline->entries, capacity * sizeof(bench_entry_t));
+            if (!grown) {
+                isok = false;
+                break;
+            }
+            baseline->entries = grown;
+        }
+        baseline->entries[baseline->count++] = entry;
+    }
+    fclose(fd);
+
+    if (!isok || baseline->count == 0) {
+        bench_baseline_free(baseline);
+        return false;
+    }
+    return true;
+}
+
+void bench_baseline_free(bench_baseline_t *baseline)
+{
+    free(baseline->entries);
+    baseline->entries = NULL;
+    baseline->count   = 0;
+}
+
+const bench_entry_t *bench_baseline_find(const bench_baseline_t *baseline, const char *corpus, const char *cache,
+                                         const char *operation)
+{
+    for (size_t index = 0; index < baseline->count; ++index) {
+        const bench_entry_t *entry = &baseline->entries[index];
+        if (strcmp(entry->corpus, corpus) == 0 && strcmp(entry->cache, cache) == 0 &&
+            strcmp(entry->operation, operation) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+bool bench_regressed(const bench_entry_t *base, double median, double mad, double tolerance)
+{
+    const double allowed = base->tolerance >= 0 ? base->tolerance : tolerance;
+    const double noise   = base->mad > mad ? base->mad : mad;
+    return median > base->median * (1 + allowed) + BENCH_NOISE_MADS * noise;
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static int bench_gate_compare(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static inline bool bench_field_string(const char *line, const char *name, char *buffer, size_t max)
+{
+    char pattern[BENCH_NAME_MAX + 8];
+    snprintf(pattern, sizeof(pattern), "\"%s\": \"", name);
+    const char *begin = strstr(line, pattern);
+    if (!begin) {
+        return false;
+    }
+    begin += strlen(pattern);
+    const char *end = strchr(begin, '"');
+    if (!end || (size_t)(end - begin) >= max) {
+        return false;
+    }
+    memcpy(buffer, begin, (size_t)(end - begin));
+    buffer[end - begin] = '\0';
+    return true;
+}
+
+static inline bool bench_field_number(const char *line, const char *name, double *value)
+{
+    char pattern[BENCH_NAME_MAX + 8];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", name);
+    const char *begin = strstr(line, pattern);
+    if (!begin) {
+        return false;
+    }
+    begin += strlen(pattern);
+    char *end = NULL;
+    *value    = strtod(begin, &end);
+    return end != begin;
+}
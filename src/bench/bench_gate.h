@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _BENCH_GATE_H
+#define _BENCH_GATE_H
+
+#include <stddef.h>
+#include "core/cini.h"
+
+#define BENCH_NAME_MAX   32  // 语料、缓存模式与操作名称的最大长度
+#define BENCH_NOISE_MADS 3   // 变慢超过容差后, 还需超出多少倍中位数绝对偏差才判定为退化
+
+// 基线中的一项测量
+typedef struct bench_entry {
+    char   corpus[BENCH_NAME_MAX];     // 语料名称
+    char   cache[BENCH_NAME_MAX];      // 缓存模式
+    char   operation[BENCH_NAME_MAX];  // 操作
+    double median;                     // 多次重复的中位数 (纳秒)
+    double mad;                        // 中位数绝对偏差 (纳秒)
+    double tolerance;                  // 允许变慢的比例, 小于 0 表示未指定
+} bench_entry_t;
+
+// 基线
+typedef struct bench_baseline {
+    bench_entry_t *entries;  // 测量项
+    size_t         count;    // 测量项数
+} bench_baseline_t;
+
+/**
+ * @brief 计算中位数 (会对数组排序)
+ * @param values 数值
+ * @param count 数值个数, 不能为 0
+ * @return double 中位数
+ */
+double bench_median(double *values, size_t count);
+
+/**
+ * @brief 计算中位数绝对偏差 (会修改数组)
+ * @param values 数值
+ * @param count 数值个数, 不能为 0
+ * @param median 中位数
+ * @return double 中位数绝对偏差
+ */
+double bench_mad(double *values, size_t count, double median);
+
+/**
+ * @brief 读取 bench_cini 输出的 JSON 作为基线
+ * 只识别 bench_cini 自身的输出格式 (每项测量一行), 可逐项添加 tolerance 覆盖 -T (applied_tolerance 只用于报告)
+ * @param path 文件路径
+ * @param baseline 存储基线
+ * @return bool 成功返回true，失败返回false
+ */
+bool bench_baseline_load(const char *path, bench_baseline_t *baseline);
+
+/**
+ * @brief 释放基线
+ * @param baseline 基线
+ */
+void bench_baseline_free(bench_baseline_t *baseline);
+
+/**
+ * @brief 查找测量项
+ * @param baseline 基线
+ * @param corpus 语料名称
+ * @param cache 缓存模式
+ * @param operation 操作
+ * @return const bench_entry_t* 找到返回测量项, 否则返回 NULL
+ */
+const bench_entry_t *bench_baseline_find(const bench_baseline_t *baseline, const char *corpus, const char *cache,
+                                         const char *operation);
+
+/**
+ * @brief 判断是否退化
+ * 中位数超过 基线 * (1 + 容差) + BENCH_NOISE_MADS * max(基线MAD, 本次MAD) 时判定为退化
+ * @param base 基线测量项
+ * @param median 本次中位数
+ * @param mad 本次中位数绝对偏差
+ * @param tolerance 基线未指定容差时使用的容差
+ * @return bool 退化返回true，否则返回false
+ */
+bool bench_regressed(const bench_entry_t *base, double median, double mad, double tolerance);
+
+#endif
@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_corpus.h"
+#include "bench_gate.h"
+
+#ifdef __C_PLATFORM_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#ifndef PROJECT_VERSION_MAJOR
+#define PROJECT_VERSION_MAJOR 1
+#endif
+
+#ifndef PROJECT_VERSION_MINOR
+#define PROJECT_VERSION_MINOR 0
+#endif
+
+#ifndef PROJECT_VERSION_PATCH
+#define PROJECT_VERSION_PATCH 0
+#endif
+
+#ifndef PROJECT_DEBUG_FLAG
+#define PROJECT_DEBUG_FLAG 1
+#endif
+
+#define BENCH_ITERATIONS_MIN 16      // 每项操作的最少次数
+#define BENCH_ITERATIONS_MAX 100000  // 每项操作的最多次数
+#define BENCH_BUDGET_MS      200     // 每项操作的默认时间预算 (毫秒)
+#define BENCH_REPEAT_MAX     32      // 最多重复次数
+#define BENCH_TOLERANCE      25      // 默认允许变慢的百分比
+
+// 测量的操作
+enum bench_op {
+    BENCH_OP_GET = 0,      // cini_value_get
+    BENCH_OP_CONTAINS,     // cini_value_contains
+    BENCH_OP_SET,          // cini_value_set (修改已有键)
+    BENCH_OP_REMOVE,       // cini_value_remove (每次移除前重新添加, 不计时)
+    BENCH_OP_GROUP_BEGIN,  // cini_group_begin
+    BENCH_OP_LOAD,         // cini_doc_load 与 cini_doc_free (与缓存模式无关, 只在不缓存时测量)
+    BENCH_OP_COUNT,
+};
+
+// 操作名称
+static const char *const bench_op_names[BENCH_OP_COUNT] = {"get", "contains", "set", "remove", "group_begin", "load"};
+
+// 语料规格, 快速模式只运行前两项
+static const bench_corpus_t bench_corpora[] = {
+    {"small", 8, 16, 8, 24, 10},
+    {"wide", 16, 32, 256, 900, 0},
+    {"medium", 64, 64, 16, 64, 20},
+    {"large", 256, 256, 32, 128, 50},
+};
+
+// 命令行选项
+typedef struct bench_options {
+    const char *output;     // JSON 输出文件, NULL 表示标准输出
+    const char *dir;        // 语料文件目录
+    uint32_t    seed;       // 随机数种子
+    unsigned    budget_ms;  // 每项操作的时间预算 (毫秒)
+    unsigned    repeat;     // 每项操作的重复次数
+    double      tolerance;  // 基线未指定容差时允许变慢的比例
+    const char *baseline;   // 基线文件, NULL 表示不比较
+    bool        quick;      // 快速模式
+} bench_options_t;
+
+// 单项操作的统计结果
+typedef struct bench_stats {
+    size_t   iterations;  // 次数
+    uint64_t total;       // 总耗时 (纳秒)
+    uint64_t min;         // 最短耗时
+    uint64_t median;      // 中位数
+    uint64_t p90;         // 90 百分位
+    uint64_t p99;         // 99 百分位
+    uint64_t max;         // 最长耗时
+} bench_stats_t;
+
+// 一项操作在各轮中的测量结果
+typedef struct bench_result {
+    const bench_corpus_t *corpus;                  // 语料规格
+    size_t                size;                    // 语料文件大小
+    int                   cache;                   // 缓存模式
+    int                   op;                      // 操作
+    bench_stats_t         runs[BENCH_REPEAT_MAX];  // 各轮的统计结果
+} bench_result_t;
+
+/**
+ * @brief 单调时钟
+ * @return 纳秒
+ */
+static inline uint64_t bench_now(void);
+
+/**
+ * @brief 测量一项操作
+ * @param options 命令行选项
+ * @param corpus 语料规格
+ * @param path 语料文件路径
+ * @param cache 缓存模式
+ * @param op 操作
+ * @param samples 存储每次耗时的缓冲区 (BENCH_ITERATIONS_MAX 项)
+ * @param stats 存储统计结果
+ */
+static void bench_run(const bench_options_t *options, const bench_corpus_t *corpus, const char *path, int cache,
+                      int op, uint64_t *samples, bench_stats_t *stats);
+
+/**
+ * @brief 汇总一项操作的各轮结果, 与基线比较并输出
+ * @param options 命令行选项
+ * @param result 测量结果
+ * @param baseline 基线, 可为 NULL
+ * @param out JSON 输出
+ * @param first 是否为第一项结果
+ * @return 没有退化返回 true, 否则返回 false
+ */
+static bool bench_report(const bench_options_t *options, const bench_result_t *result,
+                         const bench_baseline_t *baseline, FILE *out, bool first);
+
+/**
+ * @brief 比较耗时 (qsort 回调)
+ * @param a 耗时
+ * @param b 耗时
+ * @return 比较结果
+ */
+static int bench_compare(const void *a, const void *b);
+
+/**
+ * @brief 解析命令行选项
+ * @param argc 参数数
+ * @param argv 参数
+ * @param options 存储选项
+ * @return 成功返回 0, 已处理 (帮助或版本) 返回 -1, 参数错误返回 1
+ */
+static inline int bench_options_parse(int argc, char **argv, bench_options_t *options);
+
+// 打印命令说明
+static inline void print_command_instructions(void);
+// 打印项目版本
+static inline void print_project_version(void);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+int main(int argc, char **argv)
+{
+    bench_options_t options = {NULL, ".", 1, BENCH_BUDGET_MS, 1, BENCH_TOLERANCE / 100.0, NULL, false};
+    const int       parsed  = bench_options_parse(argc, argv, &options);
+    if (parsed != 0) {
+        return parsed < 0 ? 0 : 1;
+    }
+
+    bench_baseline_t baseline = {NULL, 0};
+    if (options.baseline && !bench_baseline_load(options.baseline, &baseline)) {
+        fprintf(stderr, "bench: cannot read baseline '%s'\n", options.baseline);
+        return 1;
+    }
+    uint64_t *samples = (uint64_t *)malloc(BENCH_ITERATIONS_MAX * sizeof(uint64_t));
+    FILE     *out     = options.output ? fopen(options.output, "w") : stdout;
+    if (!samples || !out) {
+        fprintf(stderr, "bench: %s\n", samples ? "cannot open output file" : "out of memory");
+        bench_baseline_free(&baseline);
+        free(samples);
+        return 1;
+    }
+
+    fprintf(out,
+            "{\n  \"benchmark\": \"cini\",\n  \"version\": \"%d.%d.%d\",\n  \"seed\": %u,\n  \"budget_ms\": %u,\n"
+            "  \"repeat\": %u,\n",
+            PROJECT_VERSION_MAJOR, PROJECT_VERSION_MINOR, PROJECT_VERSION_PATCH, options.seed, options.budget_ms,
+            options.repeat);
+    fprintf(out, "  \"results\": [");
+
+    // 按轮重复整组测量, 使各轮结果分布在不同时段, 离散程度能反映系统状态的波动
+    static const int caches[] = {CINI_CACHE_NONE, CINI_CACHE_STAT};
+    const size_t     count    = options.quick ? 2 : sizeof(bench_corpora) / sizeof(bench_corpora[0]);
+    bench_result_t  *results  = (bench_result_t *)calloc(count * 2 * BENCH_OP_COUNT, sizeof(bench_result_t));
+    size_t           total    = 0;
+    int              err      = results ? 0 : 1;
+    for (unsigned round = 0; round < options.repeat && !err; ++round) {
+        fprintf(stderr, "bench: round %u/%u\n", round + 1, options.repeat);
+        total = 0;
+        for (size_t index = 0; index < count && !err; ++index) {
+            const bench_corpus_t *corpus = &bench_corpora[index];
+            char                  path[512];
+            size_t                size = 0;
+            snprintf(path, sizeof(path), "%s/bench_%s.ini", options.dir, corpus->name);
+
+            for (size_t mode = 0; mode < sizeof(caches) / sizeof(caches[0]); ++mode) {
+                // 每种缓存模式从相同的文件开始
+                if (!bench_corpus_write(corpus, path, options.seed, &size)) {
+                    fprintf(stderr, "bench: cannot write corpus '%s'\n", path);
+                    err = 1;
+                    break;
+                }
+                for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+                    if (op == BENCH_OP_LOAD && caches[mode] != CINI_CACHE_NONE) {
+                        continue;
+                    }
+                    bench_result_t *result = &results[total++];
+                    result->corpus         = corpus;
+                    result->size           = size;
+                    result->cache          = caches[mode];
+                    result->op             = op;
+                    bench_run(&options, corpus, path, caches[mode], op, samples, &result->runs[round]);
+                }
+            }
+            remove(path);
+        }
+    }
+    for (size_t index = 0; index < total && !err; ++index) {
+        if (!bench_report(&options, &results[index], options.baseline ? &baseline : NULL, out, index == 0)) {
+            err = 2;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout && fclose(out) != 0) {
+        err = 1;
+    }
+    if (err == 2) {
+        fprintf(stderr, "bench: performance regression against '%s'\n", options.baseline);
+    }
+    bench_baseline_free(&baseline);
+    free(results);
+    free(samples);
+    return err;
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline uint64_t bench_now(void)
+{
+#ifdef __C_PLATFORM_WIN
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static bool bench_report(const bench_options_t *options, const bench_result_t *result,
+                         const bench_baseline_t *baseline, FILE *out, bool first)
+{
+    static const char *const cache_names[] = {"none", "stat", "content"};
+    const bench_corpus_t    *corpus        = result->corpus;
+    const int                cache         = result->cache;
+    const int                op            = result->op;
+
+    // 取中位数最接近的一轮作为代表, 各轮的中位数用于计算离散程度
+    double medians[BENCH_REPEAT_MAX];
+    for (unsigned index = 0; index < options->repeat; ++index) {
+        medians[index] = (double)result->runs[index].median;
+    }
+    const double median = bench_median(medians, options->repeat);
+    const double mad    = bench_mad(medians, options->repeat, median);
+    size_t       pick   = 0;
+    for (size_t index = 1; index < options->repeat; ++index) {
+        const double distance = (double)result->runs[index].median - median;
+        const double current  = (double)result->runs[pick].median - median;
+        if (distance * distance < current * current) {
+            pick = index;
+        }
+    }
+    const bench_stats_t *stats = &result->runs[pick];
+
+    const bench_entry_t *base      = baseline ? bench_baseline_find(baseline, corpus->name, cache_names[cache],
+                                                                    bench_op_names[op])
+                                              : NULL;
+    const bool           regressed = base && bench_regressed(base, median, mad, options->tolerance);
+    fprintf(stderr, "%-8s %-5s %-12s %8zu ops  median %12.0f ns  mad %10.0f ns", corpus->name, cache_names[cache],
+            bench_op_names[op], stats->iterations, median, mad);
+    if (base) {
+        fprintf(stderr, "  baseline %12.0f ns  %+7.1f%%%s", base->median,
+                base->median > 0 ? (median / base->median - 1) * 100 : 0.0, regressed ? "  REGRESSION" : "");
+    } else if (baseline) {
+        fprintf(stderr, "  (not in baseline)");
+    }
+    fputc('\n', stderr);
+
+    const double seconds = (double)stats->total / 1e9;
+    fprintf(out,
+            "%s\n    {\"corpus\": \"%s\", \"groups\": %u, \"keys_per_group\": %u, \"value_min\": %u, \"value_max\": %u, "
+            "\"file_size\": %zu, \"cache\": \"%s\", \"operation\": \"%s\", \"iterations\": %zu, \"ops_per_sec\": %.1f, "
+            "\"latency_ns\": {\"min\": %llu, \"median\": %llu, \"mean\": %.1f, \"p90\": %llu, \"p99\": %llu, "
+            "\"max\": %llu}, \"repeat\": %u, \"median_ns\": %.1f, \"mad_ns\": %.1f, \"applied_tolerance\": %.3f",
+            first ? "" : ",", corpus->name, corpus->groups, corpus->keys, corpus->value_min, corpus->value_max,
+            result->size,
+            cache_names[cache], bench_op_names[op], stats->iterations,
+            seconds > 0 ? (double)stats->iterations / seconds : 0.0, (unsigned long long)stats->min,
+            (unsigned long long)stats->median, (double)stats->total / (double)stats->iterations,
+            (unsigned long long)stats->p90, (unsigned long long)stats->p99, (unsigned long long)stats->max,
+            options->repeat, median, mad, base && base->tolerance >= 0 ? base->tolerance : options->tolerance);
+    if (base) {
+        fprintf(out, ", \"baseline_ns\": %.1f, \"regressed\": %s", base->median, regressed ? "true" : "false");
+    }
+    // 只保留基线中逐项指定的容差, 结果另存为基线时不会覆盖 -T
+    if (base && base->tolerance >= 0) {
+        fprintf(out, ", \"tolerance\": %.3f", base->tolerance);
+    }
+    fputc('}', out);
+    return !regressed;
+}
+
+static void bench_run(const bench_options_t *options, const bench_corpus_t *corpus, const char *path, int cache,
+                      int op, uint64_t *samples, bench_stats_t *stats)
+{
+    cini_t   cini  = CINI_INITIALIZATION;
+    uint32_t state = options->seed ? options->seed : 1;
+    char     group[64];
+    char     key[64];
+    char     value[64];
+    char     buffer[1024];
+
+    cini_path_set(&cini, path);
+    cini_cache_set(&cini, cache);
+
+    const uint64_t budget = (uint64_t)options->budget_ms * 1000000ULL;
+    const uint64_t start  = bench_now();
+    size_t         count  = 0;
+    while (count < BENCH_ITERATIONS_MAX && (count < BENCH_ITERATIONS_MIN || bench_now() - start < budget)) {
+        bench_corpus_group(group, sizeof(group), bench_random(&state) % corpus->groups);
+        bench_corpus_key(key, sizeof(key), bench_random(&state) % corpus->keys);
+        snprintf(value, sizeof(value), "value_%zu", count);
+        if (op != BENCH_OP_GROUP_BEGIN && op != BENCH_OP_LOAD) {
+            cini_group_begin(&cini, group);
+        }
+        if (op == BENCH_OP_REMOVE) {
+            cini_value_set(&cini, "bench_removed", value);
+        }
+
+        const uint64_t begin = bench_now();
+        switch (op) {
+        case BENCH_OP_GET:
+            cini_value_get(&cini, key, "", buffer, sizeof(buffer));
+            break;
+        case BENCH_OP_CONTAINS:
+            cini_value_contains(&cini, key);
+            break;
+        case BENCH_OP_SET:
+            cini_value_set(&cini, key, value);
+            break;
+        case BENCH_OP_REMOVE:
+            cini_value_remove(&cini, "bench_removed");
+            break;
+        case BENCH_OP_GROUP_BEGIN:
+            cini_group_begin(&cini, group);
+            break;
+        default:
+            cini_doc_free(cini_doc_load(path));
+            break;
+        }
+        samples[count++] = bench_now() - begin;
+    }
+    cini_release(&cini);
+
+    qsort(samples, count, sizeof(samples[0]), bench_compare);
+    stats->iterations = count;
+    stats->total      = 0;
+    for (size_t index = 0; index < count; ++index) {
+        stats->total += samples[index];
+    }
+    stats->min    = samples[0];
+    stats->median = samples[count / 2];
+    stats->p90    = samples[count * 90 / 100];
+    stats->p99    = samples[count * 99 / 100];
+    stats->max    = samples[count - 1];
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static inline int bench_options_parse(int argc, char **argv, bench_options_t *options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const char *arg = argv[index];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_command_instructions();
+            return -1;
+        }
+        if (strcmp(arg, "--version") == 0 || strcmp(arg, "-v") == 0) {
+            print_project_version();
+            return -1;
+        }
+        if (strcmp(arg, "--quick") == 0 || strcmp(arg, "-q") == 0) {
+            options->quick = true;
+            continue;
+        }
+        if (index + 1 >= argc) {
+            printf("Invalid option '%s'. Use '--help' command for instructions.\n", arg);
+            return 1;
+        }
+        const char *next = argv[++index];
+        if (strcmp(arg, "-o") == 0) {
+            options->output = next;
+        } else if (strcmp(arg, "-d") == 0) {
+            options->dir = next;
+        } else if (strcmp(arg, "-s") == 0) {
+            options->seed = (uint32_t)strtoul(next, NULL, 10);
+        } else if (strcmp(arg, "-t") == 0) {
+            options->budget_ms = (unsigned)strtoul(next, NULL, 10);
+        } else if (strcmp(arg, "-r") == 0) {
+            options->repeat = (unsigned)strtoul(next, NULL, 10);
+            if (options->repeat < 1 || options->repeat > BENCH_REPEAT_MAX) {
+                printf("Invalid repeat count '%s', expected 1 to %d.\n", next, BENCH_REPEAT_MAX);
+                return 1;
+            }
+        } else if (strcmp(arg, "-b") == 0 || strcmp(arg, "--baseline") == 0) {
+            options->baseline = next;
+        } else if (strcmp(arg, "-T") == 0) {
+            options->tolerance = strtod(next, NULL) / 100;
+        } else {
+            printf("Invalid option '%s'. Use '--help' command for instructions.\n", arg);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static inline void print_command_instructions(void)
+{
+    printf("cini benchmark - Throughput and latency of the cini config library\n");
+    printf("Usage: bench_cini [options]\n");
+    printf("\nOptions:\n");
+    printf("  -h, --help: Print this help message\n");
+    printf("  -v, --version: Print version information\n");
+    printf("  -q, --quick: Only run the small corpora\n");
+    printf("  -o [file]: Write JSON results to file (default: stdout)\n");
+    printf("  -d [dir]: Directory for the generated corpus files (default: .)\n");
+    printf("  -s [seed]: Seed of the corpus generator and key choice (default: 1)\n");
+    printf("  -t [ms]: Time budget per operation in milliseconds (default: %d)\n", BENCH_BUDGET_MS);
+    printf("  -r [count]: Repeat each operation and report the median and MAD of the runs (default: 1)\n");
+    printf("  -b, --baseline [file]: Compare against a previous JSON result, exit with 2 on regression\n");
+    printf("  -T [percent]: Allowed slowdown for entries without their own tolerance (default: %d)\n",
+           BENCH_TOLERANCE);
+    printf("\nEach operation runs at least %d and at most %d times; progress is printed to stderr.\n",
+           BENCH_ITERATIONS_MIN, BENCH_ITERATIONS_MAX);
+    printf("A result is a regression when its median exceeds baseline * (1 + tolerance) + %d * MAD.\n",
+           BENCH_NOISE_MADS);
+}
+
+static inline void print_project_version(void)
+{
+    printf("cini benchmark version %d.%d.%d-%s\n", PROJECT_VERSION_MAJOR, PROJECT_VERSION_MINOR, PROJECT_VERSION_PATCH,
+           PROJECT_DEBUG_FLAG ? "debug" : "release");
+    printf("Copyright (C) 2023 Tayne\n");
+    printf("Licensed under GNU LGPL v3\n");
+}
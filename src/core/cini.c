@@ -19,27 +19,21 @@
 #include <stdio.h>
 #include <string.h>
 #include "cini.h"
+#include "cini_behind.h"
+#include "cini_journal.h"
+#include "cini_stats.h"
 
 // -------------------------[STATIC DECLARATION]-------------------------
 
-#define CINI_LINE_MAX 1024
-
 /**
  * @brief ò
  * @param self cini
  * @param group 
- * @param length ĳ
  * @param start ʼ
  * @param end 
  */
 static inline void cini_param_set(cini_t *self, const char *group, const size_t start, const size_t end);
 
-/**
- * @brief ļ
- * @param self cini
- */
-static inline bool cini_file_create(cini_t *self);
-
 /**
  * @brief Ƿ
  * @param self cini
@@ -48,50 +42,29 @@ static inline bool cini_file_create(cini_t *self);
 static inline bool cini_group_isexist(cini_t *self);
 
 /**
- * @brief 
- * @param self cini
- * @param group 
- * @param start ʼ
- * @return ҵ򷵻 true򷵻 false
- */
-static inline bool cini_group_find(cini_t *self, const char *group, const size_t start);
-
-/**
- * @brief ȡָļк
- * @param self cini
- * @param key 
- * @param length ĳ
- * @return ҵ򷵻ؼ򷵻 0
- */
-static inline size_t cini_pair_line(cini_t *self, const char *key, const size_t length);
-
-/**
- * @brief Ƴָļ
+ * @brief ĵ (ֱӷĵ, ̨д־ģʽ·سפĵ)
  * @param self cini
- * @param key 
- * @param length ĳ
+ * @param create ļʱǷ񷵻ؿĵ
+ * @return ɹĵ, 򷵻 NULL
  */
-static inline void cini_pair_remove(cini_t *self, const char *key, const size_t length);
+static inline cini_doc_t *cini_doc_open(cini_t *self, bool create);
 
 /**
- * @brief ȡֵָ
+ * @brief ĵʹ
+ * ĵ޸ʱдļ (Ƴٵύʱд, ̨д־ģʽ¼¼޸ĵļ), µǰзΧ
  * @param self cini
- * @param key 
- * @param length ĳ
- * @param buffer ڴ洢ֵĻ
- * @param max С
- * @return ҵֵƵ򷵻 true򷵻 false
+ * @param doc ĵ
+ * @param key ʵļ, 漰ʱΪ NULL
+ * @param modified ĵǷ޸
  */
-static inline bool cini_pair_value(cini_t *self, const char *key, const size_t length, char *buffer, size_t max);
+static inline void cini_doc_close(cini_t *self, cini_doc_t *doc, const char *key, bool modified);
 
 /**
- * @brief ޸ֵָ
+ * @brief ĵµǰзΧ (̨д־ģʽֻжǷ)
  * @param self cini
- * @param key 
- * @param length ĳ
- * @param value µֵ
+ * @param doc ĵ
  */
-static inline void cini_pair_modify(cini_t *self, const char *key, const size_t length, char *value);
+static inline void cini_group_refresh(cini_t *self, cini_doc_t *doc);
 
 // -------------------------[GLOBAL DEFINITION]-------------------------
 
@@ -102,18 +75,133 @@ const char *cini_path_get(cini_t *self)
 
 void cini_path_set(cini_t *self, const char *path)
 {
+    cini_release(self);
     self->path = path;
     cini_param_set(self, STR_NULL, 0, 0);
 }
 
+void cini_io_set(cini_t *self, const cini_io_t *io)
+{
+    cini_release(self);
+    self->io = io;
+    cini_param_set(self, STR_NULL, 0, 0);
+}
+
+void cini_alloc_set(cini_t *self, const cini_allocator_t *allocator)
+{
+    cini_release(self);
+    self->allocator = allocator;
+    cini_param_set(self, STR_NULL, 0, 0);
+}
+
+void cini_threads_set(cini_t *self, unsigned threads)
+{
+    self->threads = threads;
+}
+
+void cini_save_mode_set(cini_t *self, int mode)
+{
+    self->save_mode = mode;
+}
+
+bool cini_behind_set(cini_t *self, unsigned interval, size_t entries)
+{
+    if (self->txn || self->journal) {
+        return false;
+    }
+    // де޸, ֮¼ļ
+    const bool isok = cini_behind_free(self->behind);
+    self->behind    = NULL;
+    if (!interval && !entries) {
+        return isok;
+    }
+
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (doc == self->cache) {
+        self->cache = NULL;
+    }
+    if (!doc || !cini_doc_detach(doc)) {
+        cini_doc_free(doc);
+        return false;
+    }
+    self->behind = cini_behind_create(doc, self->io, self->path, &self->stats, interval, entries);
+    if (!self->behind) {
+        cini_doc_free(doc);
+        return false;
+    }
+    return isok;
+}
+
+bool cini_journal_set(cini_t *self, size_t threshold)
+{
+    if (self->txn || self->behind || (threshold && self->io)) {
+        return false;
+    }
+    // Ⱥϲе־, ֮¼ļӦʣ־
+    const bool isok = cini_journal_free(self->journal);
+    self->journal   = NULL;
+    if (!threshold) {
+        return isok;
+    }
+
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (doc == self->cache) {
+        self->cache = NULL;
+    }
+    if (!doc || !cini_doc_detach(doc)) {
+        cini_doc_free(doc);
+        return false;
+    }
+    const bool sync = (self->save_mode & CINI_SAVE_SYNC) != 0;
+    self->journal   = cini_journal_create(doc, self->path, &self->stats, threshold, sync);
+    if (!self->journal) {
+        cini_doc_free(doc);
+        return false;
+    }
+    return isok;
+}
+
+bool cini_flush(cini_t *self)
+{
+    if (self->journal) {
+        return cini_journal_flush(self->journal);
+    }
+    return cini_behind_flush(self->behind);
+}
+
+void cini_cache_set(cini_t *self, int mode)
+{
+    self->cache_mode = mode;
+    if (mode == CINI_CACHE_NONE) {
+        cini_doc_free(self->cache);
+        self->cache = NULL;
+    }
+}
+
+void cini_release(cini_t *self)
+{
+    cini_behind_free(self->behind);
+    cini_journal_free(self->journal);
+    self->behind  = NULL;
+    self->journal = NULL;
+    cini_doc_free(self->txn);
+    cini_doc_free(self->cache);
+    self->txn   = NULL;
+    self->cache = NULL;
+}
+
 void cini_group_begin(cini_t *self, const char *group)
 {
     if (!group) {
         cini_param_set(self, STR_NULL, 0, 0);
         return;
     }
-    if (!cini_group_find(self, group, 0)) {
-        cini_param_set(self, group, 0, 0);
+    cini_param_set(self, group, 0, 0);
+
+    cini_doc_t *doc = cini_doc_open(self, false);
+    if (doc) {
+        cini_group_refresh(self, doc);
+        cini_doc_close(self, doc, NULL, false);
     }
 }
 
@@ -136,18 +224,46 @@ void cini_value_get(cini_t *self, const char *key, const char *default_value, ch
         snprintf(buffer, max, "%s", default_value);
         return;
     }
-    if (!cini_pair_value(self, key, strlen(key), buffer, max)) {
-        snprintf(buffer, max, "%s", default_value);
-        return;
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_value_get(doc, self->group_name, key, default_value, buffer, max);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
     }
 }
 
+bool cini_value_view(cini_t *self, const char *key, const char **value, size_t *size)
+{
+    if (!value || !size) {
+        return false;
+    }
+    *value = NULL;
+    *size  = 0;
+    // δĵڵýʱͷ, ޷еֵ
+    if (!key || !cini_group_isexist(self) ||
+        (!self->txn && !self->behind && !self->journal && self->cache_mode == CINI_CACHE_NONE)) {
+        return false;
+    }
+    cini_doc_t *doc    = cini_doc_open(self, false);
+    bool        result = false;
+    if (doc == self->txn || doc == self->cache || self->behind || self->journal) {
+        result = cini_doc_value_view(doc, self->group_name, key, value, size);
+    }
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return result;
+}
+
 void cini_value_set(cini_t *self, const char *key, char *value)
 {
     if (!key || !value) {
         return;
     }
-    cini_pair_modify(self, key, strlen(key), value);
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
+        return;
+    }
+    cini_doc_close(self, doc, key, cini_doc_value_set(doc, self->group_name, key, value));
 }
 
 void cini_value_remove(cini_t *self, const char *key)
@@ -155,7 +271,11 @@ void cini_value_remove(cini_t *self, const char *key)
     if (!key || !cini_group_isexist(self)) {
         return;
     }
-    cini_pair_remove(self, key, strlen(key));
+    cini_doc_t *doc = cini_doc_open(self, false);
+    if (!doc) {
+        return;
+    }
+    cini_doc_close(self, doc, key, cini_doc_value_remove(doc, self->group_name, key));
 }
 
 bool cini_value_contains(cini_t *self, const char *key)
@@ -163,527 +283,311 @@ bool cini_value_contains(cini_t *self, const char *key)
     if (!key || !cini_group_isexist(self)) {
         return false;
     }
-    return cini_pair_line(self, key, strlen(key)) > 0;
+    cini_doc_t *doc    = cini_doc_open(self, false);
+    const bool  result = cini_doc_value_contains(doc, self->group_name, key);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return result;
 }
 
-// -------------------------[STATIC DEFINITION]-------------------------
-
-static inline void cini_param_set(cini_t *self, const char *group, const size_t start, const size_t end)
+int64_t cini_value_int_get(cini_t *self, const char *key, int64_t default_value)
 {
-    self->group_name  = group;
-    self->group_start = start;
-    self->group_end   = end;
+    int64_t value = default_value;
+    if (!key || !cini_group_isexist(self)) {
+        return value;
+    }
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_int_get(doc, self->group_name, key, default_value, &value);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return value;
 }
 
-static inline bool cini_file_create(cini_t *self)
+void cini_value_int_set(cini_t *self, const char *key, int64_t value)
 {
-    FILE *wfd = fopen(self->path, "w");
-    if (wfd) {
-        fclose(wfd);
-        return true;
+    if (!key) {
+        return;
+    }
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
+        return;
     }
-    return false;
+    cini_doc_close(self, doc, key, cini_doc_int_set(doc, self->group_name, key, value));
 }
 
-static inline bool cini_group_isexist(cini_t *self)
+uint64_t cini_value_uint_get(cini_t *self, const char *key, uint64_t default_value)
 {
-    return self->group_end > 0;
+    uint64_t value = default_value;
+    if (!key || !cini_group_isexist(self)) {
+        return value;
+    }
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_uint_get(doc, self->group_name, key, default_value, &value);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return value;
 }
 
-static inline bool cini_group_find(cini_t *self, const char *group, const size_t start)
+void cini_value_uint_set(cini_t *self, const char *key, uint64_t value)
 {
-    // ļ
-    FILE *rfd = fopen(self->path, "r");
-    if (!rfd) {
-        return false;
+    if (!key) {
+        return;
     }
-
-    char line_buffer[CINI_LINE_MAX] = {0};
-
-    const size_t group_length = strlen(group);
-    size_t       line_current = 0;
-    size_t       line_length  = 0;
-    size_t       group_start  = 0;
-    size_t       group_end    = 0;
-
-    // ļָƶļʼ
-    fseek(rfd, 0, SEEK_SET);
-
-    while (fgets(line_buffer, CINI_LINE_MAX, rfd)) {
-        // ǰкСʼкţ
-        if (++line_current < start) {
-            continue;
-        }
-
-        if (group_start == 0) {
-            if (line_buffer[0] != '[') {
-                continue;
-            }
-
-            line_length = strlen(line_buffer);
-
-            if (line_length > 0 && line_buffer[line_length - 1] == '\n') {
-                --line_length;
-                if (line_length > 0 && line_buffer[line_length - 1] == '\r') {
-                    --line_length;
-                }
-            }
-
-            if (line_buffer[line_length - 1] != ']') {
-                continue;
-            } else {
-                line_buffer[line_length - 1] = '\0';
-                --line_length;
-            }
-
-            if (line_length - 1 != group_length) {
-                continue;
-            }
-            if (strncmp(line_buffer + 1, group, line_length - 1) != 0) {
-                continue;
-            }
-            group_end = group_start = line_current;
-            continue;
-        }
-
-        if (line_current > group_start) {
-            if (line_buffer[0] == '[') {
-                break;
-            }
-
-            line_length = strlen(line_buffer);
-
-            if (line_length > 0 && line_buffer[line_length - 1] == '\n') {
-                --line_length;
-                if (line_length > 0 && line_buffer[line_length - 1] == '\r') {
-                    --line_length;
-                }
-            }
-
-            if (line_length == 0) {
-                continue;
-            }
-
-            group_end = line_current;
-        }
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
+        return;
     }
+    cini_doc_close(self, doc, key, cini_doc_uint_set(doc, self->group_name, key, value));
+}
 
-    // رļ
-    fclose(rfd);
-
-    if (group_start == 0) {
-        return false;
-    } else {
-        cini_param_set(self, group, group_start, group_end);
-        return true;
+double cini_value_double_get(cini_t *self, const char *key, double default_value)
+{
+    double value = default_value;
+    if (!key || !cini_group_isexist(self)) {
+        return value;
     }
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_double_get(doc, self->group_name, key, default_value, &value);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return value;
 }
 
-static inline size_t cini_pair_line(cini_t *self, const char *key, const size_t length)
+void cini_value_double_set(cini_t *self, const char *key, double value)
 {
-    // ļ
-    FILE *rfd = fopen(self->path, "r");
-    if (!rfd) {
-        return 0;
+    if (!key) {
+        return;
     }
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
+        return;
+    }
+    cini_doc_close(self, doc, key, cini_doc_double_set(doc, self->group_name, key, value));
+}
 
-    char line_buffer[CINI_LINE_MAX] = {0};
-
-    size_t line_current = 0;
-    size_t line_length  = 0;
-    size_t key_line     = 0;
-    size_t value_start  = 0;
-    bool   isok         = true;
-
-    // ļָƶļʼ
-    fseek(rfd, 0, SEEK_SET);
-
-    while (fgets(line_buffer, CINI_LINE_MAX, rfd)) {
-        // ǰкСʼкţ
-        if (++line_current < self->group_start) {
-            continue;
-        }
-        if (line_current > self->group_end) {
-            break;
-        }
-
-        if (line_buffer[0] >= '0' && line_buffer[0] <= '9') {
-        } else if (line_buffer[0] >= 'a' && line_buffer[0] <= 'z') {
-        } else if (line_buffer[0] >= 'A' && line_buffer[0] <= 'Z') {
-        } else {
-            continue;
-        }
-
-        line_length = strlen(line_buffer);
-
-        if (line_length <= length) {
-            continue;
-        }
-
-        if (line_length > 0 && line_buffer[line_length - 1] == '\n') {
-            --line_length;
-            if (line_length > 0 && line_buffer[line_length - 1] == '\r') {
-                --line_length;
-            }
-        }
+bool cini_value_bool_get(cini_t *self, const char *key, bool default_value)
+{
+    bool value = default_value;
+    if (!key || !cini_group_isexist(self)) {
+        return value;
+    }
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_bool_get(doc, self->group_name, key, default_value, &value);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return value;
+}
 
-        if (strncmp(line_buffer, key, length) != 0) {
-            continue;
-        }
+void cini_value_bool_set(cini_t *self, const char *key, bool value)
+{
+    if (!key) {
+        return;
+    }
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
+        return;
+    }
+    cini_doc_close(self, doc, key, cini_doc_bool_set(doc, self->group_name, key, value));
+}
 
-        value_start = length;
-        do {
-            if (value_start >= line_length) {
-                isok = false;
-                break;
-            } else if (line_buffer[length] == ' ') {
-                ++value_start;
-                continue;
-            } else if (line_buffer[length] == '=') {
-                key_line = line_current;
-                break;
-            } else {
-                isok = false;
-                break;
-            }
-        } while (0);
-
-        if (isok) {
-            break;
-        } else {
-            isok = true;
-            continue;
-        }
+int64_t cini_value_duration_get(cini_t *self, const char *key, int64_t default_value)
+{
+    int64_t value = default_value;
+    if (!key || !cini_group_isexist(self)) {
+        return value;
+    }
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_duration_get(doc, self->group_name, key, default_value, &value);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
     }
-    // رļ
-    fclose(rfd);
-    return key_line;
+    return value;
 }
 
-static inline void cini_pair_remove(cini_t *self, const char *key, const size_t length)
+void cini_value_duration_set(cini_t *self, const char *key, int64_t value)
 {
-    // ļ
-    FILE *rfd = fopen(self->path, "r");
-    if (!rfd) {
+    if (!key) {
+        return;
+    }
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
         return;
     }
+    cini_doc_close(self, doc, key, cini_doc_duration_set(doc, self->group_name, key, value));
+}
 
-    char wpath[128] = {0};
-    snprintf(wpath, 128, "%s.tmp", self->path);
+uint64_t cini_value_size_get(cini_t *self, const char *key, uint64_t default_value)
+{
+    uint64_t value = default_value;
+    if (!key || !cini_group_isexist(self)) {
+        return value;
+    }
+    cini_doc_t *doc = cini_doc_open(self, false);
+    cini_doc_size_get(doc, self->group_name, key, default_value, &value);
+    if (doc) {
+        cini_doc_close(self, doc, NULL, false);
+    }
+    return value;
+}
 
-    // ļ
-    FILE *wfd = fopen(wpath, "wb");
-    if (!wfd) {
-        fclose(rfd);
+void cini_value_size_set(cini_t *self, const char *key, uint64_t value)
+{
+    if (!key) {
         return;
     }
-
-    char line_buffer[CINI_LINE_MAX] = {0};
-
-    size_t line_current = 0;
-    size_t line_length  = 0;
-    size_t value_start  = 0;
-
-    // ļָƶļʼ
-    fseek(rfd, 0, SEEK_SET);
-
-    bool isput = false;
-
-    while (fgets(line_buffer, CINI_LINE_MAX, rfd)) {
-        do {
-            // ǰкСʼкţ
-            if (++line_current < self->group_start) {
-                isput = true;
-                break;
-            }
-            if (line_current > self->group_end) {
-                isput = true;
-                break;
-            }
-
-            if (line_buffer[0] >= '0' && line_buffer[0] <= '9') {
-            } else if (line_buffer[0] >= 'a' && line_buffer[0] <= 'z') {
-            } else if (line_buffer[0] >= 'A' && line_buffer[0] <= 'Z') {
-            } else {
-                isput = true;
-                break;
-            }
-
-            line_length = strlen(line_buffer);
-
-            if (line_length <= length) {
-                isput = true;
-                break;
-            }
-
-            if (line_length > 0 && line_buffer[line_length - 1] == '\n') {
-                --line_length;
-                if (line_length > 0 && line_buffer[line_length - 1] == '\r') {
-                    --line_length;
-                }
-            }
-
-            if (strncmp(line_buffer, key, length) != 0) {
-                isput = true;
-                break;
-            }
-
-            value_start = length;
-            do {
-                if (value_start >= line_length) {
-                    isput = true;
-                    break;
-                } else if (line_buffer[length] == ' ') {
-                    ++value_start;
-                    continue;
-                } else if (line_buffer[length] == '=') {
-                    --self->group_end;
-                    isput = false;
-                    break;
-                } else {
-                    isput = true;
-                    break;
-                }
-            } while (0);
-        } while (0);
-        if (isput) {
-            fputs(line_buffer, wfd);
-        }
+    cini_doc_t *doc = cini_doc_open(self, true);
+    if (!doc) {
+        return;
     }
-    // رļ
-    fclose(wfd);
-    fclose(rfd);
-    remove(self->path);
-    rename(wpath, self->path);
-    return;
+    cini_doc_close(self, doc, key, cini_doc_size_set(doc, self->group_name, key, value));
 }
 
-static inline bool cini_pair_value(cini_t *self, const char *key, const size_t length, char *buffer, const size_t max)
+bool cini_txn_begin(cini_t *self)
 {
-    // ļ
-    FILE *rfd = fopen(self->path, "r");
-    if (!rfd) {
-        buffer[0] = '\0';
+    if (self->txn || self->behind || self->journal) {
         return false;
     }
+    self->txn = cini_doc_open(self, true);
+    // ڼĵ, ύΪ
+    if (self->txn == self->cache) {
+        self->cache = NULL;
+    }
+    return self->txn != NULL;
+}
 
-    char line_buffer[CINI_LINE_MAX] = {0};
-
-    size_t line_current = 0;
-    size_t line_length  = 0;
-    size_t value_start  = 0;
-    bool   isok         = true;
-
-    // ļָƶļʼ
-    fseek(rfd, 0, SEEK_SET);
-
-    while (fgets(line_buffer, CINI_LINE_MAX, rfd)) {
-        ++line_current;
-
-        // ǰкСʼкţ
-        if (line_current < self->group_start) {
-            continue;
-        }
-        if (line_current > self->group_end) {
-            break;
-        }
-
-        if (line_buffer[0] >= '0' && line_buffer[0] <= '9') {
-        } else if (line_buffer[0] >= 'a' && line_buffer[0] <= 'z') {
-        } else if (line_buffer[0] >= 'A' && line_buffer[0] <= 'Z') {
-        } else {
-            continue;
-        }
+bool cini_txn_commit(cini_t *self)
+{
+    if (!self->txn) {
+        return false;
+    }
+    if (!cini_doc_save_stats(self->txn, self->io, self->path, self->save_mode, &self->stats)) {
+        return false;
+    }
+    if (self->cache_mode != CINI_CACHE_NONE) {
+        self->cache = self->txn;
+    } else {
+        cini_doc_free(self->txn);
+    }
+    self->txn = NULL;
+    return true;
+}
 
-        line_length = strlen(line_buffer);
+void cini_txn_abort(cini_t *self)
+{
+    if (!self->txn) {
+        return;
+    }
+    cini_doc_free(self->txn);
+    self->txn = NULL;
+
+    // ָΪļе鷶Χ
+    cini_doc_t *doc = cini_doc_open(self, false);
+    if (doc) {
+        cini_group_refresh(self, doc);
+        cini_doc_close(self, doc, NULL, false);
+    } else {
+        self->group_start = 0;
+        self->group_end   = 0;
+    }
+}
 
-        if (line_length <= length) {
-            continue;
-        }
+// -------------------------[STATIC DEFINITION]-------------------------
 
-        if (line_length > 0 && line_buffer[line_length - 1] == '\n') {
-            line_buffer[line_length - 1] = '\0';
-            --line_length;
-            if (line_length > 0 && line_buffer[line_length - 1] == '\r') {
-                line_buffer[line_length - 1] = '\0';
-                --line_length;
-            }
-        }
+static inline void cini_param_set(cini_t *self, const char *group, const size_t start, const size_t end)
+{
+    self->group_name  = group;
+    self->group_start = start;
+    self->group_end   = end;
+}
 
-        if (strncmp(line_buffer, key, length) != 0) {
-            continue;
-        }
+static inline bool cini_group_isexist(cini_t *self)
+{
+    return self->group_end > 0;
+}
 
-        value_start = length;
-        do {
-            if (value_start >= line_length) {
-                isok = false;
-                break;
-            } else if (line_buffer[length] == ' ') {
-                ++value_start;
-                continue;
-            } else if (line_buffer[value_start] == '=') {
-                ++value_start;
-                break;
-            } else {
-                isok = false;
-                break;
-            }
-        } while (0);
-
-        if (!isok) {
-            isok = true;
-            continue;
+static inline cini_doc_t *cini_doc_open(cini_t *self, bool create)
+{
+    if (self->behind) {
+        return cini_behind_enter(self->behind);
+    }
+    if (self->journal) {
+        return cini_journal_enter(self->journal);
+    }
+    if (self->txn) {
+        return self->txn;
+    }
+    if (self->cache) {
+        const bool content = self->cache_mode == CINI_CACHE_CONTENT;
+        if (!cini_doc_changed_stats(self->cache, self->io, self->path, content, &self->stats)) {
+            return self->cache;
         }
-
-        do {
-            if (value_start >= line_length) {
-                break;
-            } else if (line_buffer[value_start] == ' ') {
-                ++value_start;
-                continue;
-            }
-        } while (0);
-
-        snprintf(buffer, max, "%s", line_buffer + value_start);
-        break;
+        cini_doc_free(self->cache);
+        self->cache = NULL;
     }
-    // رļ
-    fclose(rfd);
 
-    if (!isok) {
-        buffer[0] = '\0';
+    cini_doc_t *doc = cini_doc_load_stats(self->allocator, self->io, self->path, self->threads, &self->stats);
+    if (!doc && create) {
+        doc = cini_doc_create_alloc(self->allocator);
     }
-    return isok;
+    // ĵ賤ڳ, ļӳ
+    if (doc && self->cache_mode != CINI_CACHE_NONE && cini_doc_detach(doc)) {
+        self->cache = doc;
+    }
+    return doc;
 }
 
-static inline void cini_pair_modify(cini_t *self, const char *key, const size_t length, char *value)
+static inline void cini_doc_close(cini_t *self, cini_doc_t *doc, const char *key, bool modified)
 {
-    bool isread = true;
-
-    // ļ
-    FILE *rfd = fopen(self->path, "r");
-    if (!rfd) {
-        cini_file_create(self);
-        rfd = fopen(self->path, "r");
-        if (!rfd) {
-            return;
+    // ̨дʱֻ¼޸ĵļ; ÿ½ǰ, ޸ĺֻжǷ (O(1), ¼к)
+    if (self->behind) {
+        if (modified) {
+            cini_group_refresh(self, doc);
         }
-        isread = false;
-    }
-
-    char wpath[128] = {0};
-    snprintf(wpath, 128, "%s.tmp", self->path);
-
-    // ļ
-    FILE *wfd = fopen(wpath, "wb");
-    if (!wfd) {
-        fclose(rfd);
+        cini_behind_leave(self->behind, self->group_name, modified ? key : NULL);
         return;
     }
-
-    char line_buffer[CINI_LINE_MAX] = {0};
-
-    size_t line_current = 0;
-    size_t line_length  = 0;
-    size_t value_start  = 0;
-
-    // ļָƶļʼ
-    fseek(rfd, 0, SEEK_SET);
-
-    bool ismodify = false;
-
-    while (isread && fgets(line_buffer, CINI_LINE_MAX, rfd)) {
-        do {
-            if (line_current < self->group_start) {
-                break;
-            }
-            if (line_current > self->group_end) {
-                break;
-            }
-
-            if (line_buffer[0] >= '0' && line_buffer[0] <= '9') {
-            } else if (line_buffer[0] >= 'a' && line_buffer[0] <= 'z') {
-            } else if (line_buffer[0] >= 'A' && line_buffer[0] <= 'Z') {
-            } else {
-                break;
-            }
-
-            line_length = strlen(line_buffer);
-
-            if (line_length <= length) {
-                break;
-            }
-
-            if (line_length > 0 && line_buffer[line_length - 1] == '\n') {
-                --line_length;
-                if (line_length > 0 && line_buffer[line_length - 1] == '\r') {
-                    --line_length;
-                }
-            }
-
-            if (strncmp(line_buffer, key, length) != 0) {
-                break;
-            }
-
-            value_start = length;
-            do {
-                if (value_start >= line_length) {
-                    snprintf(line_buffer, CINI_LINE_MAX, "%s=%s" STR_NEWLINE, key, value);
-                    ismodify = true;
-                    break;
-                } else if (line_buffer[length] == ' ') {
-                    ++value_start;
-                    continue;
-                } else if (line_buffer[length] == '=') {
-                    snprintf(line_buffer, CINI_LINE_MAX, "%s=%s" STR_NEWLINE, key, value);
-                    ismodify = true;
-                    break;
-                }
-            } while (0);
-        } while (0);
-
-        ++line_current;
-        fputs(line_buffer, wfd);
-
-        if (self->group_end != 0 && line_current >= self->group_end && !ismodify) {
-            ismodify = true;
-            snprintf(line_buffer, CINI_LINE_MAX, "%s=%s" STR_NEWLINE, key, value);
-            ++line_current;
-            self->group_end = line_current;
-            fputs(line_buffer, wfd);
+    // ־ģʽ½޸ĵļ׷ӵ־, ֻͬ޸ĺжǷ
+    if (self->journal) {
+        if (modified) {
+            cini_group_refresh(self, doc);
         }
+        cini_journal_leave(self->journal, self->group_name, modified ? key : NULL);
+        return;
     }
-
-    if (self->group_end == 0) {
-        ++line_current;
-        snprintf(line_buffer, CINI_LINE_MAX, STR_NEWLINE);
-        fputs(line_buffer, wfd);
-
-        ++line_current;
-        self->group_start = line_current;
-        snprintf(line_buffer, CINI_LINE_MAX, "[%s]" STR_NEWLINE, self->group_name);
-        fputs(line_buffer, wfd);
-
-        ++line_current;
-        self->group_end = line_current;
-        snprintf(line_buffer, CINI_LINE_MAX, "%s=%s" STR_NEWLINE, key, value);
-        fputs(line_buffer, wfd);
-
-        ismodify = true;
+    if (modified &&
+        (doc == self->txn || cini_doc_save_stats(doc, self->io, self->path, self->save_mode, &self->stats))) {
+        cini_group_refresh(self, doc);
     }
-
-    if (!ismodify) {
-        ++line_current;
-        self->group_end = line_current;
-        snprintf(line_buffer, CINI_LINE_MAX, "%s=%s" STR_NEWLINE, key, value);
-        fputs(line_buffer, wfd);
+    if (doc == self->txn) {
+        return;
     }
+    // дʧܵĻĵļһ, ´εʱ cini_doc_changed ж¼
+    if (doc != self->cache) {
+        cini_doc_free(doc);
+    }
+}
 
-    // رļ
-    fclose(rfd);
-    fclose(wfd);
-    remove(self->path);
-    rename(wpath, self->path);
-    return;
+static inline void cini_group_refresh(cini_t *self, cini_doc_t *doc)
+{
+    // פĵƵ޸, ¼к, ֻжǷ
+    if (self->behind || self->journal) {
+        const bool exists = cini_doc_group_find(doc, self->group_name, NULL, NULL);
+        self->group_start = exists ? SIZE_MAX : 0;
+        self->group_end   = exists ? SIZE_MAX : 0;
+        return;
+    }
+    size_t start = 0;
+    size_t end   = 0;
+    if (cini_doc_group_find(doc, self->group_name, &start, &end)) {
+        self->group_start = start;
+        self->group_end   = end;
+    } else {
+        self->group_start = 0;
+        self->group_end   = 0;
+    }
 }
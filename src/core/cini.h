@@ -20,6 +20,7 @@
 #define _CINI_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 // clang-format off
 
@@ -82,25 +83,158 @@
 
 // cini配置结构体
 typedef struct cini cini_t;
+// cini文档
+typedef struct cini_doc cini_doc_t;
+// 后台写入器
+typedef struct cini_behind cini_behind_t;
+// 修改日志
+typedef struct cini_journal cini_journal_t;
+
+// 文档缓存模式
+enum cini_cache_mode {
+    CINI_CACHE_NONE = 0,  // 不缓存, 每次调用重新读取文件
+    CINI_CACHE_STAT,      // 文件 inode、大小与修改时间不变时复用缓存
+    CINI_CACHE_CONTENT,   // 在 CINI_CACHE_STAT 基础上, 状态变化但内容哈希值相同时仍复用缓存
+};
+
+// 文档保存方式
+enum cini_save_mode {
+    CINI_SAVE_REWRITE = 0,      // 写入临时文件后替换目标文件, 中断时文件保持原内容或新内容
+    CINI_SAVE_SPLICE  = 1,      // 原地改写文件中变化的部分, 写入量小, 但中断时文件可能只被部分改写;
+                                // 文件会变短或进程内其他文档映射着该文件时整体重写, 不改变其他文档的内容
+    CINI_SAVE_SYNC    = 0x100,  // 标志, 可与以上方式组合: 写入完成后同步到存储设备 (fsync)
+};
+
+/**
+ * @brief 文件访问计数
+ * 以宽松原子操作累加, 可在其他线程中读取 (各字段之间不保证一致)
+ */
+typedef struct cini_stats {
+    uint64_t files_opened;   // 打开文件次数
+    uint64_t bytes_read;     // 读取 (或映射) 的字节数
+    uint64_t bytes_written;  // 写入的字节数
+    uint64_t lines_scanned;  // 解析的行数
+    uint64_t rewrites;       // 写入临时文件的次数
+    uint64_t renames;        // 以临时文件替换目标文件的次数
+    uint64_t splices;        // 原地改写文件的次数
+} cini_stats_t;
+
+/**
+ * @brief 内存分配器
+ * 文档的行、组、索引与修改后的文本均从分配器分配; free 为 NULL 时表示由分配器整体回收 (如竞技场),
+ * 释放文档时不再逐个释放, 只需 O(1) 时间; 此时文件内容也读入分配器的内存而不映射, 文档不持有其他资源
+ */
+typedef struct cini_allocator {
+    void *(*alloc)(void *arg, size_t size);  // 分配, 返回的内存至少按 16 字节对齐, 失败返回 NULL
+    void (*free)(void *arg, void *ptr);      // 释放, 可为 NULL
+    void *arg;                               // 分配器参数
+} cini_allocator_t;
+
+/**
+ * @brief I/O 后端
+ * 读取: open(write=false) 后反复 read 直到返回 0, 再 close;
+ * 写入: open(write=true) 打开暂存目标, 全部 write 成功后调用 replace 以写入的内容整体替换原内容,
+ * 任一步骤失败时调用 close 丢弃已写入的内容. 路径原样传给后端, 后端可自行解释或忽略
+ */
+typedef struct cini_io {
+    void *(*open)(void *arg, const char *path, bool write);           // 打开, 失败返回 NULL
+    long (*read)(void *file, char *buffer, size_t size);              // 读取, 返回字节数, 结束返回 0, 失败返回 -1
+    bool (*write)(void *file, const char *data, size_t size);         // 写入全部数据
+    bool (*replace)(void *file);                                      // 以写入的内容替换原内容, 无论成败都关闭
+    void (*close)(void *file);                                        // 关闭, 写入时丢弃已写入的内容
+    const char *(*view)(void *arg, const char *path, size_t *size);   // 可为 NULL, 返回在后端生命周期内不变的内容
+    bool (*version)(void *arg, const char *path, uint64_t *version);  // 可为 NULL, 内容版本, 版本不变时复用缓存
+    void *arg;                                                        // 后端参数
+} cini_io_t;
 
 /**
  * @brief cini配置结构体
  * 用于存储cini配置文件的路径和当前组的信息
  */
 struct cini {
-    const char *path;         // 配置文件路径
-    const char *group_name;   // 当前组名称
-    size_t      group_start;  // 当前组起始行
-    size_t      group_end;    // 当前组结束行
+    const char             *path;         // 配置文件路径
+    const char             *group_name;   // 当前组名称
+    size_t                  group_start;  // 当前组起始行 (后台写入与日志模式下不计算行号, 组存在时为 SIZE_MAX)
+    size_t                  group_end;    // 当前组结束行 (同上), 为 0 时组不存在
+    cini_doc_t             *txn;          // 当前事务文档, 未开启事务时为 NULL
+    cini_doc_t             *cache;        // 缓存的文档, 未缓存时为 NULL
+    int                     cache_mode;   // 文档缓存模式
+    cini_stats_t            stats;        // 通过该对象访问文件的计数
+    const cini_io_t        *io;           // I/O 后端, 为 NULL 时直接访问文件
+    const cini_allocator_t *allocator;    // 文档的内存分配器, 为 NULL 时使用 malloc
+    unsigned                threads;      // 解析文档的线程数, 0 或 1 表示单线程
+    cini_behind_t          *behind;       // 后台写入器, 未启用后台写入时为 NULL
+    int                     save_mode;    // 保存文档的方式
+    cini_journal_t         *journal;      // 修改日志, 未启用日志模式时为 NULL
 };
 
 #define CINI_INITIALIZATION                                                                                            \
     {                                                                                                                  \
-        .path = STR_NULL, .group_name = STR_NULL, .group_start = 0, .group_end = 0                                     \
+        .path = STR_NULL, .group_name = STR_NULL, .group_start = 0, .group_end = 0, .txn = NULL, .cache = NULL,        \
+        .cache_mode = CINI_CACHE_NONE, .stats = {0, 0, 0, 0, 0, 0, 0}, .io = NULL, .allocator = NULL, .threads = 0,   \
+        .behind = NULL, .save_mode = CINI_SAVE_REWRITE, .journal = NULL                                                \
     }
 
 #define CINI_NULL (cini_t) CINI_INITIALIZATION
 
+/**
+ * @brief 键值变化
+ * 字符串均不保证以'\0'结尾, 键新增时 old_value 为 NULL, 键移除时 new_value 为 NULL
+ */
+typedef struct cini_change {
+    const char *group;       // 组名称
+    size_t      group_size;  // 组名称长度
+    const char *key;         // 键名称
+    size_t      key_size;    // 键名称长度
+    const char *old_value;   // 原值
+    size_t      old_size;    // 原值长度
+    const char *new_value;   // 新值
+    size_t      new_size;    // 新值长度
+} cini_change_t;
+
+/**
+ * @brief 键值变化回调
+ * @param change 键值变化
+ * @param arg 用户参数
+ */
+typedef void (*cini_diff_func_t)(const cini_change_t *change, void *arg);
+
+/**
+ * @brief 文档条目 (组或键值对)
+ * 字符串均不保证以'\0'结尾, 条目为组时 key 与 value 为 NULL
+ */
+typedef struct cini_entry {
+    const char *group;       // 组名称
+    size_t      group_size;  // 组名称长度
+    const char *key;         // 键名称
+    size_t      key_size;    // 键名称长度
+    const char *value;       // 值
+    size_t      value_size;  // 值长度
+} cini_entry_t;
+
+/**
+ * @brief 文档条目回调
+ * @param entry 条目
+ * @param arg 用户参数
+ */
+typedef void (*cini_entry_func_t)(const cini_entry_t *entry, void *arg);
+
+/**
+ * @brief 预处理的键 (由 cini_key_prepare 创建)
+ * 保存组与键名称的长度与哈希值, 并缓存最近一次查找到的行; 文档没有增删键时, 再次查找只需比较文档代数.
+ * 组与键名称字符串在键使用期间必须保持有效; 同一个键不能同时在多个线程中使用
+ */
+typedef struct cini_key {
+    const char *group;         // 组名称
+    size_t      group_length;  // 组名称长度
+    uint64_t    group_hash;    // 组名称哈希值
+    const char *key;           // 键名称
+    size_t      key_length;    // 键名称长度
+    uint64_t    key_hash;      // 键名称哈希值
+    uint64_t    generation;    // 缓存对应的文档代数, 0 表示未缓存
+    const void *line;          // 缓存的行, 键不存在时为 NULL
+} cini_key_t;
+
 /**
  * @brief 获取配置文件路径
  * @param self cini指针
@@ -110,11 +244,115 @@ CINI_EXPORT const char *cini_path_get(cini_t *self);
 
 /**
  * @brief 设置配置文件路径
+ * 未提交的事务将被丢弃
  * @param self cini指针
  * @param path 配置文件路径
  */
 CINI_EXPORT void cini_path_set(cini_t *self, const char *path);
 
+/**
+ * @brief 设置 I/O 后端
+ * 未提交的事务与缓存的文档将被丢弃; 使用 CINI_CACHE_STAT 或 CINI_CACHE_CONTENT 缓存时,
+ * 后端未提供 version 则每次重新读取
+ * @param self cini指针
+ * @param io I/O 后端, 需在使用期间保持有效, 为 NULL 时恢复为直接访问文件
+ */
+CINI_EXPORT void cini_io_set(cini_t *self, const cini_io_t *io);
+
+/**
+ * @brief 设置文档的内存分配器
+ * 未提交的事务与缓存的文档将被丢弃; 分配器不逐个释放时 (free 为 NULL), 每次重新加载的文档都会
+ * 占用分配器的内存, 需由调用者在 cini_release 之后整体回收
+ * @param self cini指针
+ * @param allocator 内存分配器, 需在使用期间保持有效, 为 NULL 时恢复为 malloc
+ */
+CINI_EXPORT void cini_alloc_set(cini_t *self, const cini_allocator_t *allocator);
+
+/**
+ * @brief 设置解析文档的线程数
+ * 只影响之后加载的文档, 用于缓存的大文件 (见 cini_doc_load_parallel)
+ * @param self cini指针
+ * @param threads 线程数, 0 或 1 表示单线程
+ */
+CINI_EXPORT void cini_threads_set(cini_t *self, unsigned threads);
+
+/**
+ * @brief 设置保存文档的方式
+ * 默认整体重写; 修改大文件中的少量键时可使用 CINI_SAVE_SPLICE 只改写变化的部分 (见 cini_doc_save_mode)
+ * @param self cini指针
+ * @param mode 保存方式 (enum cini_save_mode), 可组合 CINI_SAVE_SYNC
+ */
+CINI_EXPORT void cini_save_mode_set(cini_t *self, int mode);
+
+/**
+ * @brief 设置后台写入 (仅支持 Linux 与 macOS)
+ * 启用后文档常驻内存, 写入与移除只修改内存并记录被修改的键, 由后台线程在最早一次修改满 interval 毫秒,
+ * 或待写入的不同键数达到 entries 时整体写入文件; 同一个键在写入前的多次修改只写入最后的值.
+ * 启用期间不重新读取文件 (文件的外部修改会被覆盖), 不能开启事务, cini对象不能被复制或在多个线程中使用.
+ * 关闭或切换时以及 cini_release 时先写入剩余的修改
+ * @param self cini指针
+ * @param interval 修改后最长多久写入文件 (毫秒), 0 表示不按时间写入
+ * @param entries 待写入的不同键数达到该值时立即写入, 0 表示不按键数写入; 两者都为 0 时关闭后台写入
+ * @return bool 成功返回true，事务中、日志模式下、不支持的平台、加载失败或写入剩余的修改失败返回false
+ */
+CINI_EXPORT bool cini_behind_set(cini_t *self, unsigned interval, size_t entries);
+
+/**
+ * @brief 设置日志模式 (仅支持 Linux 与 macOS, 不支持 I/O 后端)
+ * 启用后文档常驻内存, 每次写入与移除只在日志文件 "<path>.journal" 末尾追加一条记录, 不重写配置文件;
+ * 启用时先将已有的日志应用到配置文件的内容上 (丢弃末尾不完整的记录), 日志长度达到 threshold 字节时
+ * 由后台线程将文档整体写入配置文件并清空日志, 合并失败时间隔一段时间 (连续失败时加倍) 再由后台线程重试.
+ * 直接读取配置文件的程序看不到日志中的修改.
+ * 启用期间不重新读取文件, 不能开启事务或后台写入, cini对象不能被复制或在多个线程中使用;
+ * 保存方式包含 CINI_SAVE_SYNC 时每条记录写入后同步到存储设备.
+ * 关闭或切换时以及 cini_release 时先合并日志, 成功后移除日志文件
+ * @param self cini指针
+ * @param threshold 日志合并阈值 (字节), 0 表示关闭日志模式
+ * @return bool 成功返回true，事务中、后台写入模式下、不支持的平台、加载失败或合并失败返回false
+ */
+CINI_EXPORT bool cini_journal_set(cini_t *self, size_t threshold);
+
+/**
+ * @brief 在当前线程中立即写入后台写入模式下所有未写入的修改, 或将日志模式的日志合并到配置文件
+ * @param self cini指针
+ * @return bool 写入成功或没有需要写入的修改返回true，否则返回false
+ */
+CINI_EXPORT bool cini_flush(cini_t *self);
+
+/**
+ * @brief 设置文档缓存模式
+ * 开启缓存后, 文件未变化时直接复用上次解析的文档, 不再读取文件;
+ * 不再使用时需调用 cini_release 释放缓存
+ * @param self cini指针
+ * @param mode 缓存模式 (enum cini_cache_mode)
+ */
+CINI_EXPORT void cini_cache_set(cini_t *self, int mode);
+
+/**
+ * @brief 释放cini对象持有的资源 (缓存的文档与未提交的事务)
+ * @param self cini指针
+ */
+CINI_EXPORT void cini_release(cini_t *self);
+
+/**
+ * @brief 获取通过该cini对象访问文件的计数
+ * @param self cini指针
+ * @param stats 存储计数
+ */
+CINI_EXPORT void cini_stats_get(cini_t *self, cini_stats_t *stats);
+
+/**
+ * @brief 清零cini对象的文件访问计数
+ * @param self cini指针
+ */
+CINI_EXPORT void cini_stats_reset(cini_t *self);
+
+/**
+ * @brief 获取进程内所有文件访问的累计计数 (含文档、快照、映像、流式解析等接口)
+ * @param stats 存储计数
+ */
+CINI_EXPORT void cini_stats_global_get(cini_stats_t *stats);
+
 /**
  * @brief 打开组
  * @param self cini指针
@@ -146,7 +384,19 @@ CINI_EXPORT const char *cini_group_get(cini_t *self);
 CINI_EXPORT void cini_value_get(cini_t *self, const char *key, const char *default_value, char *buffer, size_t max);
 
 /**
- * @brief 设置当前组中指定键的值
+ * @brief 获取当前组中指定键的值, 不复制
+ * 仅在开启文档缓存或事务中可用, 值不以'\0'结尾,
+ * 在下一次通过该cini对象访问文件或调用 cini_release 之前保持有效
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 存储值的起始位置, 键不存在时为 NULL
+ * @param size 存储值的长度
+ * @return bool 键存在返回true，否则返回false
+ */
+CINI_EXPORT bool cini_value_view(cini_t *self, const char *key, const char **value, size_t *size);
+
+/**
+ * @brief 设置当前组中指定键的值, 组内存在多个同名键时全部修改
  * @param self cini指针
  * @param key 键名称
  * @param value 修改值
@@ -154,7 +404,7 @@ CINI_EXPORT void cini_value_get(cini_t *self, const char *key, const char *defau
 CINI_EXPORT void cini_value_set(cini_t *self, const char *key, char *value);
 
 /**
- * @brief 从当前组中移除指定键值对
+ * @brief 从当前组中移除指定键值对, 组内存在多个同名键时全部移除
  * @param self cini指针
  * @param key 键名称
  */
@@ -168,4 +418,609 @@ CINI_EXPORT void cini_value_remove(cini_t *self, const char *key);
  */
 CINI_EXPORT bool cini_value_contains(cini_t *self, const char *key);
 
+/**
+ * @brief 获取当前组中指定键的值并转换为有符号整数
+ * @param self cini指针
+ * @param key 键名称
+ * @param default_value 键不存在或转换失败时的默认值
+ * @return int64_t 转换后的值
+ */
+CINI_EXPORT int64_t cini_value_int_get(cini_t *self, const char *key, int64_t default_value);
+
+/**
+ * @brief 将当前组中指定键设置为有符号整数
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 修改值
+ */
+CINI_EXPORT void cini_value_int_set(cini_t *self, const char *key, int64_t value);
+
+/**
+ * @brief 获取当前组中指定键的值并转换为无符号整数
+ * @param self cini指针
+ * @param key 键名称
+ * @param default_value 键不存在或转换失败时的默认值
+ * @return uint64_t 转换后的值
+ */
+CINI_EXPORT uint64_t cini_value_uint_get(cini_t *self, const char *key, uint64_t default_value);
+
+/**
+ * @brief 将当前组中指定键设置为无符号整数
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 修改值
+ */
+CINI_EXPORT void cini_value_uint_set(cini_t *self, const char *key, uint64_t value);
+
+/**
+ * @brief 获取当前组中指定键的值并转换为浮点数
+ * @param self cini指针
+ * @param key 键名称
+ * @param default_value 键不存在或转换失败时的默认值
+ * @return double 转换后的值
+ */
+CINI_EXPORT double cini_value_double_get(cini_t *self, const char *key, double default_value);
+
+/**
+ * @brief 将当前组中指定键设置为浮点数
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 修改值
+ */
+CINI_EXPORT void cini_value_double_set(cini_t *self, const char *key, double value);
+
+/**
+ * @brief 获取当前组中指定键的值并转换为布尔值 (true/false, yes/no, on/off, 1/0)
+ * @param self cini指针
+ * @param key 键名称
+ * @param default_value 键不存在或转换失败时的默认值
+ * @return bool 转换后的值
+ */
+CINI_EXPORT bool cini_value_bool_get(cini_t *self, const char *key, bool default_value);
+
+/**
+ * @brief 将当前组中指定键设置为布尔值
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 修改值
+ */
+CINI_EXPORT void cini_value_bool_set(cini_t *self, const char *key, bool value);
+
+/**
+ * @brief 获取当前组中指定键的值并转换为时长 (毫秒, 支持 ms/s/m/h/d 单位, 如 "1h30m")
+ * @param self cini指针
+ * @param key 键名称
+ * @param default_value 键不存在或转换失败时的默认值
+ * @return int64_t 转换后的值
+ */
+CINI_EXPORT int64_t cini_value_duration_get(cini_t *self, const char *key, int64_t default_value);
+
+/**
+ * @brief 将当前组中指定键设置为时长
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 修改值
+ */
+CINI_EXPORT void cini_value_duration_set(cini_t *self, const char *key, int64_t value);
+
+/**
+ * @brief 获取当前组中指定键的值并转换为大小 (字节, 支持 B/K/M/G/T 单位, 按 1024 进制)
+ * @param self cini指针
+ * @param key 键名称
+ * @param default_value 键不存在或转换失败时的默认值
+ * @return uint64_t 转换后的值
+ */
+CINI_EXPORT uint64_t cini_value_size_get(cini_t *self, const char *key, uint64_t default_value);
+
+/**
+ * @brief 将当前组中指定键设置为大小
+ * @param self cini指针
+ * @param key 键名称
+ * @param value 修改值
+ */
+CINI_EXPORT void cini_value_size_set(cini_t *self, const char *key, uint64_t value);
+
+/**
+ * @brief 开启事务
+ * 事务中的设置与移除只修改内存中的文档, 提交时一次性写入文件;
+ * 事务中的读取可以看到未提交的修改
+ * @param self cini指针
+ * @return bool 成功返回true，已在事务中或加载失败返回false
+ */
+CINI_EXPORT bool cini_txn_begin(cini_t *self);
+
+/**
+ * @brief 提交事务, 将所有修改一次写入文件
+ * 写入失败时事务保持开启, 可以重试提交或放弃
+ * @param self cini指针
+ * @return bool 成功返回true，未开启事务或写入失败返回false
+ */
+CINI_EXPORT bool cini_txn_commit(cini_t *self);
+
+/**
+ * @brief 放弃事务中的所有修改
+ * @param self cini指针
+ */
+CINI_EXPORT void cini_txn_abort(cini_t *self);
+
+/**
+ * @brief 创建空文档
+ * @return cini_doc_t* 成功返回文档, 失败返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_create(void);
+
+/**
+ * @brief 使用指定的内存分配器创建空文档
+ * @param allocator 内存分配器, 需在文档释放之前保持有效, 为 NULL 时使用 malloc
+ * @return cini_doc_t* 成功返回文档, 失败返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_create_alloc(const cini_allocator_t *allocator);
+
+/**
+ * @brief 加载配置文件
+ * 一次性读取并解析整个文件, 之后的查询与修改均在内存中进行
+ * @param path 配置文件路径
+ * @return cini_doc_t* 成功返回文档, 文件不存在或解析失败返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_load(const char *path);
+
+/**
+ * @brief 通过 I/O 后端加载配置文件
+ * 后端提供 view 时直接引用其内容, 不复制
+ * @param io I/O 后端, 为 NULL 时同 cini_doc_load
+ * @param path 配置文件路径 (原样传给后端)
+ * @return cini_doc_t* 成功返回文档, 读取或解析失败返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_load_io(const cini_io_t *io, const char *path);
+
+/**
+ * @brief 使用指定的内存分配器加载配置文件
+ * 文档的所有内存 (含无法映射或分配器 free 为 NULL 时读取的文件内容) 均从分配器分配,
+ * 配合静态竞技场可完全不调用 malloc
+ * @param allocator 内存分配器, 需在文档释放之前保持有效, 为 NULL 时使用 malloc
+ * @param io I/O 后端, 为 NULL 时直接访问文件
+ * @param path 配置文件路径
+ * @return cini_doc_t* 成功返回文档, 读取、解析失败或内存不足返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_load_alloc(const cini_allocator_t *allocator, const cini_io_t *io, const char *path);
+
+/**
+ * @brief 使用多个线程解析配置文件
+ * 在组标题行处将内容切分为分块, 各分块并行切分行并建立索引, 只有各分块不重复的名称与组按顺序合并,
+ * 结果与 cini_doc_load 相同; 文件较小时只使用部分线程或单线程.
+ * 线程取自进程内共享的线程池, 首次使用时创建并常驻, 之后的解析复用
+ * @param path 配置文件路径
+ * @param threads 线程数, 0 或 1 表示单线程
+ * @return cini_doc_t* 成功返回文档, 读取或解析失败返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_load_parallel(const char *path, unsigned threads);
+
+/**
+ * @brief 分层加载配置文件, 合并为一个文档
+ * 按顺序加载各层, 后面的层覆盖前面的层中同组同名的键. 文件中第一个组之前的 include=路径 指令
+ * 先于该文件本身作为更低的层加载, 相对路径相对于该文件所在目录; 路径为目录时按文件名顺序加载
+ * 其中的 *.ini 文件 (conf.d). 所有层在加载时合并到同一个索引中, 查找与普通文档相同;
+ * 保存时写入合并后的内容. 嵌套超过 16 层 (含循环包含) 或任一层读取失败时返回 NULL
+ * @param paths 各层的文件或目录路径, 从低到高
+ * @param count 路径数
+ * @return cini_doc_t* 成功返回文档, 否则返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_doc_load_layers(const char *const *paths, size_t count);
+
+/**
+ * @brief 获取键的值来自哪一层
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param layer 存储层序号 (见 cini_doc_layer_path)
+ * @return bool 键存在且值来自分层加载返回true, 否则返回false (在内存中修改过的值不属于任何层)
+ */
+CINI_EXPORT bool cini_doc_value_layer(cini_doc_t *doc, const char *group, const char *key, size_t *layer);
+
+/**
+ * @brief 获取分层加载的层数 (含 include 指令加载的层)
+ * @param doc 文档
+ * @return size_t 层数, 不是分层加载的文档返回 0
+ */
+CINI_EXPORT size_t cini_doc_layer_count(cini_doc_t *doc);
+
+/**
+ * @brief 获取层的文件路径
+ * @param doc 文档
+ * @param layer 层序号, 从低到高
+ * @return const char* 成功返回路径, 序号无效返回 NULL
+ */
+CINI_EXPORT const char *cini_doc_layer_path(cini_doc_t *doc, size_t layer);
+
+/**
+ * @brief 将文档使用的文件内容复制到文档自身的内存中
+ * 加载的文档通过内存映射直接引用文件内容, 文件被原地改写后映射内容随之改变;
+ * 需要长期持有文档时应先调用此函数
+ * @param doc 文档
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_detach(cini_doc_t *doc);
+
+/**
+ * @brief 冻结文档, 供多个线程同时读取
+ * 复制映射的文件内容并完成延迟的行号计算; 冻结后设置与移除均失败,
+ * 查找组、获取值、判断键与比较文档不再修改文档, 可被多个线程同时调用
+ * @param doc 文档
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_freeze(cini_doc_t *doc);
+
+/**
+ * @brief 释放文档
+ * @param doc 文档
+ */
+CINI_EXPORT void cini_doc_free(cini_doc_t *doc);
+
+/**
+ * @brief 保存文档
+ * 先写入临时文件 "<path>.tmp", 再替换目标文件
+ * @param doc 文档
+ * @param path 配置文件路径
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_save(cini_doc_t *doc, const char *path);
+
+/**
+ * @brief 通过 I/O 后端保存文档
+ * 写入后以 replace 整体替换原内容
+ * @param doc 文档
+ * @param io I/O 后端, 为 NULL 时同 cini_doc_save
+ * @param path 配置文件路径 (原样传给后端)
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_save_io(cini_doc_t *doc, const cini_io_t *io, const char *path);
+
+/**
+ * @brief 按指定方式保存文档
+ * CINI_SAVE_SPLICE 仅在文件自文档加载或上次保存后未被修改时生效 (仅支持 Linux 与 macOS):
+ * 长度不变的修改直接写在原位置, 文件变长时从第一处变化开始改写其后的内容;
+ * 文件会变短时整体重写 (截断文件会使映射该文件的其他文档访问时收到 SIGBUS),
+ * 进程内其他文档映射着该文件 (原地改写会改变它们的内容与已取得的值视图)、改写量不少于整体重写,
+ * 或无法原地改写时同样整体重写.
+ * 原地改写不是原子操作, 读取该文件的其他进程可能看到改写中的内容, 其他进程映射该文件时内容同样会被改变,
+ * 文件被其他进程共享读取时应整体重写
+ * @param doc 文档
+ * @param path 配置文件路径
+ * @param mode 保存方式 (enum cini_save_mode), 可组合 CINI_SAVE_SYNC
+ * @return bool 成功返回true，失败返回false (原地改写失败时文件可能只被部分改写)
+ */
+CINI_EXPORT bool cini_doc_save_mode(cini_doc_t *doc, const char *path, int mode);
+
+/**
+ * @brief 判断文件自文档加载或保存后是否被修改
+ * 比较文件的 inode、大小与修改时间; 文档在内存中被修改过时视为已变化;
+ * 比较内容哈希值要求文档已调用 cini_doc_detach, 否则状态变化即视为已变化
+ * @param doc 文档
+ * @param path 配置文件路径
+ * @param content 文件状态变化时是否继续比较内容哈希值
+ * @return bool 已变化或无法判断返回true，未变化返回false
+ */
+CINI_EXPORT bool cini_doc_changed(cini_doc_t *doc, const char *path, bool content);
+
+/**
+ * @brief 查找组
+ * start 与 end 都为 NULL 时只判断组是否存在, 不重新计算修改后的行号 (O(1))
+ * @param doc 文档
+ * @param group 组名称
+ * @param start 存储组起始行 (可为 NULL)
+ * @param end 存储组结束行 (可为 NULL)
+ * @return bool 存在返回true，不存在返回false
+ */
+CINI_EXPORT bool cini_doc_group_find(cini_doc_t *doc, const char *group, size_t *start, size_t *end);
+
+/**
+ * @brief 获取指定组中指定键的值
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param buffer 存储值的缓冲区
+ * @param max 缓冲区大小
+ * @return bool 键存在返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_value_get(cini_doc_t *doc, const char *group, const char *key, const char *default_value,
+                                    char *buffer, size_t max);
+
+/**
+ * @brief 获取指定组中指定键的值, 不复制
+ * 值指向文档内部存储, 不以'\0'结尾; 在文档释放或该键被修改、移除之前保持有效
+ * (快照文档在 cini_snap_leave 之前有效)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 存储值的起始位置, 键不存在时为 NULL
+ * @param size 存储值的长度
+ * @return bool 键存在返回true，否则返回false
+ */
+CINI_EXPORT bool cini_doc_value_view(cini_doc_t *doc, const char *group, const char *key, const char **value,
+                                     size_t *size);
+
+/**
+ * @brief 设置指定组中指定键的值 (组不存在时自动创建), 组内存在多个同名键时全部修改
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_value_set(cini_doc_t *doc, const char *group, const char *key, const char *value);
+
+/**
+ * @brief 获取指定组中指定键的值并转换为有符号整数
+ * 转换结果缓存在文档中, 再次以同一类型读取时不再解析
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_int_get(cini_doc_t *doc, const char *group, const char *key, int64_t default_value,
+                                  int64_t *value);
+
+/**
+ * @brief 获取指定组中指定键的值并转换为无符号整数
+ * 转换结果缓存在文档中, 再次以同一类型读取时不再解析
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_uint_get(cini_doc_t *doc, const char *group, const char *key, uint64_t default_value,
+                                   uint64_t *value);
+
+/**
+ * @brief 获取指定组中指定键的值并转换为浮点数
+ * 转换结果缓存在文档中, 再次以同一类型读取时不再解析
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_double_get(cini_doc_t *doc, const char *group, const char *key, double default_value,
+                                     double *value);
+
+/**
+ * @brief 获取指定组中指定键的值并转换为布尔值 (true/false, yes/no, on/off, 1/0)
+ * 转换结果缓存在文档中, 再次以同一类型读取时不再解析
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_bool_get(cini_doc_t *doc, const char *group, const char *key, bool default_value,
+                                   bool *value);
+
+/**
+ * @brief 获取指定组中指定键的值并转换为时长 (毫秒, 支持 ms/s/m/h/d 单位, 如 "1h30m")
+ * 转换结果缓存在文档中, 再次以同一类型读取时不再解析
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_duration_get(cini_doc_t *doc, const char *group, const char *key, int64_t default_value,
+                                       int64_t *value);
+
+/**
+ * @brief 获取指定组中指定键的值并转换为大小 (字节, 支持 B/K/M/G/T 单位, 按 1024 进制)
+ * 转换结果缓存在文档中, 再次以同一类型读取时不再解析
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_size_get(cini_doc_t *doc, const char *group, const char *key, uint64_t default_value,
+                                   uint64_t *value);
+
+/**
+ * @brief 将指定组中指定键设置为有符号整数 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_int_set(cini_doc_t *doc, const char *group, const char *key, int64_t value);
+
+/**
+ * @brief 将指定组中指定键设置为无符号整数 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_uint_set(cini_doc_t *doc, const char *group, const char *key, uint64_t value);
+
+/**
+ * @brief 将指定组中指定键设置为浮点数 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_double_set(cini_doc_t *doc, const char *group, const char *key, double value);
+
+/**
+ * @brief 将指定组中指定键设置为布尔值 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_bool_set(cini_doc_t *doc, const char *group, const char *key, bool value);
+
+/**
+ * @brief 将指定组中指定键设置为时长 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_duration_set(cini_doc_t *doc, const char *group, const char *key, int64_t value);
+
+/**
+ * @brief 将指定组中指定键设置为大小 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_doc_size_set(cini_doc_t *doc, const char *group, const char *key, uint64_t value);
+
+/**
+ * @brief 从指定组中移除指定键值对, 组内存在多个同名键时全部移除
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @return bool 移除成功返回true，键不存在返回false
+ */
+CINI_EXPORT bool cini_doc_value_remove(cini_doc_t *doc, const char *group, const char *key);
+
+/**
+ * @brief 判断指定组中指定键是否存在
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @return bool 存在返回true，不存在返回false
+ */
+CINI_EXPORT bool cini_doc_value_contains(cini_doc_t *doc, const char *group, const char *key);
+
+/**
+ * @brief 预处理键, 用于反复读取同一个键
+ * @param group 组名称
+ * @param key 键名称
+ * @return cini_key_t 预处理的键
+ */
+CINI_EXPORT cini_key_t cini_key_prepare(const char *group, const char *key);
+
+/**
+ * @brief 使用预处理的键获取值
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param buffer 存储值的缓冲区
+ * @param max 缓冲区大小
+ * @return bool 键存在返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_get(cini_doc_t *doc, cini_key_t *key, const char *default_value, char *buffer,
+                                  size_t max);
+
+/**
+ * @brief 使用预处理的键获取值, 不复制 (有效期同 cini_doc_value_view)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param value 存储值的起始位置, 键不存在时为 NULL
+ * @param size 存储值的长度
+ * @return bool 键存在返回true，否则返回false
+ */
+CINI_EXPORT bool cini_doc_key_view(cini_doc_t *doc, cini_key_t *key, const char **value, size_t *size);
+
+/**
+ * @brief 使用预处理的键判断键是否存在
+ * @param doc 文档
+ * @param key 预处理的键
+ * @return bool 存在返回true，否则返回false
+ */
+CINI_EXPORT bool cini_doc_key_contains(cini_doc_t *doc, cini_key_t *key);
+
+/**
+ * @brief 使用预处理的键获取有符号整数值 (格式同 cini_doc_int_get)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_int_get(cini_doc_t *doc, cini_key_t *key, int64_t default_value, int64_t *value);
+
+/**
+ * @brief 使用预处理的键获取无符号整数值 (格式同 cini_doc_uint_get)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_uint_get(cini_doc_t *doc, cini_key_t *key, uint64_t default_value, uint64_t *value);
+
+/**
+ * @brief 使用预处理的键获取浮点数值 (格式同 cini_doc_double_get)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_double_get(cini_doc_t *doc, cini_key_t *key, double default_value, double *value);
+
+/**
+ * @brief 使用预处理的键获取布尔值 (格式同 cini_doc_bool_get)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_bool_get(cini_doc_t *doc, cini_key_t *key, bool default_value, bool *value);
+
+/**
+ * @brief 使用预处理的键获取时长, 单位毫秒 (格式同 cini_doc_duration_get)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_duration_get(cini_doc_t *doc, cini_key_t *key, int64_t default_value, int64_t *value);
+
+/**
+ * @brief 使用预处理的键获取大小, 单位字节 (格式同 cini_doc_size_get)
+ * @param doc 文档
+ * @param key 预处理的键
+ * @param default_value 默认值
+ * @param value 存储转换后的值
+ * @return bool 键存在且转换成功返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_doc_key_size_get(cini_doc_t *doc, cini_key_t *key, uint64_t default_value, uint64_t *value);
+
+/**
+ * @brief 按文件顺序遍历文档中的组与生效的键值对
+ * 每个组先以组条目调用一次, 再依次调用组内的键值对; 同名组只遍历第一个, 被同名键遮蔽的行被跳过
+ * @param doc 文档
+ * @param func 回调函数
+ * @param arg 用户参数
+ */
+CINI_EXPORT void cini_doc_foreach(cini_doc_t *doc, cini_entry_func_t func, void *arg);
+
+/**
+ * @brief 比较两个文档, 对每个值不同、新增或移除的键调用回调
+ * 同名键以查询时生效的值为准, 不属于任何组的行被忽略
+ * @param old_doc 原文档
+ * @param new_doc 新文档
+ * @param func 回调函数
+ * @param arg 用户参数
+ */
+CINI_EXPORT void cini_doc_diff(cini_doc_t *old_doc, cini_doc_t *new_doc, cini_diff_func_t func, void *arg);
+
 #endif
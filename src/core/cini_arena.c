@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "cini_arena.h"
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+// 增长时分配的块 (块头之后为可分配的内存)
+struct cini_arena_block {
+    cini_arena_block_t *next;  // 下一个块
+};
+
+// 块头按分配对齐后的大小
+#define CINI_ARENA_HEADER                                                                                              \
+    ((sizeof(cini_arena_block_t) + CINI_ARENA_ALIGN - 1) & ~(size_t)(CINI_ARENA_ALIGN - 1))
+
+/**
+ * @brief 从竞技场分配内存 (分配器回调)
+ * @param arg 竞技场
+ * @param size 大小
+ * @return void* 成功返回内存, 空间不足且不能增长时返回 NULL
+ */
+static void *cini_arena_alloc(void *arg, size_t size);
+
+/**
+ * @brief 在当前块中分配
+ * @param arena 竞技场
+ * @param size 大小
+ * @return void* 成功返回内存, 当前块空间不足返回 NULL
+ */
+static inline void *cini_arena_bump(cini_arena_t *arena, size_t size);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+void cini_arena_init(cini_arena_t *arena, void *buffer, size_t size, size_t block_size)
+{
+    arena->allocator.alloc = cini_arena_alloc;
+    arena->allocator.free  = NULL;
+    arena->allocator.arg   = arena;
+    arena->buffer          = (unsigned char *)buffer;
+    arena->buffer_size     = buffer ? size : 0;
+    arena->block_size      = block_size;
+    arena->blocks          = NULL;
+    cini_arena_reset(arena);
+}
+
+void cini_arena_reset(cini_arena_t *arena)
+{
+    while (arena->blocks) {
+        cini_arena_block_t *next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    arena->base  = arena->buffer;
+    arena->size  = arena->buffer_size;
+    arena->used  = 0;
+    arena->total = 0;
+}
+
+size_t cini_arena_used(const cini_arena_t *arena)
+{
+    return arena->total;
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static void *cini_arena_alloc(void *arg, size_t size)
+{
+    cini_arena_t *arena = (cini_arena_t *)arg;
+    void         *ptr   = cini_arena_bump(arena, size);
+    if (ptr || arena->block_size == 0) {
+        return ptr;
+    }
+
+    // 当前块用尽, 分配新块 (大于块大小的请求独占一块)
+    const size_t        capacity = size > arena->block_size ? size : arena->block_size;
+    cini_arena_block_t *block    = (cini_arena_block_t *)malloc(CINI_ARENA_HEADER + capacity);
+    if (!block) {
+        return NULL;
+    }
+    block->next   = arena->blocks;
+    arena->blocks = block;
+    arena->base   = (unsigned char *)block + CINI_ARENA_HEADER;
+    arena->size   = capacity;
+    arena->used   = 0;
+    return cini_arena_bump(arena, size);
+}
+
+static inline void *cini_arena_bump(cini_arena_t *arena, size_t size)
+{
+    if (!arena->base) {
+        return NULL;
+    }
+    const uintptr_t address = (uintptr_t)(arena->base + arena->used);
+    const size_t    padding = (size_t)((CINI_ARENA_ALIGN - address % CINI_ARENA_ALIGN) % CINI_ARENA_ALIGN);
+    if (padding > arena->size - arena->used || size > arena->size - arena->used - padding) {
+        return NULL;
+    }
+    void *ptr = arena->base + arena->used + padding;
+    arena->used += padding + size;
+    arena->total += padding + size;
+    return ptr;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_ARENA_H
+#define _CINI_ARENA_H
+
+#include "cini.h"
+
+#define CINI_ARENA_ALIGN 16  // 分配的内存按此对齐
+
+// 竞技场中增长时分配的块
+typedef struct cini_arena_block cini_arena_block_t;
+
+/**
+ * @brief 竞技场 (顺序分配, 整体回收)
+ * 从调用者提供的内存块顺序分配, 用尽时按 block_size 分配新块 (block_size 为 0 时不增长, 完全不调用 malloc);
+ * 单次分配不释放, 由 cini_arena_reset 一次回收全部内存. 不支持多个线程同时分配
+ */
+typedef struct cini_arena {
+    cini_allocator_t    allocator;    // 从竞技场分配的分配器, 传给 cini_doc_create_alloc 等接口
+    unsigned char      *buffer;       // 调用者提供的内存块
+    size_t              buffer_size;  // 调用者提供的内存块大小
+    unsigned char      *base;         // 当前块
+    size_t              size;         // 当前块大小
+    size_t              used;         // 当前块已使用的大小
+    size_t              block_size;   // 增长时新块的最小大小, 为 0 时不增长
+    size_t              total;        // 已分配的总大小 (含对齐)
+    cini_arena_block_t *blocks;       // 增长时分配的块
+} cini_arena_t;
+
+/**
+ * @brief 初始化竞技场
+ * @param arena 竞技场
+ * @param buffer 初始内存块, 可为 NULL
+ * @param size 初始内存块大小
+ * @param block_size 用尽时新块的最小大小, 为 0 时不增长 (静态模式)
+ */
+CINI_EXPORT void cini_arena_init(cini_arena_t *arena, void *buffer, size_t size, size_t block_size);
+
+/**
+ * @brief 回收竞技场的全部内存
+ * 释放增长时分配的块, 之后可继续分配; 从竞技场分配的文档全部失效, 无需 (也不能再) 调用 cini_doc_free
+ * (这些文档的文件内容读入竞技场而不映射, 不持有竞技场之外的资源)
+ * @param arena 竞技场
+ */
+CINI_EXPORT void cini_arena_reset(cini_arena_t *arena);
+
+/**
+ * @brief 获取已分配的总大小 (含对齐)
+ * @param arena 竞技场
+ * @return size_t 已分配的大小
+ */
+CINI_EXPORT size_t cini_arena_used(const cini_arena_t *arena);
+
+#endif
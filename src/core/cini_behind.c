@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "cini_behind.h"
+#include "cini_stats.h"
+
+#if defined(__C_PLATFORM_LINUX) || defined(__C_PLATFORM_MAC)
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#define CINI_USE_BEHIND
+#endif
+
+// 计算写入期限使用的时钟, 不受系统时间调整影响; macOS 的条件变量不支持指定时钟
+#ifdef __C_PLATFORM_LINUX
+#define CINI_BEHIND_CLOCK CLOCK_MONOTONIC
+#else
+#define CINI_BEHIND_CLOCK CLOCK_REALTIME
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#ifdef CINI_USE_BEHIND
+
+// 后台写入器
+struct cini_behind {
+    cini_doc_t      *doc;       // 内存中的最新状态
+    cini_doc_t      *pending;   // 待写入的键 (只用作集合), 为 NULL 时按修改次数计数
+    size_t           count;     // 待写入的不同键数
+    struct timespec  since;     // 最早一次未写入的修改的时间
+    const cini_io_t *io;        // I/O 后端, 为 NULL 时直接访问文件
+    const char      *path;      // 文件路径
+    cini_stats_t    *stats;     // 句柄计数
+    unsigned         interval;  // 修改后最长多久写入文件 (毫秒)
+    size_t           entries;   // 待写入的不同键数达到该值时立即写入
+    bool             running;   // 后台线程是否运行
+    bool             failed;    // 最近一次写入是否失败 (失败后按时间重试)
+    pthread_t        thread;    // 后台线程
+    pthread_mutex_t  mutex;     // 保护文档与待写入状态
+    pthread_mutex_t  flush;     // 串行化写入, 保证文件按修改顺序更新
+    pthread_cond_t   cond;      // 唤醒后台线程
+};
+
+/**
+ * @brief 将文档内容写入文件 (在锁外写入, 不阻塞对文档的访问)
+ * @param behind 写入器
+ * @return 写入成功 (或没有修改) 返回 true, 否则返回 false
+ */
+static inline bool cini_behind_write(cini_behind_t *behind);
+
+/**
+ * @brief 初始化使用 CINI_BEHIND_CLOCK 计时的条件变量
+ * @param cond 条件变量
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_behind_cond_init(pthread_cond_t *cond);
+
+/**
+ * @brief 后台线程入口
+ * @param arg 写入器
+ * @return NULL
+ */
+static void *cini_behind_main(void *arg);
+
+#endif
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+#ifdef CINI_USE_BEHIND
+
+cini_behind_t *cini_behind_create(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats,
+                                  unsigned interval, size_t entries)
+{
+    if (!doc || !path) {
+        return NULL;
+    }
+    cini_behind_t *behind = (cini_behind_t *)calloc(1, sizeof(cini_behind_t));
+    if (!behind) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&behind->mutex, NULL) != 0) {
+        free(behind);
+        return NULL;
+    }
+    if (pthread_mutex_init(&behind->flush, NULL) != 0) {
+        pthread_mutex_destroy(&behind->mutex);
+        free(behind);
+        return NULL;
+    }
+    if (!cini_behind_cond_init(&behind->cond)) {
+        pthread_mutex_destroy(&behind->flush);
+        pthread_mutex_destroy(&behind->mutex);
+        free(behind);
+        return NULL;
+    }
+    behind->pending  = cini_doc_create();
+    behind->io       = io;
+    behind->path     = path;
+    behind->stats    = stats;
+    behind->interval = interval;
+    behind->entries  = entries;
+    behind->running  = true;
+    if (pthread_create(&behind->thread, NULL, cini_behind_main, behind) != 0) {
+        cini_doc_free(behind->pending);
+        pthread_cond_destroy(&behind->cond);
+        pthread_mutex_destroy(&behind->flush);
+        pthread_mutex_destroy(&behind->mutex);
+        free(behind);
+        return NULL;
+    }
+    behind->doc = doc;
+    return behind;
+}
+
+bool cini_behind_free(cini_behind_t *behind)
+{
+    if (!behind) {
+        return true;
+    }
+    pthread_mutex_lock(&behind->mutex);
+    behind->running = false;
+    pthread_cond_signal(&behind->cond);
+    pthread_mutex_unlock(&behind->mutex);
+    pthread_join(behind->thread, NULL);
+
+    const bool isok = cini_behind_write(behind);
+    cini_doc_free(behind->doc);
+    cini_doc_free(behind->pending);
+    pthread_cond_destroy(&behind->cond);
+    pthread_mutex_destroy(&behind->flush);
+    pthread_mutex_destroy(&behind->mutex);
+    free(behind);
+    return isok;
+}
+
+cini_doc_t *cini_behind_enter(cini_behind_t *behind)
+{
+    pthread_mutex_lock(&behind->mutex);
+    return behind->doc;
+}
+
+void cini_behind_leave(cini_behind_t *behind, const char *group, const char *key)
+{
+    // 只有第一次修改同一个键时计数
+    if (key && (!behind->pending || !cini_doc_value_contains(behind->pending, group, key))) {
+        if (behind->pending) {
+            cini_doc_value_set(behind->pending, group, key, STR_NULL);
+        }
+        if (behind->count++ == 0 && !behind->failed) {
+            clock_gettime(CINI_BEHIND_CLOCK, &behind->since);
+            pthread_cond_signal(&behind->cond);
+        } else if (behind->count == behind->entries) {
+            pthread_cond_signal(&behind->cond);
+        }
+    }
+    pthread_mutex_unlock(&behind->mutex);
+}
+
+bool cini_behind_flush(cini_behind_t *behind)
+{
+    return cini_behind_write(behind);
+}
+
+#else
+
+cini_behind_t *cini_behind_create(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats,
+                                  unsigned interval, size_t entries)
+{
+    (void)doc;
+    (void)io;
+    (void)path;
+    (void)stats;
+    (void)interval;
+    (void)entries;
+    return NULL;
+}
+
+bool cini_behind_free(cini_behind_t *behind)
+{
+    (void)behind;
+    return true;
+}
+
+cini_doc_t *cini_behind_enter(cini_behind_t *behind)
+{
+    (void)behind;
+    return NULL;
+}
+
+void cini_behind_leave(cini_behind_t *behind, const char *group, const char *key)
+{
+    (void)behind;
+    (void)group;
+    (void)key;
+}
+
+bool cini_behind_flush(cini_behind_t *behind)
+{
+    (void)behind;
+    return true;
+}
+
+#endif
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+#ifdef CINI_USE_BEHIND
+
+static inline bool cini_behind_write(cini_behind_t *behind)
+{
+    pthread_mutex_lock(&behind->flush);
+    pthread_mutex_lock(&behind->mutex);
+    if (behind->count == 0 && !behind->failed) {
+        pthread_mutex_unlock(&behind->mutex);
+        pthread_mutex_unlock(&behind->flush);
+        return true;
+    }
+
+    // 在锁内序列化, 之后的修改计入下一次写入
+    size_t size = 0;
+    char  *data = cini_doc_dump(behind->doc, &size);
+    if (data) {
+        cini_doc_free(behind->pending);
+        behind->pending = cini_doc_create();
+        behind->count   = 0;
+    }
+    pthread_mutex_unlock(&behind->mutex);
+
+    const bool isok = data && cini_dump_save(behind->io, behind->path, data, size, behind->stats);
+    free(data);
+
+    pthread_mutex_lock(&behind->mutex);
+    behind->failed = !isok;
+    if (!isok) {
+        clock_gettime(CINI_BEHIND_CLOCK, &behind->since);
+    }
+    pthread_mutex_unlock(&behind->mutex);
+    pthread_mutex_unlock(&behind->flush);
+    return isok;
+}
+
+static inline bool cini_behind_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) {
+        return false;
+    }
+#ifdef __C_PLATFORM_LINUX
+    bool isok = pthread_condattr_setclock(&attr, CINI_BEHIND_CLOCK) == 0 && pthread_cond_init(cond, &attr) == 0;
+#else
+    bool isok = pthread_cond_init(cond, &attr) == 0;
+#endif
+    pthread_condattr_destroy(&attr);
+    return isok;
+}
+
+static void *cini_behind_main(void *arg)
+{
+    cini_behind_t *behind = (cini_behind_t *)arg;
+    pthread_mutex_lock(&behind->mutex);
+    while (behind->running) {
+        const bool dirty = behind->count > 0 || behind->failed;
+        bool       due   = behind->entries && behind->count >= behind->entries;
+        if (!dirty || (!due && !behind->interval)) {
+            pthread_cond_wait(&behind->cond, &behind->mutex);
+            continue;
+        }
+        if (!due) {
+            // 等到最早一次修改满 interval 毫秒, 期间被唤醒时重新判断
+            struct timespec deadline = behind->since;
+            deadline.tv_sec += (time_t)(behind->interval / 1000);
+            deadline.tv_nsec += (long)(behind->interval % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            due = pthread_cond_timedwait(&behind->cond, &behind->mutex, &deadline) == ETIMEDOUT;
+        }
+        if (due && behind->running) {
+            pthread_mutex_unlock(&behind->mutex);
+            cini_behind_write(behind);
+            pthread_mutex_lock(&behind->mutex);
+        }
+    }
+    pthread_mutex_unlock(&behind->mutex);
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_BEHIND_H
+#define _CINI_BEHIND_H
+
+#include "cini.h"
+
+// 库内部使用: cini_t 的后台写入 (见 cini_behind_set)
+
+/**
+ * @brief 创建后台写入器并启动后台线程 (仅支持 Linux 与 macOS)
+ * @param doc 内存中的文档 (已 detach), 成功后由写入器持有
+ * @param io I/O 后端, 为 NULL 时直接访问文件
+ * @param path 文件路径, 需在写入器使用期间保持有效
+ * @param stats 句柄计数, 可为 NULL
+ * @param interval 修改后最长多久写入文件 (毫秒), 0 表示不按时间写入
+ * @param entries 待写入的不同键数达到该值时立即写入, 0 表示不按键数写入
+ * @return 成功返回写入器, 不支持的平台或失败返回 NULL
+ */
+cini_behind_t *cini_behind_create(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats,
+                                  unsigned interval, size_t entries);
+
+/**
+ * @brief 停止后台线程, 写入剩余的修改后释放写入器与文档
+ * @param behind 写入器, 可为 NULL
+ * @return 剩余的修改写入成功 (或没有修改) 返回 true, 否则返回 false
+ */
+bool cini_behind_free(cini_behind_t *behind);
+
+/**
+ * @brief 开始访问文档, 在 cini_behind_leave 之前后台线程不会读取文档
+ * @param behind 写入器
+ * @return 文档
+ */
+cini_doc_t *cini_behind_enter(cini_behind_t *behind);
+
+/**
+ * @brief 结束访问文档, 记录被修改的键
+ * 同一个键在写入前被多次修改只计一次
+ * @param behind 写入器
+ * @param group 组名称
+ * @param key 被修改或移除的键, 未修改时为 NULL
+ */
+void cini_behind_leave(cini_behind_t *behind, const char *group, const char *key);
+
+/**
+ * @brief 在当前线程中立即写入所有修改
+ * @param behind 写入器
+ * @return 写入成功 (或没有修改) 返回 true, 否则返回 false
+ */
+bool cini_behind_flush(cini_behind_t *behind);
+
+#endif
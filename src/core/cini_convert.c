@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cini_convert.h"
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#define CINI_CONVERT_DOUBLE 64  // 浮点数文本的最大长度
+
+// 单位
+typedef struct cini_unit {
+    const char *name;   // 单位名称 (小写)
+    uint64_t    scale;  // 倍数
+} cini_unit_t;
+
+// 时长单位 (毫秒), 按倍数从大到小排列
+static const cini_unit_t cini_duration_units[] = {
+    {"d", 86400000}, {"h", 3600000}, {"m", 60000}, {"s", 1000}, {"ms", 1},
+};
+
+// 大小单位 (字节)
+static const cini_unit_t cini_size_units[] = {
+    {"", 1},
+    {"b", 1},
+    {"k", 1ULL << 10},
+    {"kb", 1ULL << 10},
+    {"kib", 1ULL << 10},
+    {"m", 1ULL << 20},
+    {"mb", 1ULL << 20},
+    {"mib", 1ULL << 20},
+    {"g", 1ULL << 30},
+    {"gb", 1ULL << 30},
+    {"gib", 1ULL << 30},
+    {"t", 1ULL << 40},
+    {"tb", 1ULL << 40},
+    {"tib", 1ULL << 40},
+};
+
+/**
+ * @brief 去除首尾空白
+ * @param text 存储去除后的起始位置
+ * @param end 存储去除后的结束位置
+ */
+static inline void cini_convert_trim(const char **text, const char **end);
+
+/**
+ * @brief 跳过空白
+ * @param text 当前位置
+ * @param end 结束位置
+ * @return 第一个非空白字符的位置
+ */
+static inline const char *cini_convert_space(const char *text, const char *end);
+
+/**
+ * @brief 解析无符号整数部分
+ * @param cursor 当前位置, 成功时移动到整数之后
+ * @param end 结束位置
+ * @param hex 是否接受 0x 开头的十六进制
+ * @param value 存储结果
+ * @return 成功返回 true, 没有数字或溢出返回 false
+ */
+static inline bool cini_convert_digits(const char **cursor, const char *end, bool hex, uint64_t *value);
+
+/**
+ * @brief 查找单位 (不区分大小写)
+ * @param units 单位表
+ * @param count 单位数
+ * @param name 单位名称
+ * @param length 单位名称长度
+ * @return 找到返回单位, 否则返回 NULL
+ */
+static inline const cini_unit_t *cini_convert_unit(const cini_unit_t *units, size_t count, const char *name,
+                                                   size_t length);
+
+/**
+ * @brief 不区分大小写比较
+ * @param text 文本
+ * @param length 文本长度
+ * @param lower 小写字符串
+ * @return 相同返回 true, 否则返回 false
+ */
+static inline bool cini_convert_equal(const char *text, size_t length, const char *lower);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+bool cini_convert_int(const char *text, size_t length, int64_t *value)
+{
+    const char *end = text + length;
+    cini_convert_trim(&text, &end);
+
+    const bool negative = text < end && *text == '-';
+    if (text < end && (*text == '-' || *text == '+')) {
+        ++text;
+    }
+    uint64_t magnitude = 0;
+    if (!cini_convert_digits(&text, end, true, &magnitude) || text != end) {
+        return false;
+    }
+    if (negative) {
+        if (magnitude > (uint64_t)INT64_MAX + 1) {
+            return false;
+        }
+        *value = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)magnitude;
+    } else {
+        if (magnitude > (uint64_t)INT64_MAX) {
+            return false;
+        }
+        *value = (int64_t)magnitude;
+    }
+    return true;
+}
+
+bool cini_convert_uint(const char *text, size_t length, uint64_t *value)
+{
+    const char *end = text + length;
+    cini_convert_trim(&text, &end);
+
+    if (text < end && *text == '+') {
+        ++text;
+    }
+    return cini_convert_digits(&text, end, true, value) && text == end;
+}
+
+bool cini_convert_double(const char *text, size_t length, double *value)
+{
+    const char *end = text + length;
+    cini_convert_trim(&text, &end);
+
+    // strtod 需要以'\0'结尾的字符串
+    char buffer[CINI_CONVERT_DOUBLE];
+    if (text == end || (size_t)(end - text) >= sizeof(buffer)) {
+        return false;
+    }
+    memcpy(buffer, text, (size_t)(end - text));
+    buffer[end - text] = '\0';
+
+    char *stop = NULL;
+    errno      = 0;
+    *value     = strtod(buffer, &stop);
+    return errno != ERANGE && stop == buffer + (end - text);
+}
+
+bool cini_convert_bool(const char *text, size_t length, bool *value)
+{
+    static const char *const truths[] = {"true", "yes", "on", "1"};
+    static const char *const falses[] = {"false", "no", "off", "0"};
+
+    const char *end = text + length;
+    cini_convert_trim(&text, &end);
+
+    for (size_t index = 0; index < sizeof(truths) / sizeof(truths[0]); ++index) {
+        if (cini_convert_equal(text, (size_t)(end - text), truths[index])) {
+            *value = true;
+            return true;
+        }
+        if (cini_convert_equal(text, (size_t)(end - text), falses[index])) {
+            *value = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cini_convert_duration(const char *text, size_t length, int64_t *value)
+{
+    const char *end = text + length;
+    cini_convert_trim(&text, &end);
+
+    const bool negative = text < end && *text == '-';
+    if (text < end && (*text == '-' || *text == '+')) {
+        ++text;
+    }
+
+    uint64_t total = 0;
+    size_t   parts = 0;
+    while (text < end) {
+        uint64_t number = 0;
+        if (!cini_convert_digits(&text, end, false, &number)) {
+            return false;
+        }
+        text             = cini_convert_space(text, end);
+        const char *unit = text;
+        while (text < end && ((*text >= 'a' && *text <= 'z') || (*text >= 'A' && *text <= 'Z'))) {
+            ++text;
+        }
+
+        // 没有单位的整数只能单独出现, 单位为毫秒
+        uint64_t scale = 1;
+        if (text != unit) {
+            const cini_unit_t *found = cini_convert_unit(
+                cini_duration_units, sizeof(cini_duration_units) / sizeof(cini_duration_units[0]), unit,
+                (size_t)(text - unit));
+            if (!found) {
+                return false;
+            }
+            scale = found->scale;
+        } else if (parts > 0 || text != end) {
+            return false;
+        }
+        if (number > (UINT64_MAX - total) / scale) {
+            return false;
+        }
+        total += number * scale;
+        ++parts;
+        text = cini_convert_space(text, end);
+    }
+    if (!parts || total > (uint64_t)INT64_MAX) {
+        return false;
+    }
+    *value = negative ? -(int64_t)total : (int64_t)total;
+    return true;
+}
+
+bool cini_convert_size(const char *text, size_t length, uint64_t *value)
+{
+    const char *end = text + length;
+    cini_convert_trim(&text, &end);
+
+    uint64_t number = 0;
+    if (!cini_convert_digits(&text, end, false, &number)) {
+        return false;
+    }
+    text                     = cini_convert_space(text, end);
+    const cini_unit_t *found = cini_convert_unit(cini_size_units, sizeof(cini_size_units) / sizeof(cini_size_units[0]),
+                                                 text, (size_t)(end - text));
+    if (!found || number > UINT64_MAX / found->scale) {
+        return false;
+    }
+    *value = number * found->scale;
+    return true;
+}
+
+size_t cini_format_int(char *buffer, int64_t value)
+{
+    if (value >= 0) {
+        return cini_format_uint(buffer, (uint64_t)value);
+    }
+    buffer[0] = '-';
+    return cini_format_uint(buffer + 1, (uint64_t)0 - (uint64_t)value) + 1;
+}
+
+size_t cini_format_uint(char *buffer, uint64_t value)
+{
+    // 从低位向高位写入, 再翻转
+    size_t length = 0;
+    do {
+        buffer[length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (size_t index = 0; index < length / 2; ++index) {
+        const char digit           = buffer[index];
+        buffer[index]              = buffer[length - 1 - index];
+        buffer[length - 1 - index] = digit;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+size_t cini_format_double(char *buffer, double value)
+{
+    // 依次尝试 15~17 位有效数字, 取第一个能解析回原值的结果
+    int length = 0;
+    for (int precision = 15; precision <= 17; ++precision) {
+        length = snprintf(buffer, CINI_FORMAT_MAX, "%.*g", precision, value);
+        if (strtod(buffer, NULL) == value) {
+            break;
+        }
+    }
+    return length > 0 ? (size_t)length : 0;
+}
+
+size_t cini_format_bool(char *buffer, bool value)
+{
+    const char  *text   = value ? "true" : "false";
+    const size_t length = strlen(text);
+    memcpy(buffer, text, length + 1);
+    return length;
+}
+
+size_t cini_format_duration(char *buffer, int64_t value)
+{
+    const uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    size_t         length    = 0;
+    if (value < 0) {
+        buffer[length++] = '-';
+    }
+
+    const cini_unit_t *unit = &cini_duration_units[sizeof(cini_duration_units) / sizeof(cini_duration_units[0]) - 1];
+    for (size_t index = 0; magnitude && index < sizeof(cini_duration_units) / sizeof(cini_duration_units[0]); ++index) {
+        if (magnitude % cini_duration_units[index].scale == 0) {
+            unit = &cini_duration_units[index];
+            break;
+        }
+    }
+    length += cini_format_uint(buffer + length, magnitude / unit->scale);
+    memcpy(buffer + length, unit->name, strlen(unit->name) + 1);
+    return length + strlen(unit->name);
+}
+
+size_t cini_format_size(char *buffer, uint64_t value)
+{
+    static const char units[] = "TGMK";
+
+    for (size_t index = 0; value && index < 4; ++index) {
+        const uint64_t scale = 1ULL << (10 * (4 - index));
+        if (value % scale == 0) {
+            const size_t length = cini_format_uint(buffer, value / scale);
+            buffer[length]      = units[index];
+            buffer[length + 1]  = '\0';
+            return length + 1;
+        }
+    }
+    return cini_format_uint(buffer, value);
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline void cini_convert_trim(const char **text, const char **end)
+{
+    *text = cini_convert_space(*text, *end);
+    while (*end > *text && ((*end)[-1] == ' ' || (*end)[-1] == '\t' || (*end)[-1] == '\r')) {
+        --*end;
+    }
+}
+
+static inline const char *cini_convert_space(const char *text, const char *end)
+{
+    while (text < end && (*text == ' ' || *text == '\t')) {
+        ++text;
+    }
+    return text;
+}
+
+static inline bool cini_convert_digits(const char **cursor, const char *end, bool hex, uint64_t *value)
+{
+    const char *text = *cursor;
+    unsigned    base = 10;
+    if (hex && end - text > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+
+    const char *digits = text;
+    uint64_t    result = 0;
+    for (; text < end; ++text) {
+        unsigned digit = 0;
+        if (*text >= '0' && *text <= '9') {
+            digit = (unsigned)(*text - '0');
+        } else if (base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = (unsigned)(*text - 'a' + 10);
+        } else if (base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = (unsigned)(*text - 'A' + 10);
+        } else {
+            break;
+        }
+        if (result > (UINT64_MAX - digit) / base) {
+            return false;
+        }
+        result = result * base + digit;
+    }
+    if (text == digits) {
+        return false;
+    }
+    *cursor = text;
+    *value  = result;
+    return true;
+}
+
+static inline const cini_unit_t *cini_convert_unit(const cini_unit_t *units, size_t count, const char *name,
+                                                   size_t length)
+{
+    for (size_t index = 0; index < count; ++index) {
+        if (cini_convert_equal(name, length, units[index].name)) {
+            return &units[index];
+        }
+    }
+    return NULL;
+}
+
+static inline bool cini_convert_equal(const char *text, size_t length, const char *lower)
+{
+    for (size_t index = 0; index < length; ++index) {
+        const char letter = (char)(text[index] >= 'A' && text[index] <= 'Z' ? text[index] - 'A' + 'a' : text[index]);
+        if (!lower[index] || letter != lower[index]) {
+            return false;
+        }
+    }
+    return !lower[length];
+}
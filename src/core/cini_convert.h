@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_CONVERT_H
+#define _CINI_CONVERT_H
+
+#include <stdint.h>
+#include "cini.h"
+
+// 格式化数值所需的缓冲区大小
+#define CINI_FORMAT_MAX 32
+
+/*
+ * 文本与数值的相互转换 (库内部使用)
+ * 解析时忽略首尾空白, 文本不要求以'\0'结尾; 格式化结果以'\0'结尾, 返回值为长度
+ */
+
+/**
+ * @brief 解析有符号整数 (十进制或 0x 开头的十六进制)
+ * @param text 文本
+ * @param length 文本长度
+ * @param value 存储结果
+ * @return 成功返回 true, 格式错误或溢出返回 false
+ */
+bool cini_convert_int(const char *text, size_t length, int64_t *value);
+
+/**
+ * @brief 解析无符号整数 (十进制或 0x 开头的十六进制)
+ * @param text 文本
+ * @param length 文本长度
+ * @param value 存储结果
+ * @return 成功返回 true, 格式错误或溢出返回 false
+ */
+bool cini_convert_uint(const char *text, size_t length, uint64_t *value);
+
+/**
+ * @brief 解析浮点数
+ * @param text 文本
+ * @param length 文本长度
+ * @param value 存储结果
+ * @return 成功返回 true, 格式错误或溢出返回 false
+ */
+bool cini_convert_double(const char *text, size_t length, double *value);
+
+/**
+ * @brief 解析布尔值 (true/yes/on/1 与 false/no/off/0, 不区分大小写)
+ * @param text 文本
+ * @param length 文本长度
+ * @param value 存储结果
+ * @return 成功返回 true, 格式错误返回 false
+ */
+bool cini_convert_bool(const char *text, size_t length, bool *value);
+
+/**
+ * @brief 解析时长, 结果单位为毫秒
+ * 由若干 "整数+单位" 组成 (如 "1h30m", "500ms"), 单位为 ms/s/m/h/d; 只有一个整数时单位为毫秒
+ * @param text 文本
+ * @param length 文本长度
+ * @param value 存储结果
+ * @return 成功返回 true, 格式错误或溢出返回 false
+ */
+bool cini_convert_duration(const char *text, size_t length, int64_t *value);
+
+/**
+ * @brief 解析大小, 结果单位为字节
+ * 格式为 "整数+单位" (如 "64K", "10 MB"), 单位为 B/K/M/G/T (可加 B 或 iB 后缀, 不区分大小写, 均按 1024 进制)
+ * @param text 文本
+ * @param length 文本长度
+ * @param value 存储结果
+ * @return 成功返回 true, 格式错误或溢出返回 false
+ */
+bool cini_convert_size(const char *text, size_t length, uint64_t *value);
+
+/**
+ * @brief 格式化有符号整数
+ * @param buffer 缓冲区 (至少 CINI_FORMAT_MAX 字节)
+ * @param value 数值
+ * @return 文本长度
+ */
+size_t cini_format_int(char *buffer, int64_t value);
+
+/**
+ * @brief 格式化无符号整数
+ * @param buffer 缓冲区 (至少 CINI_FORMAT_MAX 字节)
+ * @param value 数值
+ * @return 文本长度
+ */
+size_t cini_format_uint(char *buffer, uint64_t value);
+
+/**
+ * @brief 格式化浮点数 (可无损解析回原值的最短形式)
+ * @param buffer 缓冲区 (至少 CINI_FORMAT_MAX 字节)
+ * @param value 数值
+ * @return 文本长度
+ */
+size_t cini_format_double(char *buffer, double value);
+
+/**
+ * @brief 格式化布尔值 ("true" 或 "false")
+ * @param buffer 缓冲区 (至少 CINI_FORMAT_MAX 字节)
+ * @param value 数值
+ * @return 文本长度
+ */
+size_t cini_format_bool(char *buffer, bool value);
+
+/**
+ * @brief 格式化时长, 使用能整除的最大单位 (如 5400000 格式化为 "90m")
+ * @param buffer 缓冲区 (至少 CINI_FORMAT_MAX 字节)
+ * @param value 时长 (毫秒)
+ * @return 文本长度
+ */
+size_t cini_format_duration(char *buffer, int64_t value);
+
+/**
+ * @brief 格式化大小, 使用能整除的最大单位 (如 1048576 格式化为 "1M")
+ * @param buffer 缓冲区 (至少 CINI_FORMAT_MAX 字节)
+ * @param value 大小 (字节)
+ * @return 文本长度
+ */
+size_t cini_format_size(char *buffer, uint64_t value);
+
+#endif
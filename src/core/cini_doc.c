@@ -0,0 +1,3369 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cini.h"
+#include "cini_convert.h"
+#include "cini_hash.h"
+#include "cini_io.h"
+#include "cini_scan.h"
+#include "cini_stats.h"
+#include "cini_task.h"
+
+#if defined(__C_PLATFORM_LINUX) || defined(__C_PLATFORM_MAC)
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CINI_USE_MMAP
+#define CINI_USE_THREADS
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#define CINI_DOC_SLAB    256    // 每个行内存块容纳的行数
+#define CINI_TABLE_MIN   16     // 哈希表最小容量
+#define CINI_READ_CHUNK  4096   // 无法映射时每次读取的字节数
+#define CINI_WRITE_CHUNK 8192   // 通过 I/O 后端写入时的缓冲区大小 (位于栈上)
+#define CINI_POOL_CHUNK  4096   // 符号池每个内存块的大小
+#define CINI_PARSE_CHUNK 262144 // 并行解析时每个分块的最小字节数
+#define CINI_PARSE_MAX   64     // 并行解析的最大分块数
+#define CINI_LAYER_DEPTH 16     // include 指令的最大嵌套层数
+#define CINI_LAYER_MAX   65535  // 分层加载的最大层数
+#define CINI_MAP_SLOTS   1024   // 进程内文件映射计数的槽位数
+
+#define CINI_INCLUDE_KEY "include"  // 包含指令的键名称 (位于第一个组之前)
+
+#define CINI_OFFSET_NONE SIZE_MAX  // 行不在文件中的位置 (新增或修改后)
+
+// 行类型
+enum cini_line_type {
+    CINI_LINE_OTHER = 0,  // 空行、注释等其他行
+    CINI_LINE_GROUP,      // 组标题行
+    CINI_LINE_PAIR,       // 键值对行
+};
+
+// 行结束符
+enum cini_line_eol {
+    CINI_EOL_NONE = 0,  // 无换行符 (文件最后一行)
+    CINI_EOL_LF,        // "\n"
+    CINI_EOL_CRLF,      // "\r\n"
+};
+
+// 行中缓存的值类型
+enum cini_value_type {
+    CINI_VALUE_NONE = 0,   // 未缓存
+    CINI_VALUE_BUSY,       // 正在写入缓存
+    CINI_VALUE_INT,        // 有符号整数
+    CINI_VALUE_UINT,       // 无符号整数
+    CINI_VALUE_DOUBLE,     // 浮点数
+    CINI_VALUE_BOOL,       // 布尔值
+    CINI_VALUE_DURATION,   // 时长 (毫秒)
+    CINI_VALUE_SIZE,       // 大小 (字节)
+};
+
+#ifdef __C_PLATFORM_WIN
+#define CINI_EOL_DEFAULT CINI_EOL_CRLF
+#else
+#define CINI_EOL_DEFAULT CINI_EOL_LF
+#endif
+
+typedef struct cini_line   cini_line_t;
+typedef struct cini_group  cini_group_t;
+typedef struct cini_symbol cini_symbol_t;
+typedef struct cini_pool   cini_pool_t;
+typedef struct cini_slab   cini_slab_t;
+typedef struct cini_slot   cini_slot_t;
+typedef struct cini_table  cini_table_t;
+typedef struct cini_stamp  cini_stamp_t;
+
+// 文档中的一行
+struct cini_line {
+    cini_line_t   *prev;          // 上一行
+    cini_line_t   *next;          // 下一行
+    cini_group_t  *group;         // 所属组, 不属于任何组时为 NULL
+    cini_symbol_t *key;           // 键名称符号 (仅组内的键值对行)
+    const char    *text;          // 行文本 (不含换行符, 不保证以'\0'结尾)
+    size_t         length;        // 行文本长度
+    size_t         offset;        // 行在文件中的字节偏移 (加载或保存时), 新增或修改后为 CINI_OFFSET_NONE
+    size_t         key_length;    // 键长度 (键位于行首)
+    const char    *value;         // 值起始位置
+    size_t         value_length;  // 值长度
+    uint64_t       hash;          // 组与键的组合哈希值 (仅键值对行)
+    uint64_t       cache;         // 缓存的值转换结果 (按位存储)
+    unsigned char  cache_type;    // 缓存结果的类型 (原子访问)
+    unsigned char  type;          // 行类型
+    unsigned char  eol;           // 行结束符
+    bool           owned;         // 行文本是否由文档分配
+    uint16_t       layer;         // 值来自的层 (序号 + 1), 0 表示不来自分层加载
+};
+
+// 文档中的一个组 (同名组仅记录第一个)
+struct cini_group {
+    cini_group_t  *next;    // 下一个组 (按文件顺序)
+    cini_line_t   *head;    // 组标题行
+    cini_line_t   *tail;    // 组内最后一个非空行
+    cini_symbol_t *symbol;  // 组名称符号
+    size_t         start;   // 组起始行号
+    size_t         end;     // 组结束行号
+};
+
+// 符号: 驻留的组或键名称, 文档内每个名称只保存一次并只计算一次哈希值, 之后按指针比较
+struct cini_symbol {
+    const char   *name;    // 名称 (位于符号池, 以'\0'结尾)
+    size_t        length;  // 名称长度
+    uint64_t      hash;    // 名称哈希值
+    uint64_t      id;      // 序号 (从 1 开始), 用于组合组与键的哈希值
+    cini_group_t *group;   // 以此为名称的组, 不存在时为 NULL
+};
+
+// 符号池内存块 (块头之后为符号与名称)
+struct cini_pool {
+    cini_pool_t *next;      // 下一个内存块
+    size_t       used;      // 已使用的大小
+    size_t       capacity;  // 可用大小
+};
+
+// 行内存块
+struct cini_slab {
+    cini_slab_t *next;                 // 下一个内存块
+    size_t       used;                 // 已使用的行数
+    cini_line_t  lines[CINI_DOC_SLAB];  // 行
+};
+
+// 哈希表槽位
+struct cini_slot {
+    uint64_t hash;  // 哈希值
+    void    *item;  // 组或行, 空槽位为 NULL
+};
+
+// 哈希表 (开放寻址, 线性探测)
+struct cini_table {
+    cini_slot_t *slots;     // 槽位数组
+    size_t       capacity;  // 容量 (2的幂)
+    size_t       count;     // 已使用的槽位数
+};
+
+// 文件状态戳, 用于判断文件自加载或保存后是否被修改
+struct cini_stamp {
+    bool     valid;       // 是否已记录 (仅普通文件)
+    bool     hashed;      // 内容哈希值是否已计算
+    uint64_t device;      // 设备号
+    uint64_t inode;       // inode 号
+    uint64_t size;        // 文件大小
+    int64_t  mtime;       // 修改时间 (秒)
+    int64_t  mtime_nsec;  // 修改时间 (纳秒部分)
+    uint64_t content;     // 内容哈希值
+    bool     versioned;   // 后端内容版本是否已记录 (仅通过 I/O 后端访问)
+    uint64_t version;     // 后端内容版本
+};
+
+// 文档
+struct cini_doc {
+    cini_line_t      *head;          // 第一行
+    cini_line_t      *tail;          // 最后一行
+    cini_group_t     *groups;        // 第一个组
+    cini_group_t     *groups_tail;   // 最后一个组
+    cini_slab_t      *slabs;         // 行内存块链表
+    cini_line_t      *spare;         // 已释放的行
+    size_t            line_count;    // 行数
+    cini_table_t      symbol_index;  // 符号索引: 名称 -> 符号
+    cini_table_t      pair_index;    // 键索引: (组符号, 键符号) -> 键值对行
+    cini_pool_t      *pool;          // 符号池
+    uint64_t          symbol_count;  // 符号数
+    uint64_t          generation;    // 文档代数: 增删键值对行时更新, 所有文档中唯一
+    bool              duplicates;    // 是否存在同组重复键
+    bool              renumber;      // 组行号是否需要重新计算
+    const char       *source;        // 文件内容
+    size_t            source_size;   // 文件内容长度
+    bool              mapped;        // 文件内容是否为内存映射
+    size_t            map_slot;      // 映射计数的槽位 (仅内存映射时有效)
+    bool              borrowed;      // 文件内容是否引用 I/O 后端的内容 (不释放)
+    bool              dirty;         // 加载或保存后是否被修改
+    bool              frozen;        // 是否已冻结 (只读)
+    cini_stamp_t      stamp;         // 加载或保存时的文件状态
+    cini_allocator_t  allocator;     // 内存分配器
+    const char      **layers;        // 分层加载时各层的文件路径 (位于符号池)
+    size_t            layer_count;   // 层数
+};
+
+/**
+ * @brief 默认分配器: 分配内存
+ * @param arg 分配器参数 (未使用)
+ * @param size 大小
+ * @return 成功返回内存, 否则返回 NULL
+ */
+static void *cini_malloc(void *arg, size_t size);
+
+/**
+ * @brief 默认分配器: 释放内存
+ * @param arg 分配器参数 (未使用)
+ * @param ptr 内存
+ */
+static void cini_free(void *arg, void *ptr);
+
+/**
+ * @brief 分配并清零内存
+ * @param allocator 内存分配器
+ * @param size 大小
+ * @return 成功返回内存, 否则返回 NULL
+ */
+static inline void *cini_mem_calloc(const cini_allocator_t *allocator, size_t size);
+
+/**
+ * @brief 释放内存, 分配器整体回收时不做任何事
+ * @param allocator 内存分配器
+ * @param ptr 内存, 可为 NULL
+ */
+static inline void cini_mem_free(const cini_allocator_t *allocator, void *ptr);
+
+/**
+ * @brief 扩大内存 (分配新内存并复制已使用的部分)
+ * @param allocator 内存分配器
+ * @param ptr 原内存, 可为 NULL
+ * @param used 已使用的大小
+ * @param size 新大小
+ * @return 成功返回新内存并释放原内存, 失败返回 NULL 并保留原内存
+ */
+static inline void *cini_mem_grow(const cini_allocator_t *allocator, void *ptr, size_t used, size_t size);
+
+// 默认分配器
+static const cini_allocator_t cini_allocator_malloc = {cini_malloc, cini_free, NULL};
+
+// 最近分配的文档代数
+static uint64_t cini_doc_generation_last = 0;
+
+/**
+ * @brief 更新文档代数, 使预处理的键缓存失效
+ * @param doc 文档
+ */
+static inline void cini_doc_generation_next(cini_doc_t *doc);
+
+/**
+ * @brief 使用预处理的键查找行, 文档代数未变化时直接返回缓存的行
+ * @param doc 文档
+ * @param key 预处理的键
+ * @return 找到返回行, 否则返回 NULL
+ */
+static inline const cini_line_t *cini_key_resolve(const cini_doc_t *doc, cini_key_t *key);
+
+/**
+ * @brief 读取整个文件
+ * @param doc 文档
+ * @param path 文件路径
+ * @param stats 句柄计数, 可为 NULL
+ * @return 读取成功返回 true, 否则返回 false
+ */
+static inline bool cini_doc_read(cini_doc_t *doc, const char *path, cini_stats_t *stats);
+
+/**
+ * @brief 通过 I/O 后端读取全部内容
+ * @param doc 文档
+ * @param io I/O 后端
+ * @param path 文件路径
+ * @param stats 句柄计数, 可为 NULL
+ * @return 读取成功返回 true, 否则返回 false
+ */
+static inline bool cini_doc_read_io(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats);
+
+/**
+ * @brief 通过 I/O 后端写入文档并替换原内容
+ * @param doc 文档
+ * @param io I/O 后端
+ * @param path 文件路径
+ * @param stats 句柄计数, 可为 NULL
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_doc_write_io(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats);
+
+/**
+ * @brief 保存后记录各行在文件中的位置
+ * @param doc 文档
+ */
+static inline void cini_doc_rebase(cini_doc_t *doc);
+
+#ifdef CINI_USE_MMAP
+/**
+ * @brief 从文件描述符循环读取全部内容 (用于管道等无法映射的文件, 以及分配器不释放内存时)
+ * @param doc 文档
+ * @param fd 文件描述符
+ * @param hint 预计的内容长度, 未知时为 0
+ * @return 读取成功返回 true, 否则返回 false
+ */
+static inline bool cini_doc_read_fd(cini_doc_t *doc, int fd, size_t hint);
+
+// 进程内映射各文件的文档数, 按设备号与 inode 散列到槽位; 槽位冲突只会使原地改写多退回整体重写
+static unsigned cini_map_counts[CINI_MAP_SLOTS];
+
+/**
+ * @brief 文件在映射计数中的槽位
+ * @param st 文件状态
+ * @return 槽位
+ */
+static inline size_t cini_map_slot(const struct stat *st);
+
+/**
+ * @brief 解除文档对文件内容的映射并减少映射计数
+ * @param doc 文档 (文件内容为内存映射)
+ */
+static inline void cini_doc_unmap(cini_doc_t *doc);
+
+// 原地改写的写入缓冲, 文件中连续的内容合并为一次写入
+typedef struct cini_splice {
+    int    fd;                        // 文件描述符
+    size_t offset;                    // 缓冲内容在文件中的位置
+    size_t used;                      // 缓冲内容长度
+    size_t written;                   // 已写入的字节数
+    char   buffer[CINI_WRITE_CHUNK];  // 缓冲区
+} cini_splice_t;
+
+/**
+ * @brief 原地改写文件中变化的部分
+ * 文件自加载或上次保存后未被修改时, 长度不变则只写入不在原位置的行, 变长则从第一处变化开始写入其后的全部内容;
+ * 文件会变短 (截断会使映射该文件的其他文档访问时收到 SIGBUS)、进程内其他文档映射着该文件,
+ * 或写入量不少于整体重写时不改写
+ * @param doc 文档
+ * @param path 文件路径
+ * @param sync 写入后是否同步到存储设备
+ * @param stats 句柄计数, 可为 NULL
+ * @param spliced 存储是否已原地改写, 为 false 时需整体重写
+ * @return 改写失败返回 false (文件可能只被部分改写), 否则返回 true
+ */
+static inline bool cini_doc_splice(cini_doc_t *doc, const char *path, bool sync, cini_stats_t *stats,
+                                   bool *spliced);
+
+/**
+ * @brief 将内容写入缓冲, 与缓冲内容不连续或缓冲区不足时先写出缓冲
+ * @param splice 写入缓冲
+ * @param offset 内容在文件中的位置
+ * @param data 内容
+ * @param size 内容长度
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_splice_write(cini_splice_t *splice, size_t offset, const char *data, size_t size);
+
+/**
+ * @brief 写出缓冲内容
+ * @param splice 写入缓冲
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_splice_flush(cini_splice_t *splice);
+
+/**
+ * @brief 在文件的指定位置写入全部内容
+ * @param fd 文件描述符
+ * @param offset 位置
+ * @param data 内容
+ * @param size 内容长度
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_file_pwrite(int fd, size_t offset, const char *data, size_t size);
+
+/**
+ * @brief 记录文件状态
+ * @param stamp 文件状态戳
+ * @param st 文件状态
+ */
+static inline void cini_stamp_set(cini_stamp_t *stamp, const struct stat *st);
+
+/**
+ * @brief 判断文件状态是否与记录一致
+ * @param stamp 文件状态戳
+ * @param st 文件状态
+ * @return 一致返回 true, 否则返回 false
+ */
+static inline bool cini_stamp_equal(const cini_stamp_t *stamp, const struct stat *st);
+
+/**
+ * @brief 计算文件内容哈希值
+ * @param path 文件路径
+ * @param st 存储读取时的文件状态
+ * @param hash 存储哈希值
+ * @param stats 句柄计数, 可为 NULL
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_file_digest(const char *path, struct stat *st, uint64_t *hash, cini_stats_t *stats);
+#endif
+
+/**
+ * @brief 计算文档序列化后的内容哈希值 (与保存后的文件内容一致)
+ * @param doc 文档
+ * @return 哈希值
+ */
+static inline uint64_t cini_doc_digest(const cini_doc_t *doc);
+
+/**
+ * @brief 解析文档内容
+ * 多线程时在组标题行 ("\n[") 处将内容切分为分块, 在线程池中分两轮并行处理: 先切分行、计算名称哈希值并在分块内驻留名称,
+ * 按顺序将各分块不重复的名称映射为符号并建立组后, 再设置各行的组与键并写入键索引; 结果与单线程解析相同
+ * @param doc 文档
+ * @param threads 线程数, 0 或 1 表示单线程
+ * @return 解析成功返回 true, 否则返回 false
+ */
+static inline bool cini_doc_parse(cini_doc_t *doc, unsigned threads);
+
+/**
+ * @brief 从内容中切分出一行并分类, 组标题行与键值对行的名称哈希值暂存于 line->hash
+ * @param line 行
+ * @param current 行起始位置
+ * @param end 内容结束位置
+ * @return 下一行的起始位置
+ */
+static inline const char *cini_line_scan(cini_line_t *line, const char *current, const char *end);
+
+/**
+ * @brief 为已加入文档末尾的行建立组与键索引
+ * @param doc 文档
+ * @param line 由 cini_line_scan 切分的行
+ * @param group 当前组, 遇到组标题行时更新
+ * @return 成功返回 true, 内存不足返回 false
+ */
+static inline bool cini_line_index(cini_doc_t *doc, cini_line_t *line, cini_group_t **group);
+
+/**
+ * @brief 加载一个文件或目录作为层, 先加载文件中 include 指令指向的层
+ * @param doc 合并的文档
+ * @param path 文件或目录路径
+ * @param depth 嵌套层数
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_layer_load(cini_doc_t *doc, const char *path, unsigned depth);
+
+/**
+ * @brief 加载 include 指令指向的层
+ * @param doc 合并的文档
+ * @param base 指令所在文件的路径
+ * @param value 指令的值 (相对路径相对于所在文件的目录)
+ * @param length 指令的值长度
+ * @param depth 指令所在文件的嵌套层数
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_layer_include(cini_doc_t *doc, const char *base, const char *value, size_t length,
+                                      unsigned depth);
+
+/**
+ * @brief 将一层的生效键值对合并到文档中, 覆盖已有的值并记录来源
+ * @param doc 合并的文档
+ * @param layer 层文档
+ * @param path 层文件路径
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_layer_merge(cini_doc_t *doc, cini_doc_t *layer, const char *path);
+
+#ifdef CINI_USE_MMAP
+/**
+ * @brief 按文件名顺序加载目录中的 *.ini 文件 (conf.d)
+ * @param doc 合并的文档
+ * @param path 目录路径
+ * @param depth 嵌套层数
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_layer_directory(cini_doc_t *doc, const char *path, unsigned depth);
+
+/**
+ * @brief 比较文件名 (qsort 回调)
+ * @param a 文件名
+ * @param b 文件名
+ * @return 比较结果
+ */
+static int cini_layer_compare(const void *a, const void *b);
+#endif
+
+#ifdef CINI_USE_THREADS
+// 分块内的名称, 合并时映射为文档的符号
+typedef struct cini_name {
+    const char    *text;    // 名称 (位于文件内容)
+    size_t         length;  // 名称长度
+    uint64_t       hash;    // 名称哈希值
+    cini_symbol_t *symbol;  // 文档中的符号, 合并后设置
+    cini_group_t  *group;   // 最近一个含有以此为键名称的键值对行的组, 用于识别组内重复键
+} cini_name_t;
+
+// 分块内名称的内存块
+typedef struct cini_names {
+    struct cini_names *next;                  // 下一个内存块
+    size_t             used;                  // 已使用的名称数
+    cini_name_t        names[CINI_DOC_SLAB];  // 名称
+} cini_names_t;
+
+// 分块内的组标题行
+typedef struct cini_header {
+    cini_line_t *line;  // 组标题行
+    cini_name_t *name;  // 组名称, 格式错误的组标题为 NULL
+} cini_header_t;
+
+// 并行解析的分块
+typedef struct cini_chunk {
+    cini_doc_t       *doc;         // 文档
+    pthread_mutex_t  *mutex;       // 保护文档的内存分配器
+    cini_allocator_t  allocator;   // 加锁后使用文档的内存分配器
+    const char       *begin;       // 分块起始位置 (位于行首)
+    const char       *end;         // 分块结束位置
+    cini_line_t      *head;        // 第一行 (通过 next 链接)
+    cini_line_t      *tail;        // 最后一行
+    cini_slab_t      *slabs;       // 行内存块链表
+    size_t            lines;       // 行数
+    size_t            number;      // 之前各分块的行数之和
+    size_t            pairs;       // 组内的键值对行数 (键索引项数的上限)
+    size_t            indexed;     // 加入键索引的行数
+    cini_table_t      names;       // 名称索引: 名称 -> cini_name_t
+    cini_names_t     *blocks;      // 名称内存块链表
+    cini_header_t    *headers;     // 组标题行 (按文件顺序)
+    size_t            count;       // 组标题行数
+    size_t            capacity;    // 组标题行数组容量
+    bool              duplicates;  // 是否存在同组重复键
+    bool              failed;      // 是否内存不足
+} cini_chunk_t;
+
+/**
+ * @brief 分块的内存分配器: 加锁后从文档的内存分配器分配
+ * @param arg 分块
+ * @param size 大小
+ * @return 成功返回内存, 否则返回 NULL
+ */
+static void *cini_chunk_alloc(void *arg, size_t size);
+
+/**
+ * @brief 分块的内存分配器: 加锁后释放到文档的内存分配器
+ * @param arg 分块
+ * @param ptr 内存
+ */
+static void cini_chunk_free(void *arg, void *ptr);
+
+/**
+ * @brief 查找分块内的名称
+ * @param chunk 分块
+ * @param text 名称
+ * @param length 名称长度
+ * @param hash 名称哈希值
+ * @param create 不存在时是否创建
+ * @return 名称, 不存在且未创建或内存不足时返回 NULL
+ */
+static inline cini_name_t *cini_chunk_name(cini_chunk_t *chunk, const char *text, size_t length, uint64_t hash,
+                                           bool create);
+
+/**
+ * @brief 切分分块中的所有行, 记录组标题行并驻留组内的名称 (线程池任务)
+ * @param arg 分块
+ */
+static void cini_chunk_scan(void *arg);
+
+/**
+ * @brief 按文件顺序将各分块的名称映射为文档的符号, 建立组并连接各分块的行
+ * 只遍历分块内不重复的名称与组标题行, 不遍历其他行
+ * @param doc 文档
+ * @param chunks 分块
+ * @param count 分块数
+ * @return 成功返回 true, 内存不足返回 false
+ */
+static inline bool cini_chunk_merge(cini_doc_t *doc, cini_chunk_t *chunks, size_t count);
+
+/**
+ * @brief 为分块中的行设置上一行、偏移量、所属组与键, 计算组行号并加入键索引 (线程池任务)
+ * @param arg 分块
+ */
+static void cini_chunk_index(void *arg);
+
+/**
+ * @brief 将内容切分为分块, 在线程池中并行切分行并建立索引
+ * @param doc 文档
+ * @param chunks 分块
+ * @param count 分块数, 至少为 2
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_chunk_run(cini_doc_t *doc, cini_chunk_t *chunks, size_t count);
+
+/**
+ * @brief 释放分块内的名称与组标题行, 行内存块交给文档管理
+ * @param doc 文档
+ * @param chunks 分块
+ * @param count 分块数
+ */
+static inline void cini_chunk_release(cini_doc_t *doc, cini_chunk_t *chunks, size_t count);
+
+/**
+ * @brief 向容量足够的哈希表并发插入一项 (不检查重复, 不扩容)
+ * @param table 哈希表
+ * @param hash 哈希值
+ * @param item 组或行
+ */
+static inline void cini_table_claim(cini_table_t *table, const uint64_t hash, void *item);
+#endif
+
+/**
+ * @brief 分配一行
+ * @param doc 文档
+ * @return 成功返回新行, 否则返回 NULL
+ */
+static inline cini_line_t *cini_line_alloc(cini_doc_t *doc);
+
+/**
+ * @brief 释放一行
+ * @param doc 文档
+ * @param line 行
+ */
+static inline void cini_line_release(cini_doc_t *doc, cini_line_t *line);
+
+/**
+ * @brief 识别行类型, 并记录键、值的位置
+ * @param line 行
+ * @param equal 行内第一个 '=' 的位置, 没有时为 NULL
+ */
+static inline void cini_line_classify(cini_line_t *line, const char *equal);
+
+/**
+ * @brief 生成键值对行文本
+ * @param line 行
+ * @param key 键名称
+ * @param value 值
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_line_format(cini_doc_t *doc, cini_line_t *line, const char *key, const char *value);
+
+/**
+ * @brief 在指定行之后插入一行
+ * @param doc 文档
+ * @param prev 插入位置, 为 NULL 时插入到文档末尾
+ * @param line 新行
+ */
+static inline void cini_line_insert(cini_doc_t *doc, cini_line_t *prev, cini_line_t *line);
+
+/**
+ * @brief 从文档中摘除一行
+ * @param doc 文档
+ * @param line 行
+ */
+static inline void cini_line_unlink(cini_doc_t *doc, cini_line_t *line);
+
+/**
+ * @brief 获取键的值并按类型转换
+ * 第一次转换的结果缓存在行中, 之后以同一类型读取时直接返回缓存;
+ * 缓存只写入一次, 冻结的文档可被多个线程同时读取
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param type 值类型
+ * @param bits 存储转换结果 (按位存储)
+ * @return 键存在且转换成功返回 true, 否则返回 false
+ */
+static inline bool cini_typed_get(cini_doc_t *doc, const char *group, const char *key, unsigned char type,
+                                  uint64_t *bits);
+
+/**
+ * @brief 按类型转换行的值, 使用并写入行中的缓存 (见 cini_typed_get)
+ * @param line 键值对行
+ * @param type 值类型
+ * @param bits 存储转换结果 (按位存储)
+ * @return 转换成功返回 true, 否则返回 false
+ */
+static inline bool cini_typed_line(cini_line_t *line, unsigned char type, uint64_t *bits);
+
+/**
+ * @brief 设置键的值并缓存转换结果
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param type 值类型
+ * @param bits 转换结果 (按位存储)
+ * @param text 格式化后的值
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_typed_set(cini_doc_t *doc, const char *group, const char *key, unsigned char type,
+                                  uint64_t bits, const char *text);
+
+/**
+ * @brief 按类型转换行的值
+ * @param line 键值对行
+ * @param type 值类型
+ * @param bits 存储转换结果 (按位存储)
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_typed_convert(const cini_line_t *line, unsigned char type, uint64_t *bits);
+
+/**
+ * @brief 设置指定组中指定键的值 (组不存在时自动创建)
+ * @param doc 文档
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 修改值
+ * @return 成功返回键值对行, 否则返回 NULL
+ */
+static inline cini_line_t *cini_pair_set(cini_doc_t *doc, const char *group, const char *key, const char *value);
+
+/**
+ * @brief 从组中移除一个键值对行并释放, 被移除的是组内最后一个非空行时更新组的最后一个非空行
+ * @param doc 文档
+ * @param group 所属组
+ * @param line 键值对行
+ */
+static inline void cini_pair_unlink(cini_doc_t *doc, cini_group_t *group, cini_line_t *line);
+
+/**
+ * @brief 查找符号
+ * @param doc 文档
+ * @param name 名称
+ * @param length 名称长度
+ * @param hash 名称哈希值
+ * @return 找到返回符号, 名称未出现过返回 NULL
+ */
+static inline cini_symbol_t *cini_symbol_lookup(const cini_doc_t *doc, const char *name, const size_t length,
+                                                const uint64_t hash);
+
+/**
+ * @brief 驻留名称, 名称未出现过时创建符号
+ * @param doc 文档
+ * @param name 名称
+ * @param length 名称长度
+ * @param hash 名称哈希值
+ * @return 成功返回符号, 内存不足返回 NULL
+ */
+static inline cini_symbol_t *cini_symbol_intern(cini_doc_t *doc, const char *name, const size_t length,
+                                                const uint64_t hash);
+
+/**
+ * @brief 从符号池分配内存 (随文档一起释放)
+ * @param doc 文档
+ * @param size 大小
+ * @return 成功返回内存, 否则返回 NULL
+ */
+static inline void *cini_pool_alloc(cini_doc_t *doc, size_t size);
+
+/**
+ * @brief 组合组符号与键符号的哈希值
+ * @param group 组名称符号
+ * @param key 键名称符号
+ * @return 组合哈希值
+ */
+static inline uint64_t cini_pair_hash(const cini_symbol_t *group, const cini_symbol_t *key);
+
+/**
+ * @brief 查找组
+ * @param doc 文档
+ * @param name 组名称
+ * @param length 组名称长度
+ * @param hash 组名称哈希值
+ * @return 找到返回组, 否则返回 NULL
+ */
+static inline cini_group_t *cini_group_lookup(const cini_doc_t *doc, const char *name, const size_t length,
+                                              const uint64_t hash);
+
+/**
+ * @brief 在组中查找键值对行 (按符号指针比较)
+ * @param doc 文档
+ * @param group 组
+ * @param key 键名称符号
+ * @return 找到返回行, 否则返回 NULL
+ */
+static inline cini_line_t *cini_pair_lookup(const cini_doc_t *doc, const cini_group_t *group,
+                                            const cini_symbol_t *key);
+
+/**
+ * @brief 查找组 (按名称字符串)
+ * @param doc 文档
+ * @param group 组名称
+ * @return 找到返回组, 否则返回 NULL
+ */
+static inline cini_group_t *cini_group_find(cini_doc_t *doc, const char *group);
+
+/**
+ * @brief 在组中查找键值对行 (按名称字符串)
+ * @param doc 文档
+ * @param group 组
+ * @param key 键名称
+ * @return 找到返回行, 否则返回 NULL
+ */
+static inline cini_line_t *cini_pair_find(cini_doc_t *doc, cini_group_t *group, const char *key);
+
+/**
+ * @brief 比较组内生效的键值对与另一文档中的同名键
+ * @param doc 组所在的文档
+ * @param other 另一文档
+ * @param group 组
+ * @param removed 为 true 时只报告另一文档中不存在的键 (作为移除), 否则报告新增与修改
+ * @param func 回调函数
+ * @param arg 用户参数
+ */
+static inline void cini_group_diff(cini_doc_t *doc, cini_doc_t *other, cini_group_t *group, bool removed,
+                                   cini_diff_func_t func, void *arg);
+
+/**
+ * @brief 扩容哈希表, 使其插入 count 项后负载因子不超过 1/2
+ * @param allocator 内存分配器
+ * @param table 哈希表
+ * @param count 项数
+ * @return 成功返回 true, 内存不足返回 false
+ */
+static inline bool cini_table_reserve(const cini_allocator_t *allocator, cini_table_t *table, size_t count);
+
+/**
+ * @brief 向哈希表插入一项 (不检查重复)
+ * @param allocator 扩容时使用的内存分配器
+ * @param table 哈希表
+ * @param hash 哈希值
+ * @param item 组或行
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_table_insert(const cini_allocator_t *allocator, cini_table_t *table, const uint64_t hash,
+                                     void *item);
+
+/**
+ * @brief 从哈希表移除一项
+ * @param table 哈希表
+ * @param hash 哈希值
+ * @param item 组或行
+ */
+static inline void cini_table_erase(cini_table_t *table, const uint64_t hash, const void *item);
+
+/**
+ * @brief 将组加入组链表末尾并记录到组名称符号
+ * @param doc 文档
+ * @param group 组
+ */
+static inline void cini_group_append(cini_doc_t *doc, cini_group_t *group);
+
+/**
+ * @brief 重新计算所有组的行号
+ * @param doc 文档
+ */
+static inline void cini_group_renumber(cini_doc_t *doc);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+cini_doc_t *cini_doc_create(void)
+{
+    return cini_doc_create_alloc(NULL);
+}
+
+cini_doc_t *cini_doc_create_alloc(const cini_allocator_t *allocator)
+{
+    if (!allocator) {
+        allocator = &cini_allocator_malloc;
+    }
+    cini_doc_t *doc = (cini_doc_t *)cini_mem_calloc(allocator, sizeof(cini_doc_t));
+    if (doc) {
+        doc->allocator = *allocator;
+        cini_doc_generation_next(doc);
+    }
+    return doc;
+}
+
+cini_doc_t *cini_doc_load(const char *path)
+{
+    return cini_doc_load_stats(NULL, NULL, path, 0, NULL);
+}
+
+cini_doc_t *cini_doc_load_io(const cini_io_t *io, const char *path)
+{
+    return cini_doc_load_stats(NULL, io, path, 0, NULL);
+}
+
+cini_doc_t *cini_doc_load_alloc(const cini_allocator_t *allocator, const cini_io_t *io, const char *path)
+{
+    return cini_doc_load_stats(allocator, io, path, 0, NULL);
+}
+
+cini_doc_t *cini_doc_load_parallel(const char *path, unsigned threads)
+{
+    return cini_doc_load_stats(NULL, NULL, path, threads, NULL);
+}
+
+cini_doc_t *cini_doc_load_stats(const cini_allocator_t *allocator, const cini_io_t *io, const char *path,
+                                unsigned threads, cini_stats_t *stats)
+{
+    if (!path) {
+        return NULL;
+    }
+    cini_doc_t *doc = cini_doc_create_alloc(allocator);
+    if (!doc) {
+        return NULL;
+    }
+    if (!(io ? cini_doc_read_io(doc, io, path, stats) : cini_doc_read(doc, path, stats))) {
+        cini_doc_free(doc);
+        return NULL;
+    }
+    cini_stats_add(stats, bytes_read, doc->source_size);
+    if (!cini_doc_parse(doc, threads)) {
+        cini_doc_free(doc);
+        return NULL;
+    }
+    cini_stats_add(stats, lines_scanned, doc->line_count);
+    return doc;
+}
+
+bool cini_doc_detach(cini_doc_t *doc)
+{
+    if (!doc) {
+        return false;
+    }
+    if (!doc->mapped && !doc->borrowed) {
+        return true;
+    }
+    char *copy = (char *)doc->allocator.alloc(doc->allocator.arg, doc->source_size ? doc->source_size : 1);
+    if (!copy) {
+        return false;
+    }
+    if (doc->source_size > 0) {
+        memcpy(copy, doc->source, doc->source_size);
+    }
+
+    // 引用文件内容的指针按偏移量迁移到副本
+    const char *begin = doc->source;
+    const char *end   = doc->source + doc->source_size;
+    for (cini_line_t *line = doc->head; line; line = line->next) {
+        if (line->owned || line->text < begin || line->text > end) {
+            continue;
+        }
+        if (line->value) {
+            line->value = copy + (line->value - begin);
+        }
+        line->text = copy + (line->text - begin);
+    }
+
+#ifdef CINI_USE_MMAP
+    if (doc->mapped) {
+        cini_doc_unmap(doc);
+    }
+#endif
+    doc->source   = copy;
+    doc->mapped   = false;
+    doc->borrowed = false;
+    return true;
+}
+
+bool cini_doc_freeze(cini_doc_t *doc)
+{
+    if (!cini_doc_detach(doc)) {
+        return false;
+    }
+    if (doc->renumber) {
+        cini_group_renumber(doc);
+    }
+    doc->frozen = true;
+    return true;
+}
+
+void cini_doc_free(cini_doc_t *doc)
+{
+    if (!doc) {
+        return;
+    }
+#ifdef CINI_USE_MMAP
+    if (doc->mapped) {
+        cini_doc_unmap(doc);
+    }
+#endif
+    // 由分配器整体回收时无需遍历
+    const cini_allocator_t allocator = doc->allocator;
+    if (!allocator.free) {
+        return;
+    }
+    for (cini_line_t *line = doc->head; line; line = line->next) {
+        if (line->owned) {
+            cini_mem_free(&allocator, (void *)line->text);
+        }
+    }
+    while (doc->groups) {
+        cini_group_t *next = doc->groups->next;
+        cini_mem_free(&allocator, doc->groups);
+        doc->groups = next;
+    }
+    while (doc->slabs) {
+        cini_slab_t *next = doc->slabs->next;
+        cini_mem_free(&allocator, doc->slabs);
+        doc->slabs = next;
+    }
+    while (doc->pool) {
+        cini_pool_t *next = doc->pool->next;
+        cini_mem_free(&allocator, doc->pool);
+        doc->pool = next;
+    }
+    cini_mem_free(&allocator, doc->symbol_index.slots);
+    cini_mem_free(&allocator, doc->pair_index.slots);
+    cini_mem_free(&allocator, (void *)doc->layers);
+    if (!doc->mapped && !doc->borrowed) {
+        cini_mem_free(&allocator, (void *)doc->source);
+    }
+    cini_mem_free(&allocator, doc);
+}
+
+bool cini_doc_save(cini_doc_t *doc, const char *path)
+{
+    return cini_doc_save_stats(doc, NULL, path, CINI_SAVE_REWRITE, NULL);
+}
+
+bool cini_doc_save_io(cini_doc_t *doc, const cini_io_t *io, const char *path)
+{
+    return cini_doc_save_stats(doc, io, path, CINI_SAVE_REWRITE, NULL);
+}
+
+bool cini_doc_save_mode(cini_doc_t *doc, const char *path, int mode)
+{
+    return cini_doc_save_stats(doc, NULL, path, mode, NULL);
+}
+
+bool cini_doc_save_stats(cini_doc_t *doc, const cini_io_t *io, const char *path, int mode, cini_stats_t *stats)
+{
+    if (!doc || !path) {
+        return false;
+    }
+    if (io) {
+        return cini_doc_write_io(doc, io, path, stats);
+    }
+#ifdef CINI_USE_MMAP
+    // 无法原地改写或改写量不少于整体重写时, 整体重写
+    bool spliced = false;
+    if ((mode & CINI_SAVE_SPLICE) && !cini_doc_splice(doc, path, (mode & CINI_SAVE_SYNC) != 0, stats, &spliced)) {
+        return false;
+    }
+    if (spliced) {
+        return true;
+    }
+#else
+    (void)mode;
+#endif
+
+    const size_t length = strlen(path) + sizeof(".tmp");
+    char        *wpath  = (char *)doc->allocator.alloc(doc->allocator.arg, length);
+    if (!wpath) {
+        return false;
+    }
+    snprintf(wpath, length, "%s.tmp", path);
+
+    // 打开文件
+    FILE *wfd = fopen(wpath, "wb");
+    if (!wfd) {
+        cini_mem_free(&doc->allocator, wpath);
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+    cini_stats_add(stats, rewrites, 1);
+
+    bool   isok    = true;
+    size_t written = 0;
+    for (const cini_line_t *line = doc->head; line && isok; line = line->next) {
+        if (line->length > 0 && fwrite(line->text, 1, line->length, wfd) != line->length) {
+            isok = false;
+        } else if (line->eol == CINI_EOL_LF) {
+            isok = fputs("\n", wfd) >= 0;
+        } else if (line->eol == CINI_EOL_CRLF) {
+            isok = fputs("\r\n", wfd) >= 0;
+        }
+        written += line->length + (line->eol == CINI_EOL_CRLF ? 2 : line->eol == CINI_EOL_LF ? 1 : 0);
+    }
+    cini_stats_add(stats, bytes_written, written);
+
+#ifdef CINI_USE_MMAP
+    // 记录写入完成后的文件状态, 重命名不改变 inode 与修改时间
+    struct stat st;
+    if (isok && (fflush(wfd) != 0 || ((mode & CINI_SAVE_SYNC) && fsync(fileno(wfd)) != 0) ||
+                 fstat(fileno(wfd), &st) != 0)) {
+        isok = false;
+    }
+#endif
+
+    // 关闭文件
+    if (fclose(wfd) != 0) {
+        isok = false;
+    }
+    if (isok) {
+#ifdef __C_PLATFORM_WIN
+        remove(path);
+#endif
+        isok = rename(wpath, path) == 0;
+    }
+    if (!isok) {
+        remove(wpath);
+    }
+    cini_mem_free(&doc->allocator, wpath);
+
+    if (isok) {
+        cini_stats_add(stats, renames, 1);
+        cini_doc_rebase(doc);
+        doc->dirty = false;
+#ifdef CINI_USE_MMAP
+        cini_stamp_set(&doc->stamp, &st);
+#endif
+    }
+    return isok;
+}
+
+char *cini_doc_dump(const cini_doc_t *doc, size_t *size)
+{
+    size_t total = 0;
+    for (const cini_line_t *line = doc->head; line; line = line->next) {
+        total += line->length + (line->eol == CINI_EOL_CRLF ? 2 : line->eol == CINI_EOL_LF ? 1 : 0);
+    }
+    // 多分配一个字节, 空文档也返回有效内存
+    char *data = (char *)malloc(total + 1);
+    if (!data) {
+        return NULL;
+    }
+    char *current = data;
+    for (const cini_line_t *line = doc->head; line; line = line->next) {
+        if (line->length > 0) {
+            memcpy(current, line->text, line->length);
+            current += line->length;
+        }
+        if (line->eol == CINI_EOL_CRLF) {
+            *current++ = '\r';
+        }
+        if (line->eol != CINI_EOL_NONE) {
+            *current++ = '\n';
+        }
+    }
+    *size = total;
+    return data;
+}
+
+bool cini_dump_save(const cini_io_t *io, const char *path, const char *data, size_t size, cini_stats_t *stats)
+{
+    if (!io) {
+        io = cini_io_file();
+    }
+    void *file = io->open(io->arg, path, true);
+    if (!file) {
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+    cini_stats_add(stats, rewrites, 1);
+    if (size > 0 && !io->write(file, data, size)) {
+        io->close(file);
+        return false;
+    }
+    cini_stats_add(stats, bytes_written, size);
+    if (!io->replace(file)) {
+        return false;
+    }
+    cini_stats_add(stats, renames, 1);
+    return true;
+}
+
+bool cini_doc_changed(cini_doc_t *doc, const char *path, bool content)
+{
+    return cini_doc_changed_stats(doc, NULL, path, content, NULL);
+}
+
+bool cini_doc_changed_stats(cini_doc_t *doc, const cini_io_t *io, const char *path, bool content,
+                            cini_stats_t *stats)
+{
+    if (!doc || !path) {
+        return true;
+    }
+    if (io) {
+        uint64_t version = 0;
+        return doc->dirty || !doc->stamp.versioned || !io->version || !io->version(io->arg, path, &version) ||
+               version != doc->stamp.version;
+    }
+#ifdef CINI_USE_MMAP
+    struct stat st;
+    if (doc->dirty || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return true;
+    }
+    if (doc->stamp.valid && cini_stamp_equal(&doc->stamp, &st)) {
+        return false;
+    }
+    // 映射的内容可能已随文件改变, 无法用于比较
+    if (!content || doc->mapped) {
+        return true;
+    }
+
+    // 文件状态变化但内容可能相同 (如重写了相同内容), 比较内容哈希值
+    uint64_t hash = 0;
+    if (!cini_file_digest(path, &st, &hash, stats)) {
+        return true;
+    }
+    if (!doc->stamp.hashed) {
+        doc->stamp.content = cini_doc_digest(doc);
+        doc->stamp.hashed  = true;
+    }
+    if (doc->stamp.content != hash) {
+        return true;
+    }
+    cini_stamp_set(&doc->stamp, &st);
+    doc->stamp.content = hash;
+    doc->stamp.hashed  = true;
+    return false;
+#else
+    (void)content;
+    (void)stats;
+    return true;
+#endif
+}
+
+bool cini_doc_group_find(cini_doc_t *doc, const char *group, size_t *start, size_t *end)
+{
+    if (!doc || !group) {
+        return false;
+    }
+    const cini_group_t *found = cini_group_find(doc, group);
+    if (!found || (!start && !end)) {
+        return found != NULL;
+    }
+    // 行号在修改后延迟到查询时重新计算, 避免每次修改都调整后续所有组
+    if (doc->renumber) {
+        cini_group_renumber(doc);
+    }
+    if (start) {
+        *start = found->start;
+    }
+    if (end) {
+        *end = found->end;
+    }
+    return true;
+}
+
+bool cini_doc_value_get(cini_doc_t *doc, const char *group, const char *key, const char *default_value, char *buffer,
+                        size_t max)
+{
+    if (!buffer || !max) {
+        return false;
+    }
+
+    cini_group_t      *found = (doc && group && key) ? cini_group_find(doc, group) : NULL;
+    const cini_line_t *line  = found ? cini_pair_find(doc, found, key) : NULL;
+    if (!line) {
+        snprintf(buffer, max, "%s", default_value ? default_value : STR_NULL);
+        return false;
+    }
+
+    const size_t length = line->value_length < max ? line->value_length : max - 1;
+    memcpy(buffer, line->value, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+bool cini_doc_value_view(cini_doc_t *doc, const char *group, const char *key, const char **value, size_t *size)
+{
+    if (!value || !size) {
+        return false;
+    }
+
+    cini_group_t      *found = (doc && group && key) ? cini_group_find(doc, group) : NULL;
+    const cini_line_t *line  = found ? cini_pair_find(doc, found, key) : NULL;
+    *value                   = line ? line->value : NULL;
+    *size                    = line ? line->value_length : 0;
+    return line != NULL;
+}
+
+bool cini_doc_value_set(cini_doc_t *doc, const char *group, const char *key, const char *value)
+{
+    return cini_pair_set(doc, group, key, value) != NULL;
+}
+
+bool cini_doc_int_get(cini_doc_t *doc, const char *group, const char *key, int64_t default_value, int64_t *value)
+{
+    uint64_t   bits = 0;
+    const bool isok = cini_typed_get(doc, group, key, CINI_VALUE_INT, &bits);
+    if (value) {
+        *value = isok ? (int64_t)bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_uint_get(cini_doc_t *doc, const char *group, const char *key, uint64_t default_value, uint64_t *value)
+{
+    uint64_t   bits = 0;
+    const bool isok = cini_typed_get(doc, group, key, CINI_VALUE_UINT, &bits);
+    if (value) {
+        *value = isok ? bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_double_get(cini_doc_t *doc, const char *group, const char *key, double default_value, double *value)
+{
+    uint64_t   bits = 0;
+    const bool isok = cini_typed_get(doc, group, key, CINI_VALUE_DOUBLE, &bits);
+    if (value) {
+        *value = default_value;
+        if (isok) {
+            memcpy(value, &bits, sizeof(*value));
+        }
+    }
+    return isok;
+}
+
+bool cini_doc_bool_get(cini_doc_t *doc, const char *group, const char *key, bool default_value, bool *value)
+{
+    uint64_t   bits = 0;
+    const bool isok = cini_typed_get(doc, group, key, CINI_VALUE_BOOL, &bits);
+    if (value) {
+        *value = isok ? bits != 0 : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_duration_get(cini_doc_t *doc, const char *group, const char *key, int64_t default_value,
+                           int64_t *value)
+{
+    uint64_t   bits = 0;
+    const bool isok = cini_typed_get(doc, group, key, CINI_VALUE_DURATION, &bits);
+    if (value) {
+        *value = isok ? (int64_t)bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_size_get(cini_doc_t *doc, const char *group, const char *key, uint64_t default_value, uint64_t *value)
+{
+    uint64_t   bits = 0;
+    const bool isok = cini_typed_get(doc, group, key, CINI_VALUE_SIZE, &bits);
+    if (value) {
+        *value = isok ? bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_int_set(cini_doc_t *doc, const char *group, const char *key, int64_t value)
+{
+    char text[CINI_FORMAT_MAX];
+    cini_format_int(text, value);
+    return cini_typed_set(doc, group, key, CINI_VALUE_INT, (uint64_t)value, text);
+}
+
+bool cini_doc_uint_set(cini_doc_t *doc, const char *group, const char *key, uint64_t value)
+{
+    char text[CINI_FORMAT_MAX];
+    cini_format_uint(text, value);
+    return cini_typed_set(doc, group, key, CINI_VALUE_UINT, value, text);
+}
+
+bool cini_doc_double_set(cini_doc_t *doc, const char *group, const char *key, double value)
+{
+    char     text[CINI_FORMAT_MAX];
+    uint64_t bits = 0;
+    cini_format_double(text, value);
+    memcpy(&bits, &value, sizeof(bits));
+    return cini_typed_set(doc, group, key, CINI_VALUE_DOUBLE, bits, text);
+}
+
+bool cini_doc_bool_set(cini_doc_t *doc, const char *group, const char *key, bool value)
+{
+    char text[CINI_FORMAT_MAX];
+    cini_format_bool(text, value);
+    return cini_typed_set(doc, group, key, CINI_VALUE_BOOL, value ? 1 : 0, text);
+}
+
+bool cini_doc_duration_set(cini_doc_t *doc, const char *group, const char *key, int64_t value)
+{
+    char text[CINI_FORMAT_MAX];
+    cini_format_duration(text, value);
+    return cini_typed_set(doc, group, key, CINI_VALUE_DURATION, (uint64_t)value, text);
+}
+
+bool cini_doc_size_set(cini_doc_t *doc, const char *group, const char *key, uint64_t value)
+{
+    char text[CINI_FORMAT_MAX];
+    cini_format_size(text, value);
+    return cini_typed_set(doc, group, key, CINI_VALUE_SIZE, value, text);
+}
+
+bool cini_doc_value_remove(cini_doc_t *doc, const char *group, const char *key)
+{
+    if (!doc || doc->frozen || !group || !key) {
+        return false;
+    }
+    cini_group_t *found = cini_group_find(doc, group);
+    cini_line_t  *line  = found ? cini_pair_find(doc, found, key) : NULL;
+    if (!line) {
+        return false;
+    }
+    doc->dirty = true;
+    cini_doc_generation_next(doc);
+    cini_table_erase(&doc->pair_index, line->hash, line);
+    doc->renumber = true;
+
+    // 存在同组重复键时一并移除组内其余同名键 (索引中的是组内首个同名键)
+    if (doc->duplicates) {
+        cini_line_t *next = line->next;
+        while (next && next->type != CINI_LINE_GROUP) {
+            cini_line_t *current = next;
+            next                 = next->next;
+            if (current->type == CINI_LINE_PAIR && current->key == line->key) {
+                cini_pair_unlink(doc, found, current);
+            }
+        }
+    }
+    cini_pair_unlink(doc, found, line);
+    return true;
+}
+
+bool cini_doc_value_contains(cini_doc_t *doc, const char *group, const char *key)
+{
+    if (!doc || !group || !key) {
+        return false;
+    }
+    cini_group_t *found = cini_group_find(doc, group);
+    return found && cini_pair_find(doc, found, key);
+}
+
+void cini_doc_foreach(cini_doc_t *doc, cini_entry_func_t func, void *arg)
+{
+    if (!doc || !func) {
+        return;
+    }
+    for (cini_group_t *group = doc->groups; group; group = group->next) {
+        cini_entry_t entry = {
+            .group      = group->symbol->name,
+            .group_size = group->symbol->length,
+        };
+        func(&entry, arg);
+
+        for (const cini_line_t *line = group->head->next; line && line->type != CINI_LINE_GROUP; line = line->next) {
+            if (line->type != CINI_LINE_PAIR || cini_pair_lookup(doc, group, line->key) != line) {
+                continue;
+            }
+            entry.key        = line->text;
+            entry.key_size   = line->key_length;
+            entry.value      = line->value;
+            entry.value_size = line->value_length;
+            func(&entry, arg);
+        }
+    }
+}
+
+void cini_doc_diff(cini_doc_t *old_doc, cini_doc_t *new_doc, cini_diff_func_t func, void *arg)
+{
+    if (!old_doc || !new_doc || !func) {
+        return;
+    }
+    for (cini_group_t *group = new_doc->groups; group; group = group->next) {
+        cini_group_diff(new_doc, old_doc, group, false, func, arg);
+    }
+    for (cini_group_t *group = old_doc->groups; group; group = group->next) {
+        cini_group_diff(old_doc, new_doc, group, true, func, arg);
+    }
+}
+
+cini_key_t cini_key_prepare(const char *group, const char *key)
+{
+    cini_key_t prepared = {0};
+    if (group && key) {
+        prepared.group        = group;
+        prepared.group_length = strlen(group);
+        prepared.group_hash   = cini_hash(group, prepared.group_length);
+        prepared.key          = key;
+        prepared.key_length   = strlen(key);
+        prepared.key_hash     = cini_hash(key, prepared.key_length);
+    }
+    return prepared;
+}
+
+bool cini_doc_key_get(cini_doc_t *doc, cini_key_t *key, const char *default_value, char *buffer, size_t max)
+{
+    if (!buffer || !max) {
+        return false;
+    }
+    const cini_line_t *line = (doc && key) ? cini_key_resolve(doc, key) : NULL;
+    if (!line) {
+        snprintf(buffer, max, "%s", default_value ? default_value : STR_NULL);
+        return false;
+    }
+
+    const size_t length = line->value_length < max ? line->value_length : max - 1;
+    memcpy(buffer, line->value, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+bool cini_doc_key_view(cini_doc_t *doc, cini_key_t *key, const char **value, size_t *size)
+{
+    if (!value || !size) {
+        return false;
+    }
+    const cini_line_t *line = (doc && key) ? cini_key_resolve(doc, key) : NULL;
+    *value                  = line ? line->value : NULL;
+    *size                   = line ? line->value_length : 0;
+    return line != NULL;
+}
+
+bool cini_doc_key_contains(cini_doc_t *doc, cini_key_t *key)
+{
+    return doc && key && cini_key_resolve(doc, key);
+}
+
+bool cini_doc_key_int_get(cini_doc_t *doc, cini_key_t *key, int64_t default_value, int64_t *value)
+{
+    cini_line_t *line = (doc && key) ? (cini_line_t *)cini_key_resolve(doc, key) : NULL;
+    uint64_t     bits = 0;
+    const bool   isok = line && cini_typed_line(line, CINI_VALUE_INT, &bits);
+    if (value) {
+        *value = isok ? (int64_t)bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_key_uint_get(cini_doc_t *doc, cini_key_t *key, uint64_t default_value, uint64_t *value)
+{
+    cini_line_t *line = (doc && key) ? (cini_line_t *)cini_key_resolve(doc, key) : NULL;
+    uint64_t     bits = 0;
+    const bool   isok = line && cini_typed_line(line, CINI_VALUE_UINT, &bits);
+    if (value) {
+        *value = isok ? bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_key_double_get(cini_doc_t *doc, cini_key_t *key, double default_value, double *value)
+{
+    cini_line_t *line = (doc && key) ? (cini_line_t *)cini_key_resolve(doc, key) : NULL;
+    uint64_t     bits = 0;
+    const bool   isok = line && cini_typed_line(line, CINI_VALUE_DOUBLE, &bits);
+    if (value) {
+        *value = default_value;
+        if (isok) {
+            memcpy(value, &bits, sizeof(*value));
+        }
+    }
+    return isok;
+}
+
+bool cini_doc_key_bool_get(cini_doc_t *doc, cini_key_t *key, bool default_value, bool *value)
+{
+    cini_line_t *line = (doc && key) ? (cini_line_t *)cini_key_resolve(doc, key) : NULL;
+    uint64_t     bits = 0;
+    const bool   isok = line && cini_typed_line(line, CINI_VALUE_BOOL, &bits);
+    if (value) {
+        *value = isok ? bits != 0 : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_key_duration_get(cini_doc_t *doc, cini_key_t *key, int64_t default_value, int64_t *value)
+{
+    cini_line_t *line = (doc && key) ? (cini_line_t *)cini_key_resolve(doc, key) : NULL;
+    uint64_t     bits = 0;
+    const bool   isok = line && cini_typed_line(line, CINI_VALUE_DURATION, &bits);
+    if (value) {
+        *value = isok ? (int64_t)bits : default_value;
+    }
+    return isok;
+}
+
+bool cini_doc_key_size_get(cini_doc_t *doc, cini_key_t *key, uint64_t default_value, uint64_t *value)
+{
+    cini_line_t *line = (doc && key) ? (cini_line_t *)cini_key_resolve(doc, key) : NULL;
+    uint64_t     bits = 0;
+    const bool   isok = line && cini_typed_line(line, CINI_VALUE_SIZE, &bits);
+    if (value) {
+        *value = isok ? bits : default_value;
+    }
+    return isok;
+}
+
+cini_doc_t *cini_doc_load_layers(const char *const *paths, size_t count)
+{
+    if (!paths) {
+        return NULL;
+    }
+    cini_doc_t *doc = cini_doc_create();
+    if (!doc) {
+        return NULL;
+    }
+    for (size_t index = 0; index < count; ++index) {
+        if (!paths[index] || !cini_layer_load(doc, paths[index], 0)) {
+            cini_doc_free(doc);
+            return NULL;
+        }
+    }
+    doc->dirty = false;
+    return doc;
+}
+
+bool cini_doc_value_layer(cini_doc_t *doc, const char *group, const char *key, size_t *layer)
+{
+    cini_group_t      *found = (doc && group && key) ? cini_group_find(doc, group) : NULL;
+    const cini_line_t *line  = found ? cini_pair_find(doc, found, key) : NULL;
+    if (!line || !line->layer) {
+        return false;
+    }
+    if (layer) {
+        *layer = (size_t)line->layer - 1;
+    }
+    return true;
+}
+
+size_t cini_doc_layer_count(cini_doc_t *doc)
+{
+    return doc ? doc->layer_count : 0;
+}
+
+const char *cini_doc_layer_path(cini_doc_t *doc, size_t layer)
+{
+    return (doc && layer < doc->layer_count) ? doc->layers[layer] : NULL;
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline void cini_doc_generation_next(cini_doc_t *doc)
+{
+    doc->generation = __atomic_add_fetch(&cini_doc_generation_last, 1, __ATOMIC_RELAXED);
+}
+
+static inline const cini_line_t *cini_key_resolve(const cini_doc_t *doc, cini_key_t *key)
+{
+    if (key->generation == doc->generation) {
+        return (const cini_line_t *)key->line;
+    }
+    if (!key->group) {
+        return NULL;
+    }
+    cini_group_t        *found  = cini_group_lookup(doc, key->group, key->group_length, key->group_hash);
+    const cini_symbol_t *symbol = found ? cini_symbol_lookup(doc, key->key, key->key_length, key->key_hash) : NULL;
+    key->line                   = symbol ? cini_pair_lookup(doc, found, symbol) : NULL;
+    key->generation             = doc->generation;
+    return (const cini_line_t *)key->line;
+}
+
+static void *cini_malloc(void *arg, size_t size)
+{
+    (void)arg;
+    return malloc(size);
+}
+
+static void cini_free(void *arg, void *ptr)
+{
+    (void)arg;
+    free(ptr);
+}
+
+static inline void *cini_mem_calloc(const cini_allocator_t *allocator, size_t size)
+{
+    void *ptr = allocator->alloc(allocator->arg, size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+static inline void cini_mem_free(const cini_allocator_t *allocator, void *ptr)
+{
+    if (ptr && allocator->free) {
+        allocator->free(allocator->arg, ptr);
+    }
+}
+
+static inline void *cini_mem_grow(const cini_allocator_t *allocator, void *ptr, size_t used, size_t size)
+{
+    void *grown = allocator->alloc(allocator->arg, size);
+    if (!grown) {
+        return NULL;
+    }
+    if (used > 0) {
+        memcpy(grown, ptr, used);
+    }
+    cini_mem_free(allocator, ptr);
+    return grown;
+}
+
+static inline bool cini_doc_read(cini_doc_t *doc, const char *path, cini_stats_t *stats)
+{
+#ifdef CINI_USE_MMAP
+    // 打开文件
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+
+    // 普通文件直接映射, 解析时原地扫描, 不经过 stdio 缓冲;
+    // 分配器不释放内存 (如竞技场) 时读入分配器的内存, 文档可随分配器整体回收而无需 cini_doc_free 解除映射
+    bool        isok = false;
+    size_t      hint = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        cini_stamp_set(&doc->stamp, &st);
+        hint = (size_t)st.st_size;
+        if (st.st_size == 0) {
+            isok = true;
+        } else if (doc->allocator.free) {
+            void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                doc->source      = (const char *)data;
+                doc->source_size = (size_t)st.st_size;
+                doc->mapped      = true;
+                doc->map_slot    = cini_map_slot(&st);
+                isok             = true;
+                __atomic_add_fetch(&cini_map_counts[doc->map_slot], 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    if (!isok) {
+        isok = cini_doc_read_fd(doc, fd, hint);
+    }
+
+    // 关闭文件
+    close(fd);
+    return isok;
+#else
+    // 打开文件
+    FILE *rfd = fopen(path, "rb");
+    if (!rfd) {
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+
+    bool  isok   = false;
+    char *source = NULL;
+    do {
+        if (fseek(rfd, 0, SEEK_END) != 0) {
+            break;
+        }
+        const long size = ftell(rfd);
+        if (size < 0 || fseek(rfd, 0, SEEK_SET) != 0) {
+            break;
+        }
+        source = (char *)doc->allocator.alloc(doc->allocator.arg, (size_t)size + 1);
+        if (!source) {
+            break;
+        }
+        if (fread(source, 1, (size_t)size, rfd) != (size_t)size) {
+            break;
+        }
+        doc->source      = source;
+        doc->source_size = (size_t)size;
+        source           = NULL;
+        isok             = true;
+    } while (0);
+
+    // 关闭文件
+    cini_mem_free(&doc->allocator, source);
+    fclose(rfd);
+    return isok;
+#endif
+}
+
+static inline bool cini_doc_read_io(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats)
+{
+    // 先记录版本, 读取期间内容被替换时下次判定为已变化
+    doc->stamp.versioned = io->version && io->version(io->arg, path, &doc->stamp.version);
+
+    // 内容在后端生命周期内不变时直接引用
+    if (io->view) {
+        size_t      size = 0;
+        const char *data = io->view(io->arg, path, &size);
+        if (data) {
+            doc->source      = data;
+            doc->source_size = size;
+            doc->borrowed    = true;
+            return true;
+        }
+    }
+
+    void *file = io->open(io->arg, path, false);
+    if (!file) {
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+
+    char  *source   = NULL;
+    size_t size     = 0;
+    size_t capacity = 0;
+    bool   isok     = true;
+    for (;;) {
+        if (capacity - size < CINI_READ_CHUNK) {
+            const size_t grown = capacity ? capacity * 2 : CINI_READ_CHUNK;
+            char        *grow  = (char *)cini_mem_grow(&doc->allocator, source, size, grown);
+            if (!grow) {
+                isok = false;
+                break;
+            }
+            source   = grow;
+            capacity = grown;
+        }
+        const long result = io->read(file, source + size, capacity - size);
+        if (result <= 0) {
+            isok = result == 0;
+            break;
+        }
+        size += (size_t)result;
+    }
+    io->close(file);
+
+    if (!isok) {
+        cini_mem_free(&doc->allocator, source);
+        return false;
+    }
+    doc->source      = source;
+    doc->source_size = size;
+    return true;
+}
+
+static inline bool cini_doc_write_io(cini_doc_t *doc, const cini_io_t *io, const char *path, cini_stats_t *stats)
+{
+    void *file = io->open(io->arg, path, true);
+    if (!file) {
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+    cini_stats_add(stats, rewrites, 1);
+
+    // 合并为大块写入, 减少后端调用次数
+    char   buffer[CINI_WRITE_CHUNK];
+    size_t used    = 0;
+    size_t written = 0;
+    bool   isok    = true;
+    for (const cini_line_t *line = doc->head; line && isok; line = line->next) {
+        const char  *eol    = line->eol == CINI_EOL_CRLF ? "\r\n" : "\n";
+        const size_t length = line->eol == CINI_EOL_CRLF ? 2 : line->eol == CINI_EOL_LF ? 1 : 0;
+        written += line->length + length;
+        if (used + line->length + length > CINI_WRITE_CHUNK) {
+            isok = used == 0 || io->write(file, buffer, used);
+            used = 0;
+            // 超过缓冲区的长行直接写入
+            if (isok && line->length + length > CINI_WRITE_CHUNK) {
+                isok = io->write(file, line->text, line->length) && (length == 0 || io->write(file, eol, length));
+                continue;
+            }
+        }
+        if (line->length > 0) {
+            memcpy(buffer + used, line->text, line->length);
+        }
+        memcpy(buffer + used + line->length, eol, length);
+        used += line->length + length;
+    }
+    if (isok && used > 0) {
+        isok = io->write(file, buffer, used);
+    }
+    if (!isok) {
+        io->close(file);
+        return false;
+    }
+    cini_stats_add(stats, bytes_written, written);
+
+    if (!io->replace(file)) {
+        return false;
+    }
+    cini_stats_add(stats, renames, 1);
+    doc->dirty           = false;
+    doc->stamp.valid     = false;
+    doc->stamp.versioned = io->version && io->version(io->arg, path, &doc->stamp.version);
+    return true;
+}
+
+static inline void cini_doc_rebase(cini_doc_t *doc)
+{
+    size_t offset = 0;
+    for (cini_line_t *line = doc->head; line; line = line->next) {
+        line->offset = offset;
+        offset += line->length + (line->eol == CINI_EOL_CRLF ? 2 : line->eol == CINI_EOL_LF ? 1 : 0);
+    }
+}
+
+#ifdef CINI_USE_MMAP
+static inline bool cini_doc_splice(cini_doc_t *doc, const char *path, bool sync, cini_stats_t *stats,
+                                   bool *spliced)
+{
+    *spliced = false;
+    if (!doc->stamp.valid) {
+        return true;
+    }
+    const int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return true;
+    }
+    cini_stats_add(stats, files_opened, 1);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || !cini_stamp_equal(&doc->stamp, &st)) {
+        close(fd);
+        return true;
+    }
+
+    // 进程内其他文档映射着该文件时, 原地改写会改变它们的内容 (包括已取得的值视图), 整体重写
+    const size_t   slot   = cini_map_slot(&st);
+    const unsigned mapped = __atomic_load_n(&cini_map_counts[slot], __ATOMIC_RELAXED);
+    if (mapped > (doc->mapped && doc->map_slot == slot ? 1u : 0u)) {
+        close(fd);
+        return true;
+    }
+
+    // 找出不在原位置的行: 长度不变时只需写入这些行, 否则需写入第一处变化之后的全部内容
+    const size_t size    = (size_t)st.st_size;
+    size_t       total   = 0;
+    size_t       first   = CINI_OFFSET_NONE;
+    size_t       changed = 0;
+    bool         moved   = false;
+    for (const cini_line_t *line = doc->head; line; line = line->next) {
+        const size_t length = line->length + (line->eol == CINI_EOL_CRLF ? 2 : line->eol == CINI_EOL_LF ? 1 : 0);
+        if (line->offset != total) {
+            first    = first < total ? first : total;
+            changed += length;
+            moved    = moved || !line->owned;
+        }
+        total += length;
+    }
+    first             = first < total ? first : total;
+    const size_t cost = total == size ? changed : total - first;
+    if (total < size || (cost > 0 && cost >= total)) {
+        close(fd);
+        return true;
+    }
+
+    // 映射的内容会随改写变化, 移动的行引用映射时先复制到内存
+    if (doc->mapped && moved && !cini_doc_detach(doc)) {
+        close(fd);
+        return true;
+    }
+
+    cini_splice_t splice;
+    splice.fd      = fd;
+    splice.used    = 0;
+    splice.written = 0;
+
+    bool   isok   = true;
+    size_t offset = 0;
+    for (const cini_line_t *line = doc->head; line && isok; line = line->next) {
+        const char  *eol    = line->eol == CINI_EOL_CRLF ? "\r\n" : "\n";
+        const size_t length = line->eol == CINI_EOL_CRLF ? 2 : line->eol == CINI_EOL_LF ? 1 : 0;
+        if (offset >= first && (total != size || line->offset != offset)) {
+            isok = cini_splice_write(&splice, offset, line->text, line->length) &&
+                   cini_splice_write(&splice, offset + line->length, eol, length);
+        }
+        offset += line->length + length;
+    }
+    isok = isok && cini_splice_flush(&splice);
+    isok = isok && (!sync || fsync(fd) == 0);
+    isok = isok && fstat(fd, &st) == 0;
+    cini_stats_add(stats, bytes_written, splice.written);
+    if (close(fd) != 0) {
+        isok = false;
+    }
+    if (!isok) {
+        // 文件可能只被部分改写, 之后整体重写
+        doc->stamp.valid = false;
+        return false;
+    }
+
+    cini_stats_add(stats, splices, 1);
+    cini_doc_rebase(doc);
+    cini_stamp_set(&doc->stamp, &st);
+    doc->dirty = false;
+    *spliced   = true;
+    return true;
+}
+
+static inline bool cini_splice_write(cini_splice_t *splice, size_t offset, const char *data, size_t size)
+{
+    if (size == 0) {
+        return true;
+    }
+    if (splice->used > 0 && (splice->offset + splice->used != offset || splice->used + size > CINI_WRITE_CHUNK)) {
+        if (!cini_splice_flush(splice)) {
+            return false;
+        }
+    }
+    // 超过缓冲区的长行直接写入
+    if (size > CINI_WRITE_CHUNK) {
+        splice->written += size;
+        return cini_file_pwrite(splice->fd, offset, data, size);
+    }
+    if (splice->used == 0) {
+        splice->offset = offset;
+    }
+    memcpy(splice->buffer + splice->used, data, size);
+    splice->used += size;
+    return true;
+}
+
+static inline bool cini_splice_flush(cini_splice_t *splice)
+{
+    if (splice->used == 0) {
+        return true;
+    }
+    const bool isok = cini_file_pwrite(splice->fd, splice->offset, splice->buffer, splice->used);
+    splice->written += splice->used;
+    splice->used     = 0;
+    return isok;
+}
+
+static inline bool cini_file_pwrite(int fd, size_t offset, const char *data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t count = pwrite(fd, data, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data   += count;
+        offset += (size_t)count;
+        size   -= (size_t)count;
+    }
+    return true;
+}
+
+static inline bool cini_doc_read_fd(cini_doc_t *doc, int fd, size_t hint)
+{
+    char  *source   = NULL;
+    size_t size     = 0;
+    size_t capacity = 0;
+    for (;;) {
+        // 长度已知时多留一个字节读到文件结尾, 不再增长
+        if (size == capacity) {
+            const size_t grown = capacity ? capacity * 2 : hint ? hint + 1 : CINI_READ_CHUNK;
+            char        *grow  = (char *)cini_mem_grow(&doc->allocator, source, size, grown);
+            if (!grow) {
+                cini_mem_free(&doc->allocator, source);
+                return false;
+            }
+            source   = grow;
+            capacity = grown;
+        }
+        const ssize_t result = read(fd, source + size, capacity - size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cini_mem_free(&doc->allocator, source);
+            return false;
+        }
+        if (result == 0) {
+            break;
+        }
+        size += (size_t)result;
+    }
+    doc->source      = source;
+    doc->source_size = size;
+    return true;
+}
+
+static inline size_t cini_map_slot(const struct stat *st)
+{
+    return (size_t)(((uint64_t)st->st_dev * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)st->st_ino) & (CINI_MAP_SLOTS - 1);
+}
+
+static inline void cini_doc_unmap(cini_doc_t *doc)
+{
+    munmap((void *)doc->source, doc->source_size);
+    __atomic_sub_fetch(&cini_map_counts[doc->map_slot], 1, __ATOMIC_RELAXED);
+}
+
+static inline void cini_stamp_set(cini_stamp_t *stamp, const struct stat *st)
+{
+    stamp->valid  = true;
+    stamp->hashed = false;
+    stamp->device = (uint64_t)st->st_dev;
+    stamp->inode  = (uint64_t)st->st_ino;
+    stamp->size   = (uint64_t)st->st_size;
+    stamp->mtime  = (int64_t)st->st_mtime;
+#ifdef __C_PLATFORM_MAC
+    stamp->mtime_nsec = (int64_t)st->st_mtimespec.tv_nsec;
+#else
+    stamp->mtime_nsec = (int64_t)st->st_mtim.tv_nsec;
+#endif
+}
+
+static inline bool cini_stamp_equal(const cini_stamp_t *stamp, const struct stat *st)
+{
+    cini_stamp_t current;
+    cini_stamp_set(&current, st);
+    return stamp->device == current.device && stamp->inode == current.inode && stamp->size == current.size &&
+           stamp->mtime == current.mtime && stamp->mtime_nsec == current.mtime_nsec;
+}
+
+static inline bool cini_file_digest(const char *path, struct stat *st, uint64_t *hash, cini_stats_t *stats)
+{
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    cini_stats_add(stats, files_opened, 1);
+
+    bool isok = false;
+    if (fstat(fd, st) == 0 && S_ISREG(st->st_mode)) {
+        if (st->st_size == 0) {
+            *hash = CINI_HASH_OFFSET;
+            isok  = true;
+        } else {
+            void *data = mmap(NULL, (size_t)st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                *hash = cini_hash((const char *)data, (size_t)st->st_size);
+                cini_stats_add(stats, bytes_read, st->st_size);
+                munmap(data, (size_t)st->st_size);
+                isok = true;
+            }
+        }
+    }
+    close(fd);
+    return isok;
+}
+#endif
+
+static inline uint64_t cini_doc_digest(const cini_doc_t *doc)
+{
+    uint64_t hash = CINI_HASH_OFFSET;
+    for (const cini_line_t *line = doc->head; line; line = line->next) {
+        hash = cini_hash_update(hash, line->text, line->length);
+        if (line->eol == CINI_EOL_LF) {
+            hash = cini_hash_update(hash, "\n", 1);
+        } else if (line->eol == CINI_EOL_CRLF) {
+            hash = cini_hash_update(hash, "\r\n", 2);
+        }
+    }
+    return hash;
+}
+
+static inline bool cini_doc_parse(cini_doc_t *doc, unsigned threads)
+{
+    const char   *current = doc->source;
+    const char   *end     = doc->source + doc->source_size;
+    cini_group_t *group   = NULL;
+
+#ifdef CINI_USE_THREADS
+    size_t count = doc->source_size / CINI_PARSE_CHUNK;
+    if (count > threads) {
+        count = threads;
+    }
+    if (count > CINI_PARSE_MAX) {
+        count = CINI_PARSE_MAX;
+    }
+    if (count > 1) {
+        cini_chunk_t chunks[CINI_PARSE_MAX];
+        return cini_chunk_run(doc, chunks, count);
+    }
+#else
+    (void)threads;
+#endif
+
+    while (current < end) {
+        cini_line_t *line = cini_line_alloc(doc);
+        if (!line) {
+            return false;
+        }
+        line->offset = (size_t)(current - doc->source);
+        current      = cini_line_scan(line, current, end);
+        cini_line_insert(doc, doc->tail, line);
+        if (!cini_line_index(doc, line, &group)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline const char *cini_line_scan(cini_line_t *line, const char *current, const char *end)
+{
+    // 由扫描内核跳到下一个结构字符, 找到行内第一个 '=' 后只需再找换行符
+    const char *equal = NULL;
+    const char *eol   = cini_scan(current, end);
+    while (eol < end && *eol != '\n') {
+        if (*eol == '=') {
+            equal = eol;
+            eol   = (const char *)memchr(eol + 1, '\n', (size_t)(end - eol - 1));
+            break;
+        }
+        eol = cini_scan(eol + 1, end);
+    }
+    if (eol == end) {
+        eol = NULL;
+    }
+
+    line->text = current;
+    if (eol) {
+        line->length = (size_t)(eol - current);
+        line->eol    = CINI_EOL_LF;
+        if (line->length > 0 && current[line->length - 1] == '\r') {
+            --line->length;
+            line->eol = CINI_EOL_CRLF;
+        }
+        current = eol + 1;
+    } else {
+        line->length = (size_t)(end - current);
+        line->eol    = CINI_EOL_NONE;
+        current      = end;
+    }
+
+    cini_line_classify(line, equal);
+    if (line->type == CINI_LINE_GROUP && line->length >= 2 && line->text[line->length - 1] == ']') {
+        line->hash = cini_hash(line->text + 1, line->length - 2);
+    } else if (line->type == CINI_LINE_PAIR) {
+        line->hash = cini_hash(line->text, line->key_length);
+    }
+    return current;
+}
+
+static inline bool cini_line_index(cini_doc_t *doc, cini_line_t *line, cini_group_t **group)
+{
+    // 名称哈希值只在建立索引时使用
+    const uint64_t hash = line->hash;
+    line->hash          = 0;
+
+    if (line->type == CINI_LINE_GROUP) {
+        *group = NULL;
+        // 仅记录首个同名组, 格式错误的组标题不属于任何组
+        if (line->length >= 2 && line->text[line->length - 1] == ']') {
+            cini_symbol_t *symbol = cini_symbol_intern(doc, line->text + 1, line->length - 2, hash);
+            if (!symbol) {
+                return false;
+            }
+            if (!symbol->group) {
+                cini_group_t *created = (cini_group_t *)cini_mem_calloc(&doc->allocator, sizeof(cini_group_t));
+                if (!created) {
+                    return false;
+                }
+                created->head   = line;
+                created->tail   = line;
+                created->symbol = symbol;
+                created->start  = doc->line_count;
+                created->end    = doc->line_count;
+                cini_group_append(doc, created);
+                *group = created;
+            }
+        }
+    } else if (*group && line->length > 0) {
+        (*group)->tail = line;
+        (*group)->end  = doc->line_count;
+    }
+    line->group = *group;
+
+    // 仅索引组内首个同名键
+    if (*group && line->type == CINI_LINE_PAIR) {
+        line->key = cini_symbol_intern(doc, line->text, line->key_length, hash);
+        if (!line->key) {
+            return false;
+        }
+        line->hash = cini_pair_hash((*group)->symbol, line->key);
+        if (cini_pair_lookup(doc, *group, line->key)) {
+            doc->duplicates = true;
+        } else if (!cini_table_insert(&doc->allocator, &doc->pair_index, line->hash, line)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline bool cini_layer_load(cini_doc_t *doc, const char *path, unsigned depth)
+{
+    // 嵌套过深 (含循环包含) 时失败
+    if (depth > CINI_LAYER_DEPTH) {
+        return false;
+    }
+#ifdef CINI_USE_MMAP
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        return cini_layer_directory(doc, path, depth);
+    }
+#endif
+
+    cini_doc_t *layer = cini_doc_load(path);
+    if (!layer) {
+        return false;
+    }
+    // 第一个组之前的 include 指令作为更低的层先加载, 文件本身覆盖其包含的层
+    bool isok = true;
+    for (const cini_line_t *line = layer->head; isok && line && line->type != CINI_LINE_GROUP; line = line->next) {
+        if (line->type == CINI_LINE_PAIR && line->key_length == sizeof(CINI_INCLUDE_KEY) - 1 &&
+            memcmp(line->text, CINI_INCLUDE_KEY, line->key_length) == 0) {
+            isok = cini_layer_include(doc, path, line->value, line->value_length, depth);
+        }
+    }
+    isok = isok && cini_layer_merge(doc, layer, path);
+    cini_doc_free(layer);
+    return isok;
+}
+
+static inline bool cini_layer_include(cini_doc_t *doc, const char *base, const char *value, size_t length,
+                                      unsigned depth)
+{
+    const char  *slash  = strrchr(base, '/');
+    const size_t prefix = (slash && (length == 0 || value[0] != '/')) ? (size_t)(slash - base) + 1 : 0;
+    char        *path   = (char *)doc->allocator.alloc(doc->allocator.arg, prefix + length + 1);
+    if (!path) {
+        return false;
+    }
+    memcpy(path, base, prefix);
+    memcpy(path + prefix, value, length);
+    path[prefix + length] = '\0';
+
+    const bool isok = cini_layer_load(doc, path, depth + 1);
+    cini_mem_free(&doc->allocator, path);
+    return isok;
+}
+
+static inline bool cini_layer_merge(cini_doc_t *doc, cini_doc_t *layer, const char *path)
+{
+    if (doc->layer_count == CINI_LAYER_MAX) {
+        return false;
+    }
+    const size_t length = strlen(path);
+    char        *copy   = (char *)cini_pool_alloc(doc, length + 1);
+    const char **layers = (const char **)cini_mem_grow(&doc->allocator, (void *)doc->layers,
+                                                       doc->layer_count * sizeof(const char *),
+                                                       (doc->layer_count + 1) * sizeof(const char *));
+    if (!copy || !layers) {
+        return false;
+    }
+    memcpy(copy, path, length + 1);
+    doc->layers                     = layers;
+    doc->layers[doc->layer_count++] = copy;
+
+    // 值不以'\0'结尾, 复制到缓冲区后再写入
+    char  *value    = NULL;
+    size_t capacity = 0;
+    bool   isok     = true;
+    for (cini_group_t *group = layer->groups; group && isok; group = group->next) {
+        for (const cini_line_t *line = group->head->next; line && line->type != CINI_LINE_GROUP; line = line->next) {
+            if (line->type != CINI_LINE_PAIR || cini_pair_lookup(layer, group, line->key) != line) {
+                continue;
+            }
+            if (line->value_length >= capacity) {
+                cini_mem_free(&doc->allocator, value);
+                capacity = line->value_length + 1;
+                value    = (char *)doc->allocator.alloc(doc->allocator.arg, capacity);
+            }
+            if (!value) {
+                isok = false;
+                break;
+            }
+            memcpy(value, line->value, line->value_length);
+            value[line->value_length] = '\0';
+
+            cini_line_t *merged = cini_pair_set(doc, group->symbol->name, line->key->name, value);
+            if (!merged) {
+                isok = false;
+                break;
+            }
+            merged->layer = (uint16_t)doc->layer_count;
+        }
+    }
+    cini_mem_free(&doc->allocator, value);
+    return isok;
+}
+
+#ifdef CINI_USE_MMAP
+static inline bool cini_layer_directory(cini_doc_t *doc, const char *path, unsigned depth)
+{
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return false;
+    }
+
+    // 收集 *.ini 文件名后排序, 使加载顺序与目录遍历顺序无关
+    const cini_allocator_t *allocator = &doc->allocator;
+    char                  **names     = NULL;
+    size_t                  count     = 0;
+    size_t                  capacity  = 0;
+    bool                    isok      = true;
+    for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+        const size_t length = strlen(entry->d_name);
+        if (length <= 4 || entry->d_name[0] == '.' || strcmp(entry->d_name + length - 4, ".ini") != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            char **grown = (char **)cini_mem_grow(allocator, names, count * sizeof(char *),
+                                                  (capacity ? capacity * 2 : 16) * sizeof(char *));
+            if (!grown) {
+                isok = false;
+                break;
+            }
+            names    = grown;
+            capacity = capacity ? capacity * 2 : 16;
+        }
+        char *name = (char *)allocator->alloc(allocator->arg, length + 1);
+        if (!name) {
+            isok = false;
+            break;
+        }
+        memcpy(name, entry->d_name, length + 1);
+        names[count++] = name;
+    }
+    closedir(dir);
+    if (isok && count > 1) {
+        qsort(names, count, sizeof(char *), cini_layer_compare);
+    }
+
+    // 目录中的文件相当于 "<目录>/" 中的 include 指令
+    const size_t length = strlen(path);
+    char        *base   = isok ? (char *)allocator->alloc(allocator->arg, length + 2) : NULL;
+    isok                = base != NULL;
+    if (isok) {
+        memcpy(base, path, length);
+        base[length]     = '/';
+        base[length + 1] = '\0';
+    }
+    for (size_t index = 0; index < count; ++index) {
+        isok = isok && cini_layer_include(doc, base, names[index], strlen(names[index]), depth);
+        cini_mem_free(allocator, names[index]);
+    }
+    cini_mem_free(allocator, names);
+    cini_mem_free(allocator, base);
+    return isok;
+}
+
+static int cini_layer_compare(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+#endif
+
+#ifdef CINI_USE_THREADS
+static void *cini_chunk_alloc(void *arg, size_t size)
+{
+    cini_chunk_t           *chunk     = (cini_chunk_t *)arg;
+    const cini_allocator_t *allocator = &chunk->doc->allocator;
+    pthread_mutex_lock(chunk->mutex);
+    void *ptr = allocator->alloc(allocator->arg, size);
+    pthread_mutex_unlock(chunk->mutex);
+    return ptr;
+}
+
+static void cini_chunk_free(void *arg, void *ptr)
+{
+    cini_chunk_t           *chunk     = (cini_chunk_t *)arg;
+    const cini_allocator_t *allocator = &chunk->doc->allocator;
+    pthread_mutex_lock(chunk->mutex);
+    allocator->free(allocator->arg, ptr);
+    pthread_mutex_unlock(chunk->mutex);
+}
+
+static inline cini_name_t *cini_chunk_name(cini_chunk_t *chunk, const char *text, size_t length, uint64_t hash,
+                                           bool create)
+{
+    cini_table_t *table = &chunk->names;
+    if (table->count) {
+        const size_t mask = table->capacity - 1;
+        for (size_t index = (size_t)hash & mask; table->slots[index].item; index = (index + 1) & mask) {
+            cini_name_t *name = (cini_name_t *)table->slots[index].item;
+            if (table->slots[index].hash == hash && name->length == length && memcmp(name->text, text, length) == 0) {
+                return name;
+            }
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    // 名称引用文件内容, 不复制
+    if (!chunk->blocks || chunk->blocks->used == CINI_DOC_SLAB) {
+        cini_names_t *block = (cini_names_t *)chunk->allocator.alloc(chunk->allocator.arg, sizeof(cini_names_t));
+        if (!block) {
+            return NULL;
+        }
+        block->next   = chunk->blocks;
+        block->used   = 0;
+        chunk->blocks = block;
+    }
+    cini_name_t *name = &chunk->blocks->names[chunk->blocks->used];
+    name->text        = text;
+    name->length      = length;
+    name->hash        = hash;
+    name->symbol      = NULL;
+    name->group       = NULL;
+    if (!cini_table_insert(&chunk->allocator, table, hash, name)) {
+        return NULL;
+    }
+    chunk->blocks->used++;
+    return name;
+}
+
+static void cini_chunk_scan(void *arg)
+{
+    cini_chunk_t *chunk   = (cini_chunk_t *)arg;
+    const char   *current = chunk->begin;
+    bool          grouped = false;
+    while (current < chunk->end) {
+        // 与 cini_line_alloc 相同, 但使用分块自己的内存块
+        if (!chunk->slabs || chunk->slabs->used == CINI_DOC_SLAB) {
+            cini_slab_t *slab = (cini_slab_t *)chunk->allocator.alloc(chunk->allocator.arg, sizeof(cini_slab_t));
+            if (!slab) {
+                chunk->failed = true;
+                return;
+            }
+            slab->next   = chunk->slabs;
+            slab->used   = 0;
+            chunk->slabs = slab;
+        }
+        cini_line_t *line = &chunk->slabs->lines[chunk->slabs->used++];
+        memset(line, 0, sizeof(cini_line_t));
+        current = cini_line_scan(line, current, chunk->end);
+
+        if (chunk->tail) {
+            chunk->tail->next = line;
+        } else {
+            chunk->head = line;
+        }
+        chunk->tail = line;
+        chunk->lines++;
+
+        // 按顺序记录组标题行, 驻留组名称与格式正确的组标题之后的键名称
+        if (line->type == CINI_LINE_GROUP) {
+            if (chunk->count == chunk->capacity) {
+                const size_t   capacity = chunk->capacity ? chunk->capacity * 2 : CINI_TABLE_MIN;
+                cini_header_t *headers  = (cini_header_t *)cini_mem_grow(&chunk->allocator, chunk->headers,
+                                                                         chunk->count * sizeof(cini_header_t),
+                                                                         capacity * sizeof(cini_header_t));
+                if (!headers) {
+                    chunk->failed = true;
+                    return;
+                }
+                chunk->headers  = headers;
+                chunk->capacity = capacity;
+            }
+            cini_header_t *header = &chunk->headers[chunk->count++];
+            header->line          = line;
+            header->name          = NULL;
+            grouped               = line->length >= 2 && line->text[line->length - 1] == ']';
+            if (grouped) {
+                header->name = cini_chunk_name(chunk, line->text + 1, line->length - 2, line->hash, true);
+                if (!header->name) {
+                    chunk->failed = true;
+                    return;
+                }
+            }
+        } else if (grouped && line->type == CINI_LINE_PAIR) {
+            chunk->pairs++;
+            if (!cini_chunk_name(chunk, line->text, line->key_length, line->hash, true)) {
+                chunk->failed = true;
+                return;
+            }
+        }
+    }
+}
+
+static inline bool cini_chunk_merge(cini_doc_t *doc, cini_chunk_t *chunks, size_t count)
+{
+    // 按各分块的名称数与组内键值对行数预留索引, 合并时不扩容, 之后各分块并发插入键索引
+    size_t names = doc->symbol_index.count;
+    size_t pairs = doc->pair_index.count;
+    for (size_t index = 0; index < count; ++index) {
+        names += chunks[index].names.count;
+        pairs += chunks[index].pairs;
+    }
+    if (!cini_table_reserve(&doc->allocator, &doc->symbol_index, names) ||
+        !cini_table_reserve(&doc->allocator, &doc->pair_index, pairs)) {
+        return false;
+    }
+
+    cini_line_t *tail   = NULL;
+    size_t       number = 0;
+    for (size_t index = 0; index < count; ++index) {
+        cini_chunk_t *chunk = &chunks[index];
+        for (cini_names_t *block = chunk->blocks; block; block = block->next) {
+            for (size_t item = 0; item < block->used; ++item) {
+                cini_name_t *name = &block->names[item];
+                name->symbol      = cini_symbol_intern(doc, name->text, name->length, name->hash);
+                if (!name->symbol) {
+                    return false;
+                }
+            }
+        }
+
+        // 仅首个同名组生效, 之后的同名组 (可能位于之前的分块) 与格式错误的组标题不属于任何组
+        for (size_t item = 0; item < chunk->count; ++item) {
+            const cini_header_t *header = &chunk->headers[item];
+            if (!header->name || header->name->symbol->group) {
+                continue;
+            }
+            cini_group_t *created = (cini_group_t *)cini_mem_calloc(&doc->allocator, sizeof(cini_group_t));
+            if (!created) {
+                return false;
+            }
+            created->head       = header->line;
+            created->tail       = header->line;
+            created->symbol     = header->name->symbol;
+            header->line->group = created;
+            cini_group_append(doc, created);
+        }
+
+        chunk->number  = number;
+        number        += chunk->lines;
+        if (chunk->head) {
+            chunk->head->prev = tail;
+            if (tail) {
+                tail->next = chunk->head;
+            } else {
+                doc->head = chunk->head;
+            }
+            tail = chunk->tail;
+        }
+    }
+    doc->tail       = tail;
+    doc->line_count = number;
+    return true;
+}
+
+static void cini_chunk_index(void *arg)
+{
+    cini_chunk_t *chunk  = (cini_chunk_t *)arg;
+    const char   *source = chunk->doc->source;
+    cini_table_t *table  = &chunk->doc->pair_index;
+    cini_group_t *group  = NULL;
+    cini_line_t  *line   = chunk->head;
+    cini_line_t  *prev   = line ? line->prev : NULL;
+    size_t        number = chunk->number;
+    for (size_t index = 0; index < chunk->lines; ++index, prev = line, line = line->next) {
+        // 名称哈希值只在建立索引时使用
+        const uint64_t hash = line->hash;
+        line->hash          = 0;
+        line->prev          = prev;
+        line->offset        = (size_t)(line->text - source);
+        ++number;
+
+        // 组标题行所属的组已在合并时设置
+        if (line->type == CINI_LINE_GROUP) {
+            group = line->group;
+            if (group) {
+                group->start = number;
+                group->end   = number;
+            }
+        } else {
+            if (group && line->length > 0) {
+                group->tail = line;
+                group->end  = number;
+            }
+            line->group = group;
+        }
+
+        // 组只位于一个分块内, 组内首个同名键可在分块内确定
+        if (group && line->type == CINI_LINE_PAIR) {
+            cini_name_t *name = cini_chunk_name(chunk, line->text, line->key_length, hash, false);
+            line->key         = name->symbol;
+            line->hash        = cini_pair_hash(group->symbol, line->key);
+            if (name->group == group) {
+                chunk->duplicates = true;
+            } else {
+                name->group = group;
+                cini_table_claim(table, line->hash, line);
+                chunk->indexed++;
+            }
+        }
+    }
+}
+
+static inline bool cini_chunk_run(cini_doc_t *doc, cini_chunk_t *chunks, size_t count)
+{
+    pthread_mutex_t mutex;
+    cini_task_t     tasks[CINI_PARSE_MAX];
+    const char     *begin = doc->source;
+    const char     *end   = doc->source + doc->source_size;
+
+    if (pthread_mutex_init(&mutex, NULL) != 0) {
+        return false;
+    }
+
+    // 均分后将分界点移到下一个组标题行的行首, 找不到时分块为空
+    for (size_t index = 0; index < count; ++index) {
+        const char *split = end;
+        if (index + 1 < count) {
+            split = doc->source + doc->source_size / count * (index + 1);
+            if (split < begin) {
+                split = begin;
+            }
+            while (split < end) {
+                const char *newline = (const char *)memchr(split, '\n', (size_t)(end - split));
+                split               = newline ? newline + 1 : end;
+                if (split < end && *split == '[') {
+                    break;
+                }
+            }
+        }
+        memset(&chunks[index], 0, sizeof(cini_chunk_t));
+        chunks[index].doc             = doc;
+        chunks[index].mutex           = &mutex;
+        chunks[index].allocator.alloc = cini_chunk_alloc;
+        chunks[index].allocator.free  = doc->allocator.free ? cini_chunk_free : NULL;
+        chunks[index].allocator.arg   = &chunks[index];
+        chunks[index].begin           = begin;
+        chunks[index].end             = split;
+        begin                         = split;
+        tasks[index].func             = cini_chunk_scan;
+        tasks[index].arg              = &chunks[index];
+    }
+
+    // 并行切分行, 按顺序合并名称与组后再并行建立索引
+    cini_task_run(tasks, count);
+    bool isok = true;
+    for (size_t index = 0; index < count; ++index) {
+        isok = isok && !chunks[index].failed;
+    }
+    isok = isok && cini_chunk_merge(doc, chunks, count);
+    if (isok) {
+        for (size_t index = 0; index < count; ++index) {
+            tasks[index].func = cini_chunk_index;
+        }
+        cini_task_run(tasks, count);
+        for (size_t index = 0; index < count; ++index) {
+            doc->pair_index.count += chunks[index].indexed;
+            doc->duplicates        = doc->duplicates || chunks[index].duplicates;
+        }
+    }
+    cini_chunk_release(doc, chunks, count);
+    pthread_mutex_destroy(&mutex);
+    return isok;
+}
+
+static inline void cini_chunk_release(cini_doc_t *doc, cini_chunk_t *chunks, size_t count)
+{
+    for (size_t index = 0; index < count; ++index) {
+        cini_chunk_t *chunk = &chunks[index];
+        cini_mem_free(&doc->allocator, chunk->names.slots);
+        cini_mem_free(&doc->allocator, chunk->headers);
+        while (chunk->blocks) {
+            cini_names_t *next = chunk->blocks->next;
+            cini_mem_free(&doc->allocator, chunk->blocks);
+            chunk->blocks = next;
+        }
+        // 行内存块交给文档管理, 失败时随文档一起释放
+        while (chunk->slabs) {
+            cini_slab_t *slab = chunk->slabs;
+            chunk->slabs      = slab->next;
+            slab->next        = doc->slabs;
+            doc->slabs        = slab;
+        }
+    }
+}
+
+static inline void cini_table_claim(cini_table_t *table, const uint64_t hash, void *item)
+{
+    // 以原子比较交换占用空槽位, 其他线程只读写槽位的 item
+    const size_t mask  = table->capacity - 1;
+    size_t       index = (size_t)hash & mask;
+    for (;;) {
+        void *empty = NULL;
+        if (__atomic_compare_exchange_n(&table->slots[index].item, &empty, item, false, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+            table->slots[index].hash = hash;
+            return;
+        }
+        index = (index + 1) & mask;
+    }
+}
+#endif
+
+static inline cini_line_t *cini_line_alloc(cini_doc_t *doc)
+{
+    cini_line_t *line = doc->spare;
+    if (line) {
+        doc->spare = line->next;
+    } else {
+        if (!doc->slabs || doc->slabs->used == CINI_DOC_SLAB) {
+            cini_slab_t *slab = (cini_slab_t *)doc->allocator.alloc(doc->allocator.arg, sizeof(cini_slab_t));
+            if (!slab) {
+                return NULL;
+            }
+            slab->next = doc->slabs;
+            slab->used = 0;
+            doc->slabs = slab;
+        }
+        line = &doc->slabs->lines[doc->slabs->used++];
+    }
+    memset(line, 0, sizeof(cini_line_t));
+    line->offset = CINI_OFFSET_NONE;
+    line->eol    = CINI_EOL_DEFAULT;
+    return line;
+}
+
+static inline void cini_line_release(cini_doc_t *doc, cini_line_t *line)
+{
+    if (!line) {
+        return;
+    }
+    if (line->owned) {
+        cini_mem_free(&doc->allocator, (void *)line->text);
+        line->owned = false;
+    }
+    line->next = doc->spare;
+    doc->spare = line;
+}
+
+static inline void cini_line_classify(cini_line_t *line, const char *equal)
+{
+    const char  *text   = line->text;
+    const size_t length = line->length;
+
+    line->type = CINI_LINE_OTHER;
+    if (length == 0) {
+        return;
+    }
+    if (text[0] == '[') {
+        line->type = CINI_LINE_GROUP;
+        return;
+    }
+
+    // 键以字母或数字开头
+    if (text[0] >= '0' && text[0] <= '9') {
+    } else if (text[0] >= 'a' && text[0] <= 'z') {
+    } else if (text[0] >= 'A' && text[0] <= 'Z') {
+    } else {
+        return;
+    }
+
+    if (!equal) {
+        return;
+    }
+
+    // 键与 '=' 之间只允许空白
+    const size_t position = (size_t)(equal - text);
+    size_t       index    = 1;
+    while (index < position && text[index] != ' ' && text[index] != '\t') {
+        ++index;
+    }
+    const size_t key_length = index;
+    while (index < position && (text[index] == ' ' || text[index] == '\t')) {
+        ++index;
+    }
+    if (index != position) {
+        return;
+    }
+    ++index;
+    while (index < length && (text[index] == ' ' || text[index] == '\t')) {
+        ++index;
+    }
+
+    line->type         = CINI_LINE_PAIR;
+    line->key_length   = key_length;
+    line->value        = text + index;
+    line->value_length = length - index;
+}
+
+static inline bool cini_line_format(cini_doc_t *doc, cini_line_t *line, const char *key, const char *value)
+{
+    const size_t key_length   = strlen(key);
+    const size_t value_length = strlen(value);
+    char        *text         = (char *)doc->allocator.alloc(doc->allocator.arg, key_length + value_length + 2);
+    if (!text) {
+        return false;
+    }
+    memcpy(text, key, key_length);
+    text[key_length] = '=';
+    memcpy(text + key_length + 1, value, value_length);
+    text[key_length + value_length + 1] = '\0';
+
+    if (line->owned) {
+        cini_mem_free(&doc->allocator, (void *)line->text);
+    }
+    line->text         = text;
+    line->length       = key_length + value_length + 1;
+    line->offset       = CINI_OFFSET_NONE;
+    line->owned        = true;
+    line->type         = CINI_LINE_PAIR;
+    line->key_length   = key_length;
+    line->value        = text + key_length + 1;
+    line->value_length = value_length;
+    line->cache_type   = CINI_VALUE_NONE;
+    line->layer        = 0;
+    return true;
+}
+
+static inline void cini_line_insert(cini_doc_t *doc, cini_line_t *prev, cini_line_t *line)
+{
+    if (!prev) {
+        prev = doc->tail;
+    }
+    // 最后一行没有换行符时, 补充换行符
+    if (prev && prev->eol == CINI_EOL_NONE) {
+        prev->eol    = CINI_EOL_DEFAULT;
+        prev->offset = CINI_OFFSET_NONE;
+    }
+    line->prev = prev;
+    line->next = prev ? prev->next : NULL;
+    if (line->next) {
+        line->next->prev = line;
+    } else {
+        doc->tail = line;
+    }
+    if (prev) {
+        prev->next = line;
+    } else {
+        doc->head = line;
+    }
+    doc->line_count++;
+}
+
+static inline void cini_line_unlink(cini_doc_t *doc, cini_line_t *line)
+{
+    if (line->prev) {
+        line->prev->next = line->next;
+    } else {
+        doc->head = line->next;
+    }
+    if (line->next) {
+        line->next->prev = line->prev;
+    } else {
+        doc->tail = line->prev;
+    }
+    line->prev = line->next = NULL;
+    doc->line_count--;
+}
+
+static inline cini_symbol_t *cini_symbol_lookup(const cini_doc_t *doc, const char *name, const size_t length,
+                                                const uint64_t hash)
+{
+    const cini_table_t *table = &doc->symbol_index;
+    if (!table->count) {
+        return NULL;
+    }
+    const size_t mask = table->capacity - 1;
+    for (size_t index = (size_t)hash & mask; table->slots[index].item; index = (index + 1) & mask) {
+        cini_symbol_t *symbol = (cini_symbol_t *)table->slots[index].item;
+        if (table->slots[index].hash == hash && symbol->length == length && memcmp(symbol->name, name, length) == 0) {
+            return symbol;
+        }
+    }
+    return NULL;
+}
+
+static inline cini_symbol_t *cini_symbol_intern(cini_doc_t *doc, const char *name, const size_t length,
+                                                const uint64_t hash)
+{
+    cini_symbol_t *symbol = cini_symbol_lookup(doc, name, length, hash);
+    if (symbol) {
+        return symbol;
+    }
+
+    // 名称紧跟在符号之后
+    symbol = (cini_symbol_t *)cini_pool_alloc(doc, sizeof(cini_symbol_t) + length + 1);
+    if (!symbol) {
+        return NULL;
+    }
+    char *copy = (char *)(symbol + 1);
+    memcpy(copy, name, length);
+    copy[length]   = '\0';
+    symbol->name   = copy;
+    symbol->length = length;
+    symbol->hash   = hash;
+    symbol->id     = doc->symbol_count + 1;
+    symbol->group  = NULL;
+    if (!cini_table_insert(&doc->allocator, &doc->symbol_index, hash, symbol)) {
+        return NULL;
+    }
+    doc->symbol_count++;
+    return symbol;
+}
+
+static inline void *cini_pool_alloc(cini_doc_t *doc, size_t size)
+{
+    // 按符号的对齐要求取整
+    size = (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+
+    cini_pool_t *pool = doc->pool;
+    if (!pool || pool->capacity - pool->used < size) {
+        const size_t capacity = size > CINI_POOL_CHUNK ? size : CINI_POOL_CHUNK;
+        pool = (cini_pool_t *)doc->allocator.alloc(doc->allocator.arg, sizeof(cini_pool_t) + capacity);
+        if (!pool) {
+            return NULL;
+        }
+        pool->next     = doc->pool;
+        pool->used     = 0;
+        pool->capacity = capacity;
+        doc->pool      = pool;
+    }
+    void *ptr = (unsigned char *)(pool + 1) + pool->used;
+    pool->used += size;
+    return ptr;
+}
+
+static inline uint64_t cini_pair_hash(const cini_symbol_t *group, const cini_symbol_t *key)
+{
+    uint64_t hash = (group->id << 32) ^ key->id;
+    // 混合高位, 使低位分布均匀
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline cini_group_t *cini_group_lookup(const cini_doc_t *doc, const char *name, const size_t length,
+                                              const uint64_t hash)
+{
+    const cini_symbol_t *symbol = cini_symbol_lookup(doc, name, length, hash);
+    return symbol ? symbol->group : NULL;
+}
+
+static inline cini_line_t *cini_pair_lookup(const cini_doc_t *doc, const cini_group_t *group,
+                                            const cini_symbol_t *key)
+{
+    const cini_table_t *table = &doc->pair_index;
+    if (!table->count || !key) {
+        return NULL;
+    }
+    const uint64_t hash = cini_pair_hash(group->symbol, key);
+    const size_t   mask = table->capacity - 1;
+    for (size_t index = (size_t)hash & mask; table->slots[index].item; index = (index + 1) & mask) {
+        cini_line_t *line = (cini_line_t *)table->slots[index].item;
+        if (line->key == key && line->group == group) {
+            return line;
+        }
+    }
+    return NULL;
+}
+
+static inline void cini_group_diff(cini_doc_t *doc, cini_doc_t *other, cini_group_t *group, bool removed,
+                                   cini_diff_func_t func, void *arg)
+{
+    // 两个文档的符号互不相同, 按名称查找另一文档中的符号
+    const cini_symbol_t *name  = group->symbol;
+    cini_group_t        *found = cini_group_lookup(other, name->name, name->length, name->hash);
+    for (const cini_line_t *line = group->head->next; line && line->type != CINI_LINE_GROUP; line = line->next) {
+        // 跳过非键值对行与被同名键遮蔽的行
+        if (line->type != CINI_LINE_PAIR || cini_pair_lookup(doc, group, line->key) != line) {
+            continue;
+        }
+        const cini_symbol_t *key =
+            found ? cini_symbol_lookup(other, line->key->name, line->key->length, line->key->hash) : NULL;
+        const cini_line_t *match = key ? cini_pair_lookup(other, found, key) : NULL;
+
+        cini_change_t change = {
+            .group      = name->name,
+            .group_size = name->length,
+            .key        = line->text,
+            .key_size   = line->key_length,
+        };
+        if (removed) {
+            if (match) {
+                continue;
+            }
+            change.old_value = line->value;
+            change.old_size  = line->value_length;
+        } else {
+            if (match && match->value_length == line->value_length &&
+                memcmp(match->value, line->value, line->value_length) == 0) {
+                continue;
+            }
+            if (match) {
+                change.old_value = match->value;
+                change.old_size  = match->value_length;
+            }
+            change.new_value = line->value;
+            change.new_size  = line->value_length;
+        }
+        func(&change, arg);
+    }
+}
+
+static inline bool cini_typed_get(cini_doc_t *doc, const char *group, const char *key, unsigned char type,
+                                  uint64_t *bits)
+{
+    if (!doc || !group || !key) {
+        return false;
+    }
+    cini_group_t *found = cini_group_find(doc, group);
+    cini_line_t  *line  = found ? cini_pair_find(doc, found, key) : NULL;
+    return line ? cini_typed_line(line, type, bits) : false;
+}
+
+static inline bool cini_typed_line(cini_line_t *line, unsigned char type, uint64_t *bits)
+{
+    unsigned char cached = __atomic_load_n(&line->cache_type, __ATOMIC_ACQUIRE);
+    if (cached == type) {
+        *bits = __atomic_load_n(&line->cache, __ATOMIC_RELAXED);
+        return true;
+    }
+    if (!cini_typed_convert(line, type, bits)) {
+        return false;
+    }
+    // 只有第一个转换成功的线程写入缓存, 之后不再改变
+    if (cached == CINI_VALUE_NONE &&
+        __atomic_compare_exchange_n(&line->cache_type, &cached, (unsigned char)CINI_VALUE_BUSY, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&line->cache, *bits, __ATOMIC_RELAXED);
+        __atomic_store_n(&line->cache_type, type, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+static inline bool cini_typed_set(cini_doc_t *doc, const char *group, const char *key, unsigned char type,
+                                  uint64_t bits, const char *text)
+{
+    cini_line_t *line = cini_pair_set(doc, group, key, text);
+    if (!line) {
+        return false;
+    }
+    line->cache      = bits;
+    line->cache_type = type;
+    return true;
+}
+
+static inline bool cini_typed_convert(const cini_line_t *line, unsigned char type, uint64_t *bits)
+{
+    switch (type) {
+    case CINI_VALUE_INT: {
+        int64_t value = 0;
+        if (!cini_convert_int(line->value, line->value_length, &value)) {
+            return false;
+        }
+        *bits = (uint64_t)value;
+        return true;
+    }
+    case CINI_VALUE_UINT:
+        return cini_convert_uint(line->value, line->value_length, bits);
+    case CINI_VALUE_DOUBLE: {
+        double value = 0;
+        if (!cini_convert_double(line->value, line->value_length, &value)) {
+            return false;
+        }
+        memcpy(bits, &value, sizeof(*bits));
+        return true;
+    }
+    case CINI_VALUE_BOOL: {
+        bool value = false;
+        if (!cini_convert_bool(line->value, line->value_length, &value)) {
+            return false;
+        }
+        *bits = value ? 1 : 0;
+        return true;
+    }
+    case CINI_VALUE_DURATION: {
+        int64_t value = 0;
+        if (!cini_convert_duration(line->value, line->value_length, &value)) {
+            return false;
+        }
+        *bits = (uint64_t)value;
+        return true;
+    }
+    case CINI_VALUE_SIZE:
+        return cini_convert_size(line->value, line->value_length, bits);
+    default:
+        return false;
+    }
+}
+
+static inline cini_line_t *cini_pair_set(cini_doc_t *doc, const char *group, const char *key, const char *value)
+{
+    if (!doc || doc->frozen || !group || !key || !value) {
+        return NULL;
+    }
+    doc->dirty = true;
+
+    const size_t   group_length = strlen(group);
+    const size_t   key_length   = strlen(key);
+    const uint64_t group_hash   = cini_hash(group, group_length);
+    cini_group_t  *found        = cini_group_lookup(doc, group, group_length, group_hash);
+    cini_symbol_t *name   = found ? found->symbol : cini_symbol_intern(doc, group, group_length, group_hash);
+    cini_symbol_t *symbol = cini_symbol_intern(doc, key, key_length, cini_hash(key, key_length));
+    if (!name || !symbol) {
+        return NULL;
+    }
+
+    // 修改已存在的键, 存在同组重复键时一并修改组内其余同名键
+    cini_line_t *line = found ? cini_pair_lookup(doc, found, symbol) : NULL;
+    if (line) {
+        if (!cini_line_format(doc, line, key, value)) {
+            return NULL;
+        }
+        for (cini_line_t *next = line->next; doc->duplicates && next && next->type != CINI_LINE_GROUP;
+             next = next->next) {
+            if (next->type == CINI_LINE_PAIR && next->key == symbol && !cini_line_format(doc, next, key, value)) {
+                return NULL;
+            }
+        }
+        return line;
+    }
+
+    const uint64_t pair_hash = cini_pair_hash(name, symbol);
+    line                     = cini_line_alloc(doc);
+    if (!line) {
+        return NULL;
+    }
+    if (!cini_line_format(doc, line, key, value) ||
+        !cini_table_insert(&doc->allocator, &doc->pair_index, pair_hash, line)) {
+        cini_line_release(doc, line);
+        return NULL;
+    }
+    line->key  = symbol;
+    line->hash = pair_hash;
+    cini_doc_generation_next(doc);
+
+    // 追加到已存在的组
+    if (found) {
+        line->group = found;
+        cini_line_insert(doc, found->tail, line);
+        found->tail   = line;
+        doc->renumber = true;
+        return line;
+    }
+
+    // 在文件末尾新建组
+    cini_group_t *created = (cini_group_t *)cini_mem_calloc(&doc->allocator, sizeof(cini_group_t));
+    cini_line_t  *blank   = doc->head ? cini_line_alloc(doc) : NULL;
+    cini_line_t  *header  = cini_line_alloc(doc);
+    char         *text    = (char *)doc->allocator.alloc(doc->allocator.arg, group_length + 2);
+    if (!created || (doc->head && !blank) || !header || !text) {
+        cini_mem_free(&doc->allocator, text);
+        cini_line_release(doc, header);
+        cini_line_release(doc, blank);
+        cini_mem_free(&doc->allocator, created);
+        cini_table_erase(&doc->pair_index, pair_hash, line);
+        cini_line_release(doc, line);
+        return NULL;
+    }
+
+    text[0] = '[';
+    memcpy(text + 1, group, group_length);
+    text[group_length + 1] = ']';
+    header->text           = text;
+    header->length         = group_length + 2;
+    header->owned          = true;
+    header->type           = CINI_LINE_GROUP;
+    header->group          = created;
+    line->group            = created;
+
+    if (blank) {
+        cini_line_insert(doc, doc->tail, blank);
+    }
+    cini_line_insert(doc, doc->tail, header);
+    cini_line_insert(doc, doc->tail, line);
+
+    created->head   = header;
+    created->tail   = line;
+    created->symbol = name;
+    created->start  = doc->line_count - 1;
+    created->end    = doc->line_count;
+    cini_group_append(doc, created);
+    return line;
+}
+
+static inline void cini_pair_unlink(cini_doc_t *doc, cini_group_t *group, cini_line_t *line)
+{
+    // 组内最后一个非空行被移除时, 向前查找新的最后一个非空行
+    if (group->tail == line) {
+        cini_line_t *tail = line->prev;
+        while (tail != group->head && tail->length == 0) {
+            tail = tail->prev;
+        }
+        group->tail = tail;
+    }
+    cini_line_unlink(doc, line);
+    cini_line_release(doc, line);
+}
+
+static inline cini_group_t *cini_group_find(cini_doc_t *doc, const char *group)
+{
+    const size_t length = strlen(group);
+    return cini_group_lookup(doc, group, length, cini_hash(group, length));
+}
+
+static inline cini_line_t *cini_pair_find(cini_doc_t *doc, cini_group_t *group, const char *key)
+{
+    const size_t length = strlen(key);
+    return cini_pair_lookup(doc, group, cini_symbol_lookup(doc, key, length, cini_hash(key, length)));
+}
+
+static inline bool cini_table_insert(const cini_allocator_t *allocator, cini_table_t *table, const uint64_t hash,
+                                     void *item)
+{
+    // 负载因子超过 1/2 时扩容
+    if (!cini_table_reserve(allocator, table, table->count + 1)) {
+        return false;
+    }
+
+    const size_t mask  = table->capacity - 1;
+    size_t       index = (size_t)hash & mask;
+    while (table->slots[index].item) {
+        index = (index + 1) & mask;
+    }
+    table->slots[index].hash = hash;
+    table->slots[index].item = item;
+    table->count++;
+    return true;
+}
+
+static inline bool cini_table_reserve(const cini_allocator_t *allocator, cini_table_t *table, size_t count)
+{
+    if (count * 2 <= table->capacity) {
+        return true;
+    }
+    size_t capacity = table->capacity ? table->capacity * 2 : CINI_TABLE_MIN;
+    while (count * 2 > capacity) {
+        capacity *= 2;
+    }
+    cini_slot_t *slots = (cini_slot_t *)cini_mem_calloc(allocator, capacity * sizeof(cini_slot_t));
+    if (!slots) {
+        return false;
+    }
+    for (size_t index = 0; index < table->capacity; ++index) {
+        if (!table->slots[index].item) {
+            continue;
+        }
+        size_t position = (size_t)table->slots[index].hash & (capacity - 1);
+        while (slots[position].item) {
+            position = (position + 1) & (capacity - 1);
+        }
+        slots[position] = table->slots[index];
+    }
+    cini_mem_free(allocator, table->slots);
+    table->slots    = slots;
+    table->capacity = capacity;
+    return true;
+}
+
+static inline void cini_table_erase(cini_table_t *table, const uint64_t hash, const void *item)
+{
+    if (!table->count) {
+        return;
+    }
+    const size_t mask  = table->capacity - 1;
+    size_t       index = (size_t)hash & mask;
+    while (table->slots[index].item != item) {
+        if (!table->slots[index].item) {
+            return;
+        }
+        index = (index + 1) & mask;
+    }
+
+    // 后移删除: 将后续槽位前移, 保持探测链连续
+    size_t next = index;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (!table->slots[next].item) {
+            break;
+        }
+        const size_t home = (size_t)table->slots[next].hash & mask;
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            table->slots[index] = table->slots[next];
+            index               = next;
+        }
+    }
+    table->slots[index].item = NULL;
+    table->count--;
+}
+
+static inline void cini_group_append(cini_doc_t *doc, cini_group_t *group)
+{
+    group->symbol->group = group;
+    if (doc->groups_tail) {
+        doc->groups_tail->next = group;
+    } else {
+        doc->groups = group;
+    }
+    doc->groups_tail = group;
+}
+
+static inline void cini_group_renumber(cini_doc_t *doc)
+{
+    size_t number = 0;
+    for (const cini_line_t *line = doc->head; line; line = line->next) {
+        ++number;
+        if (!line->group) {
+            continue;
+        }
+        if (line->group->head == line) {
+            line->group->start = number;
+        }
+        if (line->group->tail == line) {
+            line->group->end = number;
+        }
+    }
+    doc->renumber = false;
+}
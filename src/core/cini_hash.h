@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_HASH_H
+#define _CINI_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 哈希值会写入编译后的映像, 修改算法需同时提升映像版本号
+#define CINI_HASH_OFFSET 14695981039346656037ULL
+#define CINI_HASH_PRIME  1099511628211ULL
+
+/**
+ * @brief 继续计算哈希值 (FNV-1a)
+ * @param hash 当前哈希值
+ * @param data 数据
+ * @param length 数据长度
+ * @return 哈希值
+ */
+static inline uint64_t cini_hash_update(uint64_t hash, const char *data, const size_t length)
+{
+    for (size_t index = 0; index < length; ++index) {
+        hash ^= (unsigned char)data[index];
+        hash *= CINI_HASH_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief 计算字符串哈希值 (FNV-1a)
+ * @param data 字符串
+ * @param length 字符串长度
+ * @return 哈希值
+ */
+static inline uint64_t cini_hash(const char *data, const size_t length)
+{
+    return cini_hash_update(CINI_HASH_OFFSET, data, length);
+}
+
+/**
+ * @brief 组合组名称哈希值与键名称
+ * @param group 组名称哈希值
+ * @param key 键名称
+ * @param length 键名称长度
+ * @return 组合哈希值
+ */
+static inline uint64_t cini_hash_pair(const uint64_t group, const char *key, const size_t length)
+{
+    uint64_t hash = cini_hash(key, length) ^ (group + 0x9e3779b97f4a7c15ULL + (group << 6) + (group >> 2));
+    // 混合高位, 使低位分布均匀
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+#endif
@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cini_hash.h"
+#include "cini_image.h"
+#include "cini_stats.h"
+
+#if defined(__C_PLATFORM_LINUX) || defined(__C_PLATFORM_MAC)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CINI_USE_MMAP
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#define CINI_IMAGE_MAGIC   "CINIIMG"  // 魔数 (含结尾'\0'共 8 字节)
+#define CINI_IMAGE_VERSION 1          // 格式版本
+#define CINI_IMAGE_SLOTS   8          // 哈希表最小容量
+
+/*
+ * 映像布局, 所有偏移量均相对于映像起始位置, 与映射地址无关:
+ *   文件头 | 组目录 | 键值对表 | 组哈希表 | 键哈希表 | 字符串池
+ * 同组的键值对在键值对表中连续存放; 哈希表槽位存储 "下标 + 1", 0 表示空槽位;
+ * 字符串池中的字符串均以'\0'结尾
+ */
+
+typedef struct cini_image_header  cini_image_header_t;
+typedef struct cini_image_group   cini_image_group_t;
+typedef struct cini_image_pair    cini_image_pair_t;
+typedef struct cini_image_builder cini_image_builder_t;
+
+// 映像文件头
+struct cini_image_header {
+    char     magic[8];      // 魔数
+    uint32_t version;       // 格式版本
+    uint32_t superseded;    // 是否已被新映像替换 (原子访问)
+    uint64_t generation;    // 代数
+    uint64_t size;          // 映像总大小
+    uint64_t checksum;      // 校验和 (superseded 与 checksum 视为 0 时整个映像的 FNV-1a)
+    uint32_t group_count;   // 组数
+    uint32_t group_slots;   // 组哈希表容量 (2的幂)
+    uint32_t pair_count;    // 键值对数
+    uint32_t pair_slots;    // 键哈希表容量 (2的幂)
+    uint32_t groups;        // 组目录偏移量
+    uint32_t pairs;         // 键值对表偏移量
+    uint32_t group_table;   // 组哈希表偏移量
+    uint32_t pair_table;    // 键哈希表偏移量
+    uint32_t strings;       // 字符串池偏移量
+    uint32_t strings_size;  // 字符串池大小
+};
+
+// 组目录项
+struct cini_image_group {
+    uint64_t hash;       // 组名称哈希值
+    uint32_t name;       // 组名称在字符串池中的偏移量
+    uint32_t name_size;  // 组名称长度
+    uint32_t first;      // 第一个键值对的下标
+    uint32_t count;      // 键值对数
+};
+
+// 键值对表项
+struct cini_image_pair {
+    uint64_t hash;        // 组与键的组合哈希值
+    uint32_t group;       // 所属组的下标
+    uint32_t key;         // 键名称在字符串池中的偏移量
+    uint32_t key_size;    // 键名称长度
+    uint32_t value;       // 值在字符串池中的偏移量
+    uint32_t value_size;  // 值长度
+    uint32_t reserved;    // 保留
+};
+
+// 映像
+struct cini_image {
+    const unsigned char       *base;         // 映像起始位置
+    size_t                     size;         // 映像大小
+    bool                       mapped;       // 是否为内存映射
+    const cini_image_header_t *header;       // 文件头
+    const cini_image_group_t  *groups;       // 组目录
+    const cini_image_pair_t   *pairs;        // 键值对表
+    const uint32_t            *group_table;  // 组哈希表
+    const uint32_t            *pair_table;   // 键哈希表
+    const char                *strings;      // 字符串池
+};
+
+// 编译状态
+struct cini_image_builder {
+    cini_image_group_t *groups;        // 组目录, 为 NULL 时只统计数量
+    cini_image_pair_t  *pairs;         // 键值对表
+    char               *strings;       // 字符串池
+    size_t              group_count;   // 组数
+    size_t              pair_count;    // 键值对数
+    size_t              strings_size;  // 字符串池大小
+};
+
+/**
+ * @brief 统计或写入一个文档条目 (cini_doc_foreach 回调)
+ * @param entry 条目
+ * @param arg 编译状态
+ */
+static void cini_image_visit(const cini_entry_t *entry, void *arg);
+
+/**
+ * @brief 向字符串池追加字符串
+ * @param builder 编译状态
+ * @param data 字符串
+ * @param size 字符串长度
+ * @return 字符串偏移量
+ */
+static inline uint32_t cini_image_string(cini_image_builder_t *builder, const char *data, size_t size);
+
+/**
+ * @brief 计算哈希表容量 (负载不超过一半)
+ * @param count 项数
+ * @return 容量
+ */
+static inline size_t cini_image_slots(size_t count);
+
+/**
+ * @brief 将文档编译为映像
+ * @param doc 文档
+ * @param generation 代数
+ * @param size 存储映像大小
+ * @return 成功返回映像数据 (由调用者释放), 否则返回 NULL
+ */
+static inline unsigned char *cini_image_encode(cini_doc_t *doc, uint64_t generation, size_t *size);
+
+/**
+ * @brief 计算映像校验和
+ * @param data 映像数据
+ * @param size 映像大小
+ * @return 校验和
+ */
+static inline uint64_t cini_image_checksum(const unsigned char *data, size_t size);
+
+/**
+ * @brief 校验映像并定位各部分
+ * @param image 映像 (base 与 size 已设置)
+ * @return 格式正确返回 true, 否则返回 false
+ */
+static inline bool cini_image_attach(cini_image_t *image);
+
+/**
+ * @brief 查找组
+ * @param image 映像
+ * @param group 组名称
+ * @return 找到返回组目录项, 否则返回 NULL
+ */
+static inline const cini_image_group_t *cini_image_group_lookup(const cini_image_t *image, const char *group);
+
+/**
+ * @brief 查找键值对
+ * @param image 映像
+ * @param group 组名称
+ * @param key 键名称
+ * @return 找到返回键值对表项, 否则返回 NULL
+ */
+static inline const cini_image_pair_t *cini_image_pair_lookup(const cini_image_t *image, const char *group,
+                                                              const char *key);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+bool cini_image_publish(cini_doc_t *doc, const char *path)
+{
+    if (!doc || !path) {
+        return false;
+    }
+
+#ifdef CINI_USE_MMAP
+    // 旧映像在替换后标记为已替换, 通知已附加的进程重新附加
+    const int old_fd = open(path, O_RDWR | O_CLOEXEC);
+#endif
+
+    // 读取旧映像的代数
+    uint64_t      generation = 1;
+    cini_image_t *old_image  = cini_image_open(path);
+    if (old_image) {
+        generation = old_image->header->generation + 1;
+    }
+
+    size_t         size = 0;
+    unsigned char *data = cini_image_encode(doc, generation, &size);
+    if (!data) {
+#ifdef CINI_USE_MMAP
+        if (old_fd >= 0) {
+            close(old_fd);
+        }
+#endif
+        cini_image_free(old_image);
+        return false;
+    }
+
+    const size_t length = strlen(path) + sizeof(".tmp");
+    char        *wpath  = (char *)malloc(length);
+    FILE        *wfd    = NULL;
+    bool         isok   = false;
+    if (wpath) {
+        snprintf(wpath, length, "%s.tmp", path);
+        wfd = fopen(wpath, "wb");
+    }
+    if (wfd) {
+        cini_stats_add((cini_stats_t *)NULL, files_opened, 1);
+        cini_stats_add((cini_stats_t *)NULL, rewrites, 1);
+        isok = fwrite(data, 1, size, wfd) == size;
+        if (isok) {
+            cini_stats_add((cini_stats_t *)NULL, bytes_written, size);
+        }
+        if (fclose(wfd) != 0) {
+            isok = false;
+        }
+        if (isok) {
+#ifdef __C_PLATFORM_WIN
+            cini_image_free(old_image);
+            old_image = NULL;
+            remove(path);
+#endif
+            isok = rename(wpath, path) == 0;
+            if (isok) {
+                cini_stats_add((cini_stats_t *)NULL, renames, 1);
+            }
+        }
+        if (!isok) {
+            remove(wpath);
+        }
+    }
+    free(wpath);
+    free(data);
+
+#ifdef CINI_USE_MMAP
+    if (old_fd >= 0) {
+        if (isok && old_image) {
+            void *header = mmap(NULL, sizeof(cini_image_header_t), PROT_READ | PROT_WRITE, MAP_SHARED, old_fd, 0);
+            if (header != MAP_FAILED) {
+                __atomic_store_n(&((cini_image_header_t *)header)->superseded, 1, __ATOMIC_RELEASE);
+                munmap(header, sizeof(cini_image_header_t));
+            }
+        }
+        close(old_fd);
+    }
+#endif
+    cini_image_free(old_image);
+    return isok;
+}
+
+cini_image_t *cini_image_open(const char *path)
+{
+    if (!path) {
+        return NULL;
+    }
+    cini_image_t *image = (cini_image_t *)calloc(1, sizeof(cini_image_t));
+    if (!image) {
+        return NULL;
+    }
+
+#ifdef CINI_USE_MMAP
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        cini_stats_add((cini_stats_t *)NULL, files_opened, 1);
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (size_t)st.st_size >= sizeof(cini_image_header_t)) {
+            void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED) {
+                image->base   = (const unsigned char *)data;
+                image->size   = (size_t)st.st_size;
+                image->mapped = true;
+                cini_stats_add((cini_stats_t *)NULL, bytes_read, st.st_size);
+            }
+        }
+        close(fd);
+    }
+#else
+    FILE *rfd = fopen(path, "rb");
+    if (rfd) {
+        cini_stats_add((cini_stats_t *)NULL, files_opened, 1);
+        if (fseek(rfd, 0, SEEK_END) == 0) {
+            const long size = ftell(rfd);
+            if (size > 0 && fseek(rfd, 0, SEEK_SET) == 0) {
+                unsigned char *data = (unsigned char *)malloc((size_t)size);
+                if (data && fread(data, 1, (size_t)size, rfd) == (size_t)size) {
+                    image->base = data;
+                    image->size = (size_t)size;
+                    cini_stats_add((cini_stats_t *)NULL, bytes_read, size);
+                } else {
+                    free(data);
+                }
+            }
+        }
+        fclose(rfd);
+    }
+#endif
+
+    if (!image->base || !cini_image_attach(image)) {
+        cini_image_free(image);
+        return NULL;
+    }
+    return image;
+}
+
+void cini_image_free(cini_image_t *image)
+{
+    if (!image) {
+        return;
+    }
+#ifdef CINI_USE_MMAP
+    if (image->mapped) {
+        munmap((void *)image->base, image->size);
+    } else
+#endif
+    {
+        free((void *)image->base);
+    }
+    free(image);
+}
+
+bool cini_image_stale(const cini_image_t *image)
+{
+    return !image || __atomic_load_n(&image->header->superseded, __ATOMIC_ACQUIRE) != 0;
+}
+
+bool cini_image_verify(const cini_image_t *image)
+{
+    return image && cini_image_checksum(image->base, image->size) == image->header->checksum;
+}
+
+uint64_t cini_image_generation(const cini_image_t *image)
+{
+    return image ? image->header->generation : 0;
+}
+
+bool cini_image_group_contains(const cini_image_t *image, const char *group)
+{
+    return image && group && cini_image_group_lookup(image, group);
+}
+
+bool cini_image_value_get(const cini_image_t *image, const char *group, const char *key, const char *default_value,
+                          char *buffer, size_t max)
+{
+    if (!buffer || !max) {
+        return false;
+    }
+    const cini_image_pair_t *pair = image && group && key ? cini_image_pair_lookup(image, group, key) : NULL;
+    if (!pair) {
+        snprintf(buffer, max, "%s", default_value ? default_value : STR_NULL);
+        return false;
+    }
+
+    const size_t length = pair->value_size < max ? pair->value_size : max - 1;
+    memcpy(buffer, image->strings + pair->value, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+bool cini_image_value_view(const cini_image_t *image, const char *group, const char *key, const char **value,
+                           size_t *size)
+{
+    if (!value || !size) {
+        return false;
+    }
+    const cini_image_pair_t *pair = image && group && key ? cini_image_pair_lookup(image, group, key) : NULL;
+    *value                        = pair ? image->strings + pair->value : NULL;
+    *size                         = pair ? pair->value_size : 0;
+    return pair != NULL;
+}
+
+bool cini_image_value_contains(const cini_image_t *image, const char *group, const char *key)
+{
+    return image && group && key && cini_image_pair_lookup(image, group, key);
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static void cini_image_visit(const cini_entry_t *entry, void *arg)
+{
+    cini_image_builder_t *builder = (cini_image_builder_t *)arg;
+
+    // 统计数量
+    if (!builder->groups) {
+        if (entry->key) {
+            builder->pair_count   += 1;
+            builder->strings_size += entry->key_size + entry->value_size + 2;
+        } else {
+            builder->group_count  += 1;
+            builder->strings_size += entry->group_size + 1;
+        }
+        return;
+    }
+
+    // 写入组目录与键值对表
+    if (!entry->key) {
+        cini_image_group_t *group = &builder->groups[builder->group_count++];
+        group->hash               = cini_hash(entry->group, entry->group_size);
+        group->name               = cini_image_string(builder, entry->group, entry->group_size);
+        group->name_size          = (uint32_t)entry->group_size;
+        group->first              = (uint32_t)builder->pair_count;
+        return;
+    }
+    cini_image_group_t *group = &builder->groups[builder->group_count - 1];
+    cini_image_pair_t  *pair  = &builder->pairs[builder->pair_count++];
+    pair->hash                = cini_hash_pair(group->hash, entry->key, entry->key_size);
+    pair->group               = (uint32_t)(builder->group_count - 1);
+    pair->key                 = cini_image_string(builder, entry->key, entry->key_size);
+    pair->key_size            = (uint32_t)entry->key_size;
+    pair->value               = cini_image_string(builder, entry->value, entry->value_size);
+    pair->value_size          = (uint32_t)entry->value_size;
+    group->count += 1;
+}
+
+static inline uint32_t cini_image_string(cini_image_builder_t *builder, const char *data, size_t size)
+{
+    const size_t offset = builder->strings_size;
+    memcpy(builder->strings + offset, data, size);
+    builder->strings[offset + size] = '\0';
+    builder->strings_size += size + 1;
+    return (uint32_t)offset;
+}
+
+static inline size_t cini_image_slots(size_t count)
+{
+    size_t slots = CINI_IMAGE_SLOTS;
+    while (slots < count * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+static inline unsigned char *cini_image_encode(cini_doc_t *doc, uint64_t generation, size_t *size)
+{
+    cini_image_builder_t builder = {0};
+    cini_doc_foreach(doc, cini_image_visit, &builder);
+
+    // 计算各部分偏移量
+    const size_t group_count = builder.group_count;
+    const size_t pair_count  = builder.pair_count;
+    const size_t group_slots = cini_image_slots(group_count);
+    const size_t pair_slots  = cini_image_slots(pair_count);
+    const size_t groups      = sizeof(cini_image_header_t);
+    const size_t pairs       = groups + group_count * sizeof(cini_image_group_t);
+    const size_t group_table = pairs + pair_count * sizeof(cini_image_pair_t);
+    const size_t pair_table  = group_table + group_slots * sizeof(uint32_t);
+    const size_t strings     = pair_table + pair_slots * sizeof(uint32_t);
+    const size_t total       = strings + builder.strings_size;
+    if (total > UINT32_MAX) {
+        return NULL;
+    }
+    unsigned char *data = (unsigned char *)calloc(1, total);
+    if (!data) {
+        return NULL;
+    }
+
+    builder.groups       = (cini_image_group_t *)(void *)(data + groups);
+    builder.pairs        = (cini_image_pair_t *)(void *)(data + pairs);
+    builder.strings      = (char *)(data + strings);
+    builder.group_count  = 0;
+    builder.pair_count   = 0;
+    builder.strings_size = 0;
+    cini_doc_foreach(doc, cini_image_visit, &builder);
+
+    // 建立哈希表
+    uint32_t *group_index = (uint32_t *)(void *)(data + group_table);
+    uint32_t *pair_index  = (uint32_t *)(void *)(data + pair_table);
+    for (size_t index = 0; index < group_count; ++index) {
+        size_t slot = (size_t)builder.groups[index].hash & (group_slots - 1);
+        while (group_index[slot]) {
+            slot = (slot + 1) & (group_slots - 1);
+        }
+        group_index[slot] = (uint32_t)(index + 1);
+    }
+    for (size_t index = 0; index < pair_count; ++index) {
+        size_t slot = (size_t)builder.pairs[index].hash & (pair_slots - 1);
+        while (pair_index[slot]) {
+            slot = (slot + 1) & (pair_slots - 1);
+        }
+        pair_index[slot] = (uint32_t)(index + 1);
+    }
+
+    cini_image_header_t *header = (cini_image_header_t *)(void *)data;
+    memcpy(header->magic, CINI_IMAGE_MAGIC, sizeof(header->magic));
+    header->version      = CINI_IMAGE_VERSION;
+    header->generation   = generation;
+    header->size         = total;
+    header->group_count  = (uint32_t)group_count;
+    header->group_slots  = (uint32_t)group_slots;
+    header->pair_count   = (uint32_t)pair_count;
+    header->pair_slots   = (uint32_t)pair_slots;
+    header->groups       = (uint32_t)groups;
+    header->pairs        = (uint32_t)pairs;
+    header->group_table  = (uint32_t)group_table;
+    header->pair_table   = (uint32_t)pair_table;
+    header->strings      = (uint32_t)strings;
+    header->strings_size = (uint32_t)builder.strings_size;
+    header->checksum     = cini_image_checksum(data, total);
+
+    *size = total;
+    return data;
+}
+
+static inline uint64_t cini_image_checksum(const unsigned char *data, size_t size)
+{
+    // 文件头中会被改写的字段不参与计算
+    cini_image_header_t header;
+    memcpy(&header, data, sizeof(header));
+    header.superseded = 0;
+    header.checksum   = 0;
+
+    const uint64_t hash = cini_hash_update(CINI_HASH_OFFSET, (const char *)&header, sizeof(header));
+    return cini_hash_update(hash, (const char *)data + sizeof(header), size - sizeof(header));
+}
+
+static inline bool cini_image_attach(cini_image_t *image)
+{
+    const cini_image_header_t *header = (const cini_image_header_t *)(const void *)image->base;
+    if (image->size < sizeof(cini_image_header_t) || memcmp(header->magic, CINI_IMAGE_MAGIC, sizeof(header->magic)) ||
+        header->version != CINI_IMAGE_VERSION || header->size != image->size) {
+        return false;
+    }
+
+    // 各部分须按类型对齐且位于映像内, 哈希表容量须为2的幂并留有空槽位
+    const uint64_t size = image->size;
+    if (header->groups % 8 || header->pairs % 8 || header->group_table % 4 || header->pair_table % 4 ||
+        (uint64_t)header->groups + (uint64_t)header->group_count * sizeof(cini_image_group_t) > size ||
+        (uint64_t)header->pairs + (uint64_t)header->pair_count * sizeof(cini_image_pair_t) > size ||
+        (uint64_t)header->group_table + (uint64_t)header->group_slots * sizeof(uint32_t) > size ||
+        (uint64_t)header->pair_table + (uint64_t)header->pair_slots * sizeof(uint32_t) > size ||
+        (uint64_t)header->strings + header->strings_size > size || !header->group_slots ||
+        (header->group_slots & (header->group_slots - 1)) || header->group_count >= header->group_slots ||
+        !header->pair_slots || (header->pair_slots & (header->pair_slots - 1)) ||
+        header->pair_count >= header->pair_slots) {
+        return false;
+    }
+    image->header      = header;
+    image->groups      = (const cini_image_group_t *)(const void *)(image->base + header->groups);
+    image->pairs       = (const cini_image_pair_t *)(const void *)(image->base + header->pairs);
+    image->group_table = (const uint32_t *)(const void *)(image->base + header->group_table);
+    image->pair_table  = (const uint32_t *)(const void *)(image->base + header->pair_table);
+    image->strings     = (const char *)(image->base + header->strings);
+
+    // 字符串引用须位于字符串池内 (含结尾'\0'), 下标须有效
+    const uint64_t strings = header->strings_size;
+    for (uint32_t index = 0; index < header->group_count; ++index) {
+        const cini_image_group_t *group = &image->groups[index];
+        if ((uint64_t)group->name + group->name_size >= strings ||
+            (uint64_t)group->first + group->count > header->pair_count) {
+            return false;
+        }
+    }
+    for (uint32_t index = 0; index < header->pair_count; ++index) {
+        const cini_image_pair_t *pair = &image->pairs[index];
+        if (pair->group >= header->group_count || (uint64_t)pair->key + pair->key_size >= strings ||
+            (uint64_t)pair->value + pair->value_size >= strings) {
+            return false;
+        }
+    }
+    for (uint32_t index = 0; index < header->group_slots; ++index) {
+        if (image->group_table[index] > header->group_count) {
+            return false;
+        }
+    }
+    for (uint32_t index = 0; index < header->pair_slots; ++index) {
+        if (image->pair_table[index] > header->pair_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline const cini_image_group_t *cini_image_group_lookup(const cini_image_t *image, const char *group)
+{
+    const size_t   length = strlen(group);
+    const uint64_t hash   = cini_hash(group, length);
+    const size_t   mask   = image->header->group_slots - 1;
+    for (size_t index = (size_t)hash & mask; image->group_table[index]; index = (index + 1) & mask) {
+        const cini_image_group_t *found = &image->groups[image->group_table[index] - 1];
+        if (found->hash == hash && found->name_size == length &&
+            memcmp(image->strings + found->name, group, length) == 0) {
+            return found;
+        }
+    }
+    return NULL;
+}
+
+static inline const cini_image_pair_t *cini_image_pair_lookup(const cini_image_t *image, const char *group,
+                                                              const char *key)
+{
+    const cini_image_group_t *found = cini_image_group_lookup(image, group);
+    if (!found) {
+        return NULL;
+    }
+    const uint32_t group_index = (uint32_t)(found - image->groups);
+    const size_t   length      = strlen(key);
+    const uint64_t hash        = cini_hash_pair(found->hash, key, length);
+    const size_t   mask        = image->header->pair_slots - 1;
+    for (size_t index = (size_t)hash & mask; image->pair_table[index]; index = (index + 1) & mask) {
+        const cini_image_pair_t *pair = &image->pairs[image->pair_table[index] - 1];
+        if (pair->hash == hash && pair->group == group_index && pair->key_size == length &&
+            memcmp(image->strings + pair->key, key, length) == 0) {
+            return pair;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_IMAGE_H
+#define _CINI_IMAGE_H
+
+#include <stdint.h>
+#include "cini.h"
+
+// 编译后的只读映像: 与位置无关, 带版本号与校验和, 可映射到多个进程中共享
+typedef struct cini_image cini_image_t;
+
+/**
+ * @brief 将文档编译为映像并发布到文件 (如 /dev/shm 下的共享文件或磁盘上的 .cinib 文件)
+ * 先写入临时文件 "<path>.tmp" 再替换目标文件, 已附加旧映像的进程不受影响;
+ * 新映像的代数为旧映像加一, 旧映像被标记为已替换. 同一路径只能有一个发布者
+ * @param doc 文档
+ * @param path 映像文件路径
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_image_publish(cini_doc_t *doc, const char *path);
+
+/**
+ * @brief 以只读方式附加映像
+ * 映像以共享方式映射, 多个进程附加同一映像时共用物理内存
+ * @param path 映像文件路径
+ * @return cini_image_t* 成功返回映像, 文件不存在或格式错误返回 NULL
+ */
+CINI_EXPORT cini_image_t *cini_image_open(const char *path);
+
+/**
+ * @brief 释放映像
+ * @param image 映像
+ */
+CINI_EXPORT void cini_image_free(cini_image_t *image);
+
+/**
+ * @brief 判断映像是否已被新发布的映像替换 (需重新调用 cini_image_open 附加)
+ * @param image 映像
+ * @return bool 已替换返回true，否则返回false
+ */
+CINI_EXPORT bool cini_image_stale(const cini_image_t *image);
+
+/**
+ * @brief 校验映像内容的校验和
+ * 附加时只检查结构, 保证查询不会越界; 需要发现内容损坏时调用此函数 (需遍历整个映像)
+ * @param image 映像
+ * @return bool 校验和一致返回true，否则返回false
+ */
+CINI_EXPORT bool cini_image_verify(const cini_image_t *image);
+
+/**
+ * @brief 获取映像代数
+ * @param image 映像
+ * @return uint64_t 代数, 每次发布加一
+ */
+CINI_EXPORT uint64_t cini_image_generation(const cini_image_t *image);
+
+/**
+ * @brief 判断组是否存在
+ * @param image 映像
+ * @param group 组名称
+ * @return bool 存在返回true，不存在返回false
+ */
+CINI_EXPORT bool cini_image_group_contains(const cini_image_t *image, const char *group);
+
+/**
+ * @brief 获取指定组中指定键的值
+ * @param image 映像
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param buffer 存储值的缓冲区
+ * @param max 缓冲区大小
+ * @return bool 键存在返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_image_value_get(const cini_image_t *image, const char *group, const char *key,
+                                      const char *default_value, char *buffer, size_t max);
+
+/**
+ * @brief 获取指定组中指定键的值, 不复制
+ * 值指向映像的字符串区, 以'\0'结尾, 在映像释放之前保持有效
+ * @param image 映像
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 存储值的起始位置, 键不存在时为 NULL
+ * @param size 存储值的长度
+ * @return bool 键存在返回true，否则返回false
+ */
+CINI_EXPORT bool cini_image_value_view(const cini_image_t *image, const char *group, const char *key,
+                                       const char **value, size_t *size);
+
+/**
+ * @brief 判断指定组中指定键是否存在
+ * @param image 映像
+ * @param group 组名称
+ * @param key 键名称
+ * @return bool 存在返回true，不存在返回false
+ */
+CINI_EXPORT bool cini_image_value_contains(const cini_image_t *image, const char *group, const char *key);
+
+#endif
@@ -0,0 +1,467 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "cini_hash.h"
+#include "cini_io.h"
+
+#ifdef __C_PLATFORM_WIN
+#include <io.h>
+#define cini_file_open_read(path) _open(path, _O_RDONLY | _O_BINARY)
+#define cini_file_open_write(path) _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define cini_file_read(fd, buffer, size) _read(fd, buffer, (unsigned)(size))
+#define cini_file_write(fd, data, size) _write(fd, data, (unsigned)(size))
+#define cini_file_close(fd) _close(fd)
+#else
+#include <unistd.h>
+#define cini_file_open_read(path) open(path, O_RDONLY | O_CLOEXEC)
+#define cini_file_open_write(path) open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+#define cini_file_read(fd, buffer, size) read(fd, buffer, size)
+#define cini_file_write(fd, data, size) write(fd, data, size)
+#define cini_file_close(fd) close(fd)
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+// 文件后端打开的文件
+typedef struct cini_file {
+    int   fd;       // 文件描述符
+    bool  write;    // 是否以写入方式打开
+    char *wpath;    // 临时文件路径 (仅写入)
+    char  path[];   // 目标文件路径 (仅写入)
+} cini_file_t;
+
+// 内存后端与嵌入内容后端
+typedef struct cini_memory {
+    cini_io_t   io;       // 后端接口 (必须为第一个成员)
+    const char *data;     // 内容
+    size_t      size;     // 内容长度
+    uint64_t    version;  // 内容版本
+    bool        owned;    // 内容是否由后端分配 (可写入)
+} cini_memory_t;
+
+// 内存后端打开的内容
+typedef struct cini_memory_file {
+    cini_memory_t *memory;    // 后端
+    bool           write;     // 是否以写入方式打开
+    char          *data;      // 写入的内容
+    size_t         size;      // 读取: 已读取的长度; 写入: 已写入的长度
+    size_t         capacity;  // 写入缓冲区大小
+} cini_memory_file_t;
+
+/**
+ * @brief 文件后端: 打开文件
+ * @param arg 后端参数 (未使用)
+ * @param path 文件路径
+ * @param write 是否以写入方式打开 (写入临时文件)
+ * @return void* 成功返回打开的文件, 失败返回 NULL
+ */
+static void *cini_file_open(void *arg, const char *path, bool write);
+
+/**
+ * @brief 文件后端: 读取
+ * @param file 打开的文件
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @return long 读取的字节数, 结束返回 0, 失败返回 -1
+ */
+static long cini_file_read_func(void *file, char *buffer, size_t size);
+
+/**
+ * @brief 文件后端: 写入
+ * @param file 打开的文件
+ * @param data 数据
+ * @param size 数据长度
+ * @return bool 全部写入返回true，失败返回false
+ */
+static bool cini_file_write_func(void *file, const char *data, size_t size);
+
+/**
+ * @brief 文件后端: 以临时文件替换目标文件并关闭
+ * @param file 打开的文件
+ * @return bool 成功返回true，失败返回false
+ */
+static bool cini_file_replace(void *file);
+
+/**
+ * @brief 文件后端: 关闭, 写入时删除临时文件
+ * @param file 打开的文件
+ */
+static void cini_file_close_func(void *file);
+
+/**
+ * @brief 文件后端: 文件版本
+ * @param arg 后端参数 (未使用)
+ * @param path 文件路径
+ * @param version 存储版本
+ * @return bool 文件存在返回true，否则返回false
+ */
+static bool cini_file_version(void *arg, const char *path, uint64_t *version);
+
+/**
+ * @brief 内存后端: 打开内容
+ * @param arg 后端
+ * @param path 路径 (忽略)
+ * @param write 是否以写入方式打开
+ * @return void* 成功返回打开的内容, 失败返回 NULL
+ */
+static void *cini_memory_open(void *arg, const char *path, bool write);
+
+/**
+ * @brief 内存后端: 读取
+ * @param file 打开的内容
+ * @param buffer 缓冲区
+ * @param size 缓冲区大小
+ * @return long 读取的字节数, 结束返回 0
+ */
+static long cini_memory_read(void *file, char *buffer, size_t size);
+
+/**
+ * @brief 内存后端: 写入
+ * @param file 打开的内容
+ * @param data 数据
+ * @param size 数据长度
+ * @return bool 成功返回true，内存不足返回false
+ */
+static bool cini_memory_write(void *file, const char *data, size_t size);
+
+/**
+ * @brief 内存后端: 以写入的内容替换原内容并关闭
+ * @param file 打开的内容
+ * @return bool 成功返回true
+ */
+static bool cini_memory_replace(void *file);
+
+/**
+ * @brief 内存后端: 关闭, 丢弃写入的内容
+ * @param file 打开的内容
+ */
+static void cini_memory_close(void *file);
+
+/**
+ * @brief 嵌入内容后端: 直接引用内容
+ * @param arg 后端
+ * @param path 路径 (忽略)
+ * @param size 存储内容长度
+ * @return const char* 内容
+ */
+static const char *cini_memory_view(void *arg, const char *path, size_t *size);
+
+/**
+ * @brief 内存后端: 内容版本
+ * @param arg 后端
+ * @param path 路径 (忽略)
+ * @param version 存储版本
+ * @return bool 总是返回true
+ */
+static bool cini_memory_version(void *arg, const char *path, uint64_t *version);
+
+/**
+ * @brief 创建内存后端或嵌入内容后端
+ * @param data 内容
+ * @param size 内容长度
+ * @param owned 是否复制内容 (内存后端)
+ * @return cini_io_t* 成功返回后端, 失败返回 NULL
+ */
+static inline cini_io_t *cini_memory_create(const char *data, size_t size, bool owned);
+
+// 文件后端
+static const cini_io_t cini_io_file_backend = {
+    .open    = cini_file_open,
+    .read    = cini_file_read_func,
+    .write   = cini_file_write_func,
+    .replace = cini_file_replace,
+    .close   = cini_file_close_func,
+    .view    = NULL,
+    .version = cini_file_version,
+    .arg     = NULL,
+};
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+const cini_io_t *cini_io_file(void)
+{
+    return &cini_io_file_backend;
+}
+
+cini_io_t *cini_io_memory_create(const char *data, size_t size)
+{
+    if (!data && size) {
+        return NULL;
+    }
+    return cini_memory_create(data, size, true);
+}
+
+cini_io_t *cini_io_blob_create(const void *data, size_t size)
+{
+    if (!data && size) {
+        return NULL;
+    }
+    return cini_memory_create((const char *)data, size, false);
+}
+
+const char *cini_io_data(const cini_io_t *io, size_t *size)
+{
+    const cini_memory_t *memory = (const cini_memory_t *)io;
+    if (size) {
+        *size = memory ? memory->size : 0;
+    }
+    return memory ? memory->data : NULL;
+}
+
+void cini_io_free(cini_io_t *io)
+{
+    cini_memory_t *memory = (cini_memory_t *)io;
+    if (!memory) {
+        return;
+    }
+    if (memory->owned) {
+        free((void *)memory->data);
+    }
+    free(memory);
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static void *cini_file_open(void *arg, const char *path, bool write)
+{
+    (void)arg;
+    const size_t length = write ? strlen(path) + 1 : 0;
+    cini_file_t *file   = (cini_file_t *)malloc(sizeof(cini_file_t) + length * 2 + sizeof(".tmp"));
+    if (!file) {
+        return NULL;
+    }
+    file->write = write;
+    file->wpath = NULL;
+    if (!write) {
+        file->fd = cini_file_open_read(path);
+    } else {
+        memcpy(file->path, path, length);
+        file->wpath = file->path + length;
+        snprintf(file->wpath, length + sizeof(".tmp"), "%s.tmp", path);
+        file->fd = cini_file_open_write(file->wpath);
+    }
+    if (file->fd < 0) {
+        free(file);
+        return NULL;
+    }
+    return file;
+}
+
+static long cini_file_read_func(void *file, char *buffer, size_t size)
+{
+    const int fd = ((cini_file_t *)file)->fd;
+    for (;;) {
+        const long count = (long)cini_file_read(fd, buffer, size);
+        if (count >= 0 || errno != EINTR) {
+            return count < 0 ? -1 : count;
+        }
+    }
+}
+
+static bool cini_file_write_func(void *file, const char *data, size_t size)
+{
+    const int fd = ((cini_file_t *)file)->fd;
+    while (size > 0) {
+        const long count = (long)cini_file_write(fd, data, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= (size_t)count;
+    }
+    return true;
+}
+
+static bool cini_file_replace(void *file)
+{
+    cini_file_t *self = (cini_file_t *)file;
+    bool         isok = self->write && cini_file_close(self->fd) == 0;
+    if (isok) {
+#ifdef __C_PLATFORM_WIN
+        remove(self->path);
+#endif
+        isok = rename(self->wpath, self->path) == 0;
+    }
+    if (!isok && self->write) {
+        remove(self->wpath);
+    }
+    free(self);
+    return isok;
+}
+
+static void cini_file_close_func(void *file)
+{
+    cini_file_t *self = (cini_file_t *)file;
+    cini_file_close(self->fd);
+    if (self->write) {
+        remove(self->wpath);
+    }
+    free(self);
+}
+
+static bool cini_file_version(void *arg, const char *path, uint64_t *version)
+{
+    (void)arg;
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    const uint64_t fields[] = {
+        (uint64_t)st.st_dev,
+        (uint64_t)st.st_ino,
+        (uint64_t)st.st_size,
+        (uint64_t)st.st_mtime,
+#if defined(__C_PLATFORM_MAC)
+        (uint64_t)st.st_mtimespec.tv_nsec,
+#elif !defined(__C_PLATFORM_WIN)
+        (uint64_t)st.st_mtim.tv_nsec,
+#endif
+    };
+    *version = cini_hash((const char *)fields, sizeof(fields));
+    return true;
+}
+
+static void *cini_memory_open(void *arg, const char *path, bool write)
+{
+    (void)path;
+    cini_memory_t *memory = (cini_memory_t *)arg;
+    if (write && !memory->owned) {
+        return NULL;
+    }
+    cini_memory_file_t *file = (cini_memory_file_t *)calloc(1, sizeof(cini_memory_file_t));
+    if (file) {
+        file->memory = memory;
+        file->write  = write;
+    }
+    return file;
+}
+
+static long cini_memory_read(void *file, char *buffer, size_t size)
+{
+    cini_memory_file_t  *self   = (cini_memory_file_t *)file;
+    const cini_memory_t *memory = self->memory;
+    if (self->size >= memory->size) {
+        return 0;
+    }
+    if (size > memory->size - self->size) {
+        size = memory->size - self->size;
+    }
+    memcpy(buffer, memory->data + self->size, size);
+    self->size += size;
+    return (long)size;
+}
+
+static bool cini_memory_write(void *file, const char *data, size_t size)
+{
+    cini_memory_file_t *self = (cini_memory_file_t *)file;
+    if (size == 0) {
+        return true;
+    }
+    if (size > self->capacity - self->size) {
+        size_t capacity = self->capacity ? self->capacity : 256;
+        while (size > capacity - self->size) {
+            capacity *= 2;
+        }
+        char *grown = (char *)realloc(self->data, capacity);
+        if (!grown) {
+            return false;
+        }
+        self->data     = grown;
+        self->capacity = capacity;
+    }
+    memcpy(self->data + self->size, data, size);
+    self->size += size;
+    return true;
+}
+
+static bool cini_memory_replace(void *file)
+{
+    cini_memory_file_t *self   = (cini_memory_file_t *)file;
+    cini_memory_t      *memory = self->memory;
+    if (!self->write) {
+        cini_memory_close(file);
+        return false;
+    }
+    free((void *)memory->data);
+    memory->data = self->data;
+    memory->size = self->size;
+    ++memory->version;
+    free(self);
+    return true;
+}
+
+static void cini_memory_close(void *file)
+{
+    cini_memory_file_t *self = (cini_memory_file_t *)file;
+    free(self->data);
+    free(self);
+}
+
+static const char *cini_memory_view(void *arg, const char *path, size_t *size)
+{
+    (void)path;
+    const cini_memory_t *memory = (const cini_memory_t *)arg;
+    *size                       = memory->size;
+    // 空内容也需返回非 NULL 的指针
+    return memory->data ? memory->data : STR_NULL;
+}
+
+static bool cini_memory_version(void *arg, const char *path, uint64_t *version)
+{
+    (void)path;
+    *version = ((const cini_memory_t *)arg)->version;
+    return true;
+}
+
+static inline cini_io_t *cini_memory_create(const char *data, size_t size, bool owned)
+{
+    cini_memory_t *memory = (cini_memory_t *)calloc(1, sizeof(cini_memory_t));
+    if (!memory) {
+        return NULL;
+    }
+    if (owned && size > 0) {
+        char *copy = (char *)malloc(size);
+        if (!copy) {
+            free(memory);
+            return NULL;
+        }
+        memcpy(copy, data, size);
+        data = copy;
+    }
+    memory->data       = owned && size == 0 ? NULL : data;
+    memory->size       = size;
+    memory->owned      = owned;
+    memory->io.open    = cini_memory_open;
+    memory->io.read    = cini_memory_read;
+    memory->io.write   = cini_memory_write;
+    memory->io.replace = cini_memory_replace;
+    memory->io.close   = cini_memory_close;
+    memory->io.view    = owned ? NULL : cini_memory_view;
+    memory->io.version = cini_memory_version;
+    memory->io.arg     = memory;
+    return &memory->io;
+}
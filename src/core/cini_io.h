@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_IO_H
+#define _CINI_IO_H
+
+#include "cini.h"
+
+/**
+ * @brief 获取文件后端
+ * 以文件描述符读写, 不映射文件; 写入先写 "<path>.tmp" 再重命名替换目标文件;
+ * 版本由文件的 inode、大小与修改时间组成. 可作为自定义后端的参考实现
+ * @return const cini_io_t* 文件后端 (静态, 无需释放)
+ */
+CINI_EXPORT const cini_io_t *cini_io_file(void);
+
+/**
+ * @brief 创建内存后端
+ * 内容保存在后端分配的内存中, 忽略路径; 每次替换内容后版本加一. 不支持多个线程同时访问
+ * @param data 初始内容 (复制), 可为 NULL
+ * @param size 初始内容长度
+ * @return cini_io_t* 成功返回后端, 失败返回 NULL, 不再使用时调用 cini_io_free 释放
+ */
+CINI_EXPORT cini_io_t *cini_io_memory_create(const char *data, size_t size);
+
+/**
+ * @brief 创建只读的嵌入内容后端 (如编译进程序或位于 flash 中的配置)
+ * 不复制内容, 加载的文档直接引用; 忽略路径, 写入失败
+ * @param data 内容, 需在后端及由其加载的文档使用期间保持不变
+ * @param size 内容长度
+ * @return cini_io_t* 成功返回后端, 失败返回 NULL, 不再使用时调用 cini_io_free 释放
+ */
+CINI_EXPORT cini_io_t *cini_io_blob_create(const void *data, size_t size);
+
+/**
+ * @brief 获取内存后端或嵌入内容后端的当前内容
+ * 内存后端的内容在下一次替换后失效
+ * @param io 由 cini_io_memory_create 或 cini_io_blob_create 创建的后端
+ * @param size 存储内容长度
+ * @return const char* 内容, 不保证以'\0'结尾
+ */
+CINI_EXPORT const char *cini_io_data(const cini_io_t *io, size_t *size);
+
+/**
+ * @brief 释放由 cini_io_memory_create 或 cini_io_blob_create 创建的后端
+ * @param io 后端
+ */
+CINI_EXPORT void cini_io_free(cini_io_t *io);
+
+#endif
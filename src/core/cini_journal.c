@@ -0,0 +1,643 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cini_journal.h"
+#include "cini_stats.h"
+
+#if defined(__C_PLATFORM_LINUX) || defined(__C_PLATFORM_MAC)
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#define CINI_USE_JOURNAL
+#endif
+
+// 合并失败后的重试间隔 (毫秒) 使用的时钟; macOS 的条件变量不支持指定时钟
+#ifdef __C_PLATFORM_LINUX
+#define CINI_JOURNAL_CLOCK CLOCK_MONOTONIC
+#else
+#define CINI_JOURNAL_CLOCK CLOCK_REALTIME
+#endif
+
+#define CINI_JOURNAL_SUFFIX      ".journal"  // 日志文件名后缀
+#define CINI_JOURNAL_TEMP        ".tmp"      // 合并时替换日志的临时文件后缀
+#define CINI_JOURNAL_BACKOFF     1000        // 合并失败后首次重试前等待的毫秒数
+#define CINI_JOURNAL_BACKOFF_MAX 60000       // 合并连续失败时重试间隔的上限 (毫秒)
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#ifdef CINI_USE_JOURNAL
+
+// 日志: 记录为文本, 以长度前缀分隔, 名称与值中可包含任意字符
+//   设置: "=<组名长度>,<键长度>,<值长度>:<组名><键><值>\n"
+//   移除: "-<组名长度>,<键长度>:<组名><键>\n"
+struct cini_journal {
+    cini_doc_t     *doc;        // 内存中的最新状态 (配置文件加上日志)
+    const char     *path;       // 配置文件路径
+    char           *log;        // 日志文件路径
+    char           *temp;       // 替换日志的临时文件路径
+    cini_stats_t   *stats;      // 句柄计数
+    int             fd;         // 日志文件 (追加写入)
+    size_t          size;       // 日志长度
+    size_t          threshold;  // 日志长度达到该值时合并
+    char           *record;     // 记录缓冲区
+    size_t          capacity;   // 记录缓冲区大小
+    bool            sync;       // 每条记录写入后是否同步到存储设备
+    bool            due;        // 是否需要合并
+    bool            failed;     // 追加或合并失败 (日志不完整), 需整体写入配置文件
+    unsigned        backoff;    // 合并失败后下次重试前等待的毫秒数, 最近一次合并成功时为 0
+    struct timespec since;      // 最近一次合并失败的时间
+    bool            running;    // 后台线程是否运行
+    pthread_t       thread;     // 后台线程
+    pthread_mutex_t mutex;      // 保护文档与日志
+    pthread_mutex_t compact;    // 串行化合并
+    pthread_cond_t  cond;       // 唤醒后台线程
+};
+
+/**
+ * @brief 读取日志并应用到文档, 截掉末尾不完整的记录
+ * @param journal 日志
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_journal_replay(cini_journal_t *journal);
+
+/**
+ * @brief 将日志内容中的记录依次应用到文档
+ * @param doc 文档
+ * @param data 日志内容
+ * @param size 日志内容长度
+ * @param valid 存储完整记录的总长度
+ * @return 成功返回 true, 应用记录失败返回 false
+ */
+static inline bool cini_journal_apply(cini_doc_t *doc, const char *data, size_t size, size_t *valid);
+
+/**
+ * @brief 解析记录头中以 ',' 分隔、以 ':' 结尾的长度
+ * @param current 起始位置
+ * @param end 内容结束位置
+ * @param lengths 存储长度
+ * @param count 长度个数
+ * @return 成功返回记录体的起始位置, 否则返回 NULL
+ */
+static inline const char *cini_journal_header(const char *current, const char *end, size_t *lengths, size_t count);
+
+/**
+ * @brief 追加一条记录
+ * @param journal 日志
+ * @param group 组名称
+ * @param key 键名称
+ * @param value 值, 为 NULL 时记录移除
+ * @param value_length 值长度
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_journal_append(cini_journal_t *journal, const char *group, const char *key, const char *value,
+                                       size_t value_length);
+
+/**
+ * @brief 丢弃日志中已合并到配置文件的部分
+ * 合并期间追加的记录写入临时文件后替换日志
+ * @param journal 日志
+ * @param mark 已合并的长度
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_journal_trim(cini_journal_t *journal, size_t mark);
+
+/**
+ * @brief 释放日志持有的路径、缓冲区与文件 (不包括文档与同步对象)
+ * @param journal 日志
+ */
+static inline void cini_journal_release(cini_journal_t *journal);
+
+/**
+ * @brief 初始化使用 CINI_JOURNAL_CLOCK 计时的条件变量
+ * @param cond 条件变量
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_journal_cond_init(pthread_cond_t *cond);
+
+/**
+ * @brief 从文件的指定位置读取全部内容
+ * @param fd 文件描述符
+ * @param offset 位置
+ * @param buffer 缓冲区
+ * @param size 读取长度
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_journal_read(int fd, size_t offset, char *buffer, size_t size);
+
+/**
+ * @brief 写入全部内容
+ * @param fd 文件描述符
+ * @param data 内容
+ * @param size 内容长度
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_journal_write(int fd, const char *data, size_t size);
+
+/**
+ * @brief 后台线程入口
+ * @param arg 日志
+ * @return NULL
+ */
+static void *cini_journal_main(void *arg);
+
+#endif
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+#ifdef CINI_USE_JOURNAL
+
+cini_journal_t *cini_journal_create(cini_doc_t *doc, const char *path, cini_stats_t *stats, size_t threshold,
+                                    bool sync)
+{
+    if (!doc || !path) {
+        return NULL;
+    }
+    cini_journal_t *journal = (cini_journal_t *)calloc(1, sizeof(cini_journal_t));
+    if (!journal) {
+        return NULL;
+    }
+    const size_t length = strlen(path);
+    journal->fd         = -1;
+    journal->log        = (char *)malloc(length + sizeof(CINI_JOURNAL_SUFFIX));
+    journal->temp       = (char *)malloc(length + sizeof(CINI_JOURNAL_SUFFIX CINI_JOURNAL_TEMP));
+    if (!journal->log || !journal->temp) {
+        cini_journal_release(journal);
+        return NULL;
+    }
+    snprintf(journal->log, length + sizeof(CINI_JOURNAL_SUFFIX), "%s" CINI_JOURNAL_SUFFIX, path);
+    snprintf(journal->temp, length + sizeof(CINI_JOURNAL_SUFFIX CINI_JOURNAL_TEMP),
+             "%s" CINI_JOURNAL_SUFFIX CINI_JOURNAL_TEMP, path);
+    journal->doc       = doc;
+    journal->path      = path;
+    journal->stats     = stats;
+    journal->threshold = threshold;
+    journal->sync      = sync;
+
+    // 打开日志并应用其中的记录
+    journal->fd = open(journal->log, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (journal->fd < 0 || !cini_journal_replay(journal)) {
+        cini_journal_release(journal);
+        return NULL;
+    }
+    cini_stats_add(stats, files_opened, 1);
+
+    if (pthread_mutex_init(&journal->mutex, NULL) != 0) {
+        cini_journal_release(journal);
+        return NULL;
+    }
+    if (pthread_mutex_init(&journal->compact, NULL) != 0) {
+        pthread_mutex_destroy(&journal->mutex);
+        cini_journal_release(journal);
+        return NULL;
+    }
+    if (!cini_journal_cond_init(&journal->cond)) {
+        pthread_mutex_destroy(&journal->compact);
+        pthread_mutex_destroy(&journal->mutex);
+        cini_journal_release(journal);
+        return NULL;
+    }
+    journal->due     = journal->size >= threshold;
+    journal->running = true;
+    if (pthread_create(&journal->thread, NULL, cini_journal_main, journal) != 0) {
+        pthread_cond_destroy(&journal->cond);
+        pthread_mutex_destroy(&journal->compact);
+        pthread_mutex_destroy(&journal->mutex);
+        cini_journal_release(journal);
+        return NULL;
+    }
+    return journal;
+}
+
+bool cini_journal_free(cini_journal_t *journal)
+{
+    if (!journal) {
+        return true;
+    }
+    pthread_mutex_lock(&journal->mutex);
+    journal->running = false;
+    pthread_cond_signal(&journal->cond);
+    pthread_mutex_unlock(&journal->mutex);
+    pthread_join(journal->thread, NULL);
+
+    // 全部合并后移除空的日志
+    const bool isok = cini_journal_flush(journal);
+    if (isok) {
+        remove(journal->log);
+    }
+    cini_doc_free(journal->doc);
+    pthread_cond_destroy(&journal->cond);
+    pthread_mutex_destroy(&journal->compact);
+    pthread_mutex_destroy(&journal->mutex);
+    cini_journal_release(journal);
+    return isok;
+}
+
+cini_doc_t *cini_journal_enter(cini_journal_t *journal)
+{
+    pthread_mutex_lock(&journal->mutex);
+    return journal->doc;
+}
+
+void cini_journal_leave(cini_journal_t *journal, const char *group, const char *key)
+{
+    if (key) {
+        const char *value  = NULL;
+        size_t      length = 0;
+        const bool  exists = cini_doc_value_view(journal->doc, group, key, &value, &length);
+        if (!cini_journal_append(journal, group, key, exists ? value : NULL, length)) {
+            // 截掉可能只写入了一部分的记录, 无法截掉时之后的记录跟在其后, 合并时一并丢弃
+            journal->failed = true;
+            if (ftruncate(journal->fd, (off_t)journal->size) != 0) {
+                const off_t end = lseek(journal->fd, 0, SEEK_END);
+                journal->size   = end > 0 ? (size_t)end : journal->size;
+            }
+        }
+        if ((journal->failed || journal->size >= journal->threshold) && !journal->due) {
+            journal->due = true;
+            pthread_cond_signal(&journal->cond);
+        }
+    }
+    pthread_mutex_unlock(&journal->mutex);
+}
+
+bool cini_journal_flush(cini_journal_t *journal)
+{
+    pthread_mutex_lock(&journal->compact);
+    pthread_mutex_lock(&journal->mutex);
+    journal->due = false;
+    if (journal->size == 0 && !journal->failed) {
+        pthread_mutex_unlock(&journal->mutex);
+        pthread_mutex_unlock(&journal->compact);
+        return true;
+    }
+
+    // 在锁内序列化并记录日志长度, 之后追加的记录在合并后保留
+    size_t       size = 0;
+    char        *data = cini_doc_dump(journal->doc, &size);
+    const size_t mark = journal->size;
+    journal->failed   = false;
+    pthread_mutex_unlock(&journal->mutex);
+
+    // 先整体替换配置文件再丢弃日志, 中断时重新应用日志的结果相同
+    bool isok = data && cini_dump_save(NULL, journal->path, data, size, journal->stats);
+    free(data);
+
+    pthread_mutex_lock(&journal->mutex);
+    isok = isok && cini_journal_trim(journal, mark);
+    if (!isok) {
+        // 连续失败时重试间隔加倍
+        journal->failed  = true;
+        journal->backoff = journal->backoff ? journal->backoff * 2 : CINI_JOURNAL_BACKOFF;
+        journal->backoff = journal->backoff < CINI_JOURNAL_BACKOFF_MAX ? journal->backoff : CINI_JOURNAL_BACKOFF_MAX;
+        clock_gettime(CINI_JOURNAL_CLOCK, &journal->since);
+    } else {
+        journal->backoff = 0;
+    }
+    pthread_mutex_unlock(&journal->mutex);
+    pthread_mutex_unlock(&journal->compact);
+    return isok;
+}
+
+#else
+
+cini_journal_t *cini_journal_create(cini_doc_t *doc, const char *path, cini_stats_t *stats, size_t threshold,
+                                    bool sync)
+{
+    (void)doc;
+    (void)path;
+    (void)stats;
+    (void)threshold;
+    (void)sync;
+    return NULL;
+}
+
+bool cini_journal_free(cini_journal_t *journal)
+{
+    (void)journal;
+    return true;
+}
+
+cini_doc_t *cini_journal_enter(cini_journal_t *journal)
+{
+    (void)journal;
+    return NULL;
+}
+
+void cini_journal_leave(cini_journal_t *journal, const char *group, const char *key)
+{
+    (void)journal;
+    (void)group;
+    (void)key;
+}
+
+bool cini_journal_flush(cini_journal_t *journal)
+{
+    (void)journal;
+    return true;
+}
+
+#endif
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+#ifdef CINI_USE_JOURNAL
+
+static inline bool cini_journal_replay(cini_journal_t *journal)
+{
+    struct stat st;
+    if (fstat(journal->fd, &st) != 0) {
+        return false;
+    }
+    const size_t size = (size_t)st.st_size;
+    if (size == 0) {
+        return true;
+    }
+    char *data = (char *)malloc(size);
+    if (!data || !cini_journal_read(journal->fd, 0, data, size)) {
+        free(data);
+        return false;
+    }
+    cini_stats_add(journal->stats, bytes_read, size);
+
+    size_t     valid = 0;
+    const bool isok  = cini_journal_apply(journal->doc, data, size, &valid);
+    free(data);
+    if (!isok || (valid < size && ftruncate(journal->fd, (off_t)valid) != 0)) {
+        return false;
+    }
+    journal->size = valid;
+    return true;
+}
+
+static inline bool cini_journal_apply(cini_doc_t *doc, const char *data, size_t size, size_t *valid)
+{
+    const char *current  = data;
+    const char *end      = data + size;
+    char       *buffer   = NULL;
+    size_t      capacity = 0;
+    bool        isok     = true;
+    while (isok && current < end) {
+        size_t       lengths[3] = {0, 0, 0};
+        const size_t count      = *current == '=' ? 3 : *current == '-' ? 2 : 0;
+        const char  *body       = count ? cini_journal_header(current + 1, end, lengths, count) : NULL;
+        if (!body) {
+            break;
+        }
+        // 各长度均不超过剩余内容时求和不会溢出
+        const size_t rest   = (size_t)(end - body);
+        const size_t length = lengths[0] + lengths[1] + lengths[2];
+        if (lengths[0] > rest || lengths[1] > rest || lengths[2] > rest || length >= rest || body[length] != '\n') {
+            break;
+        }
+
+        // 复制为以'\0'结尾的名称与值
+        if (length + 3 > capacity) {
+            free(buffer);
+            capacity = length + 3;
+            buffer   = (char *)malloc(capacity);
+            if (!buffer) {
+                isok = false;
+                break;
+            }
+        }
+        char *group = buffer;
+        char *key   = group + lengths[0] + 1;
+        char *value = key + lengths[1] + 1;
+        memcpy(group, body, lengths[0]);
+        group[lengths[0]] = '\0';
+        memcpy(key, body + lengths[0], lengths[1]);
+        key[lengths[1]] = '\0';
+        memcpy(value, body + lengths[0] + lengths[1], lengths[2]);
+        value[lengths[2]] = '\0';
+
+        if (count == 3) {
+            isok = cini_doc_value_set(doc, group, key, value);
+        } else {
+            cini_doc_value_remove(doc, group, key);
+        }
+        current = body + length + 1;
+    }
+    free(buffer);
+    *valid = (size_t)(current - data);
+    return isok;
+}
+
+static inline const char *cini_journal_header(const char *current, const char *end, size_t *lengths, size_t count)
+{
+    for (size_t index = 0; index < count; ++index) {
+        const char *start = current;
+        size_t      value = 0;
+        while (current < end && *current >= '0' && *current <= '9') {
+            if (value > (SIZE_MAX - 9) / 10) {
+                return NULL;
+            }
+            value = value * 10 + (size_t)(*current - '0');
+            ++current;
+        }
+        if (current == start || current == end || *current != (index + 1 == count ? ':' : ',')) {
+            return NULL;
+        }
+        lengths[index] = value;
+        ++current;
+    }
+    return current;
+}
+
+static inline bool cini_journal_append(cini_journal_t *journal, const char *group, const char *key, const char *value,
+                                       size_t value_length)
+{
+    const size_t group_length = strlen(group);
+    const size_t key_length   = strlen(key);
+    char         header[80];
+    int          count = 0;
+    if (value) {
+        count = snprintf(header, sizeof(header), "=%zu,%zu,%zu:", group_length, key_length, value_length);
+    } else {
+        count        = snprintf(header, sizeof(header), "-%zu,%zu:", group_length, key_length);
+        value_length = 0;
+    }
+    if (count < 0) {
+        return false;
+    }
+
+    // 整条记录一次写入
+    const size_t length = (size_t)count + group_length + key_length + value_length + 1;
+    if (length > journal->capacity) {
+        char *record = (char *)realloc(journal->record, length);
+        if (!record) {
+            return false;
+        }
+        journal->record   = record;
+        journal->capacity = length;
+    }
+    char *current = journal->record;
+    memcpy(current, header, (size_t)count);
+    current += count;
+    memcpy(current, group, group_length);
+    current += group_length;
+    memcpy(current, key, key_length);
+    current += key_length;
+    if (value_length > 0) {
+        memcpy(current, value, value_length);
+        current += value_length;
+    }
+    *current = '\n';
+
+    if (!cini_journal_write(journal->fd, journal->record, length) || (journal->sync && fsync(journal->fd) != 0)) {
+        return false;
+    }
+    journal->size += length;
+    cini_stats_add(journal->stats, bytes_written, length);
+    return true;
+}
+
+static inline bool cini_journal_trim(cini_journal_t *journal, size_t mark)
+{
+    if (mark == journal->size) {
+        if (ftruncate(journal->fd, 0) != 0) {
+            return false;
+        }
+        journal->size = 0;
+        return true;
+    }
+
+    // 合并期间追加的记录写入新的日志文件后原子替换
+    const size_t size = journal->size - mark;
+    char        *data = (char *)malloc(size);
+    if (!data || !cini_journal_read(journal->fd, mark, data, size)) {
+        free(data);
+        return false;
+    }
+    const int fd = open(journal->temp, O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        free(data);
+        return false;
+    }
+    cini_stats_add(journal->stats, files_opened, 1);
+    bool isok = cini_journal_write(fd, data, size) && (!journal->sync || fsync(fd) == 0);
+    free(data);
+    isok = isok && rename(journal->temp, journal->log) == 0;
+    if (!isok) {
+        close(fd);
+        remove(journal->temp);
+        return false;
+    }
+    cini_stats_add(journal->stats, bytes_written, size);
+    close(journal->fd);
+    journal->fd   = fd;
+    journal->size = size;
+    return true;
+}
+
+static inline void cini_journal_release(cini_journal_t *journal)
+{
+    if (journal->fd >= 0) {
+        close(journal->fd);
+    }
+    free(journal->record);
+    free(journal->temp);
+    free(journal->log);
+    free(journal);
+}
+
+static inline bool cini_journal_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) {
+        return false;
+    }
+#ifdef __C_PLATFORM_LINUX
+    bool isok = pthread_condattr_setclock(&attr, CINI_JOURNAL_CLOCK) == 0 && pthread_cond_init(cond, &attr) == 0;
+#else
+    bool isok = pthread_cond_init(cond, &attr) == 0;
+#endif
+    pthread_condattr_destroy(&attr);
+    return isok;
+}
+
+static inline bool cini_journal_read(int fd, size_t offset, char *buffer, size_t size)
+{
+    while (size > 0) {
+        const ssize_t count = pread(fd, buffer, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        buffer += count;
+        offset += (size_t)count;
+        size   -= (size_t)count;
+    }
+    return true;
+}
+
+static inline bool cini_journal_write(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t count = write(fd, data, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= (size_t)count;
+    }
+    return true;
+}
+
+static void *cini_journal_main(void *arg)
+{
+    cini_journal_t *journal = (cini_journal_t *)arg;
+    pthread_mutex_lock(&journal->mutex);
+    while (journal->running) {
+        if (!journal->due) {
+            pthread_cond_wait(&journal->cond, &journal->mutex);
+            continue;
+        }
+        if (journal->backoff) {
+            // 合并失败后等待 backoff 毫秒再重试, 期间的修改只追加到日志, 不反复整体写入配置文件
+            struct timespec deadline = journal->since;
+            deadline.tv_sec += (time_t)(journal->backoff / 1000);
+            deadline.tv_nsec += (long)(journal->backoff % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            if (pthread_cond_timedwait(&journal->cond, &journal->mutex, &deadline) != ETIMEDOUT) {
+                continue;
+            }
+        }
+        pthread_mutex_unlock(&journal->mutex);
+        cini_journal_flush(journal);
+        pthread_mutex_lock(&journal->mutex);
+    }
+    pthread_mutex_unlock(&journal->mutex);
+    return NULL;
+}
+
+#endif
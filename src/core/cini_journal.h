@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_JOURNAL_H
+#define _CINI_JOURNAL_H
+
+#include "cini.h"
+
+// 库内部使用: cini_t 的日志模式 (见 cini_journal_set)
+
+/**
+ * @brief 创建日志: 将日志文件 "<path>.journal" 中的记录应用到文档, 之后的修改追加到日志,
+ * 并启动合并日志的后台线程 (仅支持 Linux 与 macOS)
+ * 日志末尾不完整的记录 (写入时中断) 被丢弃
+ * @param doc 由配置文件加载的文档 (已 detach), 成功后由日志持有
+ * @param path 配置文件路径, 需在日志使用期间保持有效
+ * @param stats 句柄计数, 可为 NULL
+ * @param threshold 日志长度达到该值 (字节) 时合并到配置文件
+ * @param sync 每条记录写入后是否同步到存储设备
+ * @return 成功返回日志, 不支持的平台或失败返回 NULL
+ */
+cini_journal_t *cini_journal_create(cini_doc_t *doc, const char *path, cini_stats_t *stats, size_t threshold,
+                                    bool sync);
+
+/**
+ * @brief 停止后台线程, 将日志合并到配置文件后释放日志与文档
+ * @param journal 日志, 可为 NULL
+ * @return 合并成功 (或没有日志) 返回 true, 否则返回 false (日志保留, 下次加载时应用)
+ */
+bool cini_journal_free(cini_journal_t *journal);
+
+/**
+ * @brief 开始访问文档, 在 cini_journal_leave 之前后台线程不会读取文档
+ * @param journal 日志
+ * @return 文档
+ */
+cini_doc_t *cini_journal_enter(cini_journal_t *journal);
+
+/**
+ * @brief 结束访问文档, 将被修改的键的当前状态 (值或已移除) 追加到日志
+ * 追加失败时日志不再完整, 由后台线程整体写入配置文件
+ * @param journal 日志
+ * @param group 组名称
+ * @param key 被修改或移除的键, 未修改时为 NULL
+ */
+void cini_journal_leave(cini_journal_t *journal, const char *group, const char *key);
+
+/**
+ * @brief 在当前线程中立即将日志合并到配置文件
+ * @param journal 日志
+ * @return 合并成功 (或没有日志) 返回 true, 否则返回 false
+ */
+bool cini_journal_flush(cini_journal_t *journal);
+
+#endif
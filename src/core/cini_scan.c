@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "cini_scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <immintrin.h>
+#define CINI_SCAN_X86
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+// 结构字符表
+static const unsigned char cini_scan_table[256] = {
+    ['\n'] = 1,
+    ['=']  = 1,
+    ['[']  = 1,
+    [']']  = 1,
+};
+
+// 当前选用的扫描实现 (宽松原子操作访问, 可在多个解析线程中首次选用)
+static cini_scan_func_t cini_scan_current = NULL;
+
+/**
+ * @brief 逐字节查表扫描
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @return 找到返回字符位置, 否则返回 end
+ */
+static const char *cini_scan_scalar(const char *begin, const char *end);
+
+#ifdef CINI_SCAN_X86
+/**
+ * @brief SSE2 扫描, 每次比较 16 字节
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @return 找到返回字符位置, 否则返回 end
+ */
+static const char *cini_scan_sse2(const char *begin, const char *end);
+
+/**
+ * @brief AVX2 扫描, 每次比较 32 字节
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @return 找到返回字符位置, 否则返回 end
+ */
+static const char *cini_scan_avx2(const char *begin, const char *end) __attribute__((target("avx2")));
+#endif
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+cini_scan_func_t cini_scan_func(int kind)
+{
+    switch (kind) {
+    case CINI_SCAN_SCALAR:
+        return cini_scan_scalar;
+#ifdef CINI_SCAN_X86
+    case CINI_SCAN_SSE2:
+        return cini_scan_sse2;
+    case CINI_SCAN_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? cini_scan_avx2 : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+const char *cini_scan(const char *begin, const char *end)
+{
+    cini_scan_func_t func = __atomic_load_n(&cini_scan_current, __ATOMIC_RELAXED);
+    if (!func) {
+        func = cini_scan_func(CINI_SCAN_AVX2);
+        if (!func) {
+            func = cini_scan_func(CINI_SCAN_SSE2);
+        }
+        if (!func) {
+            func = cini_scan_func(CINI_SCAN_SCALAR);
+        }
+        // 各线程选出的实现相同, 以原子写入发布, 重复写入结果一致
+        __atomic_store_n(&cini_scan_current, func, __ATOMIC_RELAXED);
+    }
+    return func(begin, end);
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static const char *cini_scan_scalar(const char *begin, const char *end)
+{
+    while (begin < end && !cini_scan_table[(unsigned char)*begin]) {
+        ++begin;
+    }
+    return begin;
+}
+
+#ifdef CINI_SCAN_X86
+static const char *cini_scan_sse2(const char *begin, const char *end)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i equal   = _mm_set1_epi8('=');
+    const __m128i open    = _mm_set1_epi8('[');
+    const __m128i close   = _mm_set1_epi8(']');
+
+    while (end - begin >= 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i *)(const void *)begin);
+        const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, equal)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(block, open), _mm_cmpeq_epi8(block, close)));
+        const unsigned mask = (unsigned)_mm_movemask_epi8(found);
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return cini_scan_scalar(begin, end);
+}
+
+static const char *cini_scan_avx2(const char *begin, const char *end)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i equal   = _mm256_set1_epi8('=');
+    const __m256i open    = _mm256_set1_epi8('[');
+    const __m256i close   = _mm256_set1_epi8(']');
+
+    while (end - begin >= 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i *)(const void *)begin);
+        const __m256i found =
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, equal)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(block, open), _mm256_cmpeq_epi8(block, close)));
+        const unsigned mask = (unsigned)_mm256_movemask_epi8(found);
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return cini_scan_sse2(begin, end);
+}
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_SCAN_H
+#define _CINI_SCAN_H
+
+#include "cini.h"
+
+// 扫描实现
+enum cini_scan_kind {
+    CINI_SCAN_SCALAR = 0,  // 逐字节查表
+    CINI_SCAN_SSE2,        // 每次 16 字节
+    CINI_SCAN_AVX2,        // 每次 32 字节
+};
+
+/**
+ * @brief 扫描函数
+ * 查找 [begin, end) 中第一个结构字符 ('\n', '=', '[', ']')
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @return const char* 找到返回字符位置, 否则返回 end
+ */
+typedef const char *(*cini_scan_func_t)(const char *begin, const char *end);
+
+/**
+ * @brief 获取指定扫描实现
+ * @param kind 扫描实现
+ * @return cini_scan_func_t 当前平台或CPU不支持时返回 NULL
+ */
+CINI_EXPORT cini_scan_func_t cini_scan_func(int kind);
+
+/**
+ * @brief 查找第一个结构字符 (首次调用时按CPU特性选择最快的实现)
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @return const char* 找到返回字符位置, 否则返回 end
+ */
+CINI_EXPORT const char *cini_scan(const char *begin, const char *end);
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "cini_snap.h"
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#define CINI_SNAP_CACHELINE 64  // 缓存行大小
+
+typedef struct cini_snap_retired cini_snap_retired_t;
+
+// 读者
+struct cini_snap_reader {
+    unsigned char       before[CINI_SNAP_CACHELINE];  // 填充, 避免与相邻数据共享缓存行
+    uint64_t            epoch;                        // 进入时观察到的纪元, 0 表示不在读取区
+    unsigned char       after[CINI_SNAP_CACHELINE];   // 填充
+    cini_snap_t        *snap;                         // 所属发布者
+    cini_snap_reader_t *next;                         // 下一个读者
+};
+
+// 待释放的旧快照
+struct cini_snap_retired {
+    cini_snap_retired_t *next;   // 下一个
+    cini_doc_t          *doc;    // 文档
+    uint64_t             epoch;  // 被替换时的纪元
+};
+
+// 发布者
+struct cini_snap {
+    cini_doc_t          *current;  // 当前快照 (原子访问)
+    uint64_t             epoch;    // 全局纪元 (原子访问), 每次发布加一
+    cini_snap_reader_t  *readers;  // 读者链表
+    cini_snap_retired_t *retired;  // 待释放的旧快照
+    pthread_mutex_t      mutex;    // 保护读者链表与待释放链表, 串行化发布
+};
+
+/**
+ * @brief 释放不再被引用的旧快照 (调用者持有锁)
+ * @param snap 发布者
+ */
+static inline void cini_snap_collect(cini_snap_t *snap);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+cini_snap_t *cini_snap_create(void)
+{
+    cini_snap_t *snap = (cini_snap_t *)calloc(1, sizeof(cini_snap_t));
+    if (!snap) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&snap->mutex, NULL) != 0) {
+        free(snap);
+        return NULL;
+    }
+    snap->epoch = 1;
+    return snap;
+}
+
+void cini_snap_free(cini_snap_t *snap)
+{
+    if (!snap) {
+        return;
+    }
+    while (snap->retired) {
+        cini_snap_retired_t *next = snap->retired->next;
+        cini_doc_free(snap->retired->doc);
+        free(snap->retired);
+        snap->retired = next;
+    }
+    while (snap->readers) {
+        cini_snap_reader_t *next = snap->readers->next;
+        free(snap->readers);
+        snap->readers = next;
+    }
+    cini_doc_free(snap->current);
+    pthread_mutex_destroy(&snap->mutex);
+    free(snap);
+}
+
+bool cini_snap_publish(cini_snap_t *snap, cini_doc_t *doc)
+{
+    if (!snap || !doc || !cini_doc_freeze(doc)) {
+        return false;
+    }
+    cini_snap_retired_t *retired = (cini_snap_retired_t *)malloc(sizeof(cini_snap_retired_t));
+    if (!retired) {
+        return false;
+    }
+
+    pthread_mutex_lock(&snap->mutex);
+    cini_doc_t *old = __atomic_exchange_n(&snap->current, doc, __ATOMIC_SEQ_CST);
+    if (old) {
+        // 纪元在交换之后递增: 之后进入的读者必然看到新快照
+        retired->doc   = old;
+        retired->epoch = __atomic_fetch_add(&snap->epoch, 1, __ATOMIC_SEQ_CST);
+        retired->next  = snap->retired;
+        snap->retired  = retired;
+        cini_snap_collect(snap);
+    } else {
+        free(retired);
+    }
+    pthread_mutex_unlock(&snap->mutex);
+    return true;
+}
+
+bool cini_snap_load(cini_snap_t *snap, const char *path)
+{
+    if (!snap) {
+        return false;
+    }
+    cini_doc_t *doc = cini_doc_load(path);
+    if (!doc) {
+        return false;
+    }
+    if (!cini_snap_publish(snap, doc)) {
+        cini_doc_free(doc);
+        return false;
+    }
+    return true;
+}
+
+void cini_snap_reclaim(cini_snap_t *snap)
+{
+    if (!snap) {
+        return;
+    }
+    pthread_mutex_lock(&snap->mutex);
+    cini_snap_collect(snap);
+    pthread_mutex_unlock(&snap->mutex);
+}
+
+cini_snap_reader_t *cini_snap_reader_create(cini_snap_t *snap)
+{
+    if (!snap) {
+        return NULL;
+    }
+    cini_snap_reader_t *reader = (cini_snap_reader_t *)calloc(1, sizeof(cini_snap_reader_t));
+    if (!reader) {
+        return NULL;
+    }
+    reader->snap = snap;
+
+    pthread_mutex_lock(&snap->mutex);
+    reader->next  = snap->readers;
+    snap->readers = reader;
+    pthread_mutex_unlock(&snap->mutex);
+    return reader;
+}
+
+void cini_snap_reader_free(cini_snap_reader_t *reader)
+{
+    if (!reader) {
+        return;
+    }
+    cini_snap_t *snap = reader->snap;
+    pthread_mutex_lock(&snap->mutex);
+    for (cini_snap_reader_t **link = &snap->readers; *link; link = &(*link)->next) {
+        if (*link == reader) {
+            *link = reader->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&snap->mutex);
+    free(reader);
+}
+
+cini_doc_t *cini_snap_enter(cini_snap_reader_t *reader)
+{
+    cini_snap_t *snap = reader->snap;
+    // 先公布观察到的纪元, 再读取当前快照; 发布者据此判断旧快照是否仍可能被引用
+    __atomic_store_n(&reader->epoch, __atomic_load_n(&snap->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&snap->current, __ATOMIC_SEQ_CST);
+}
+
+void cini_snap_leave(cini_snap_reader_t *reader)
+{
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+bool cini_snap_value_get(cini_snap_reader_t *reader, const char *group, const char *key, const char *default_value,
+                         char *buffer, size_t max)
+{
+    if (!reader) {
+        return false;
+    }
+    cini_doc_t *doc = cini_snap_enter(reader);
+    bool        isok;
+    if (doc) {
+        isok = cini_doc_value_get(doc, group, key, default_value, buffer, max);
+    } else {
+        isok = false;
+        if (buffer && max) {
+            snprintf(buffer, max, "%s", default_value ? default_value : STR_NULL);
+        }
+    }
+    cini_snap_leave(reader);
+    return isok;
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline void cini_snap_collect(cini_snap_t *snap)
+{
+    // 仍在读取区的读者中最早的纪元; 纪元不大于旧快照纪元的读者可能仍在引用它
+    uint64_t oldest = UINT64_MAX;
+    for (const cini_snap_reader_t *reader = snap->readers; reader; reader = reader->next) {
+        const uint64_t epoch = __atomic_load_n(&reader->epoch, __ATOMIC_SEQ_CST);
+        if (epoch && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    for (cini_snap_retired_t **link = &snap->retired; *link;) {
+        cini_snap_retired_t *retired = *link;
+        if (retired->epoch < oldest) {
+            *link = retired->next;
+            cini_doc_free(retired->doc);
+            free(retired);
+        } else {
+            link = &retired->next;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_SNAP_H
+#define _CINI_SNAP_H
+
+#include "cini.h"
+
+// 快照发布者: 持有当前发布的只读文档
+typedef struct cini_snap cini_snap_t;
+// 快照读者: 每个读取线程注册一个
+typedef struct cini_snap_reader cini_snap_reader_t;
+
+/**
+ * @brief 创建快照发布者
+ * @return cini_snap_t* 成功返回发布者, 失败返回 NULL
+ */
+CINI_EXPORT cini_snap_t *cini_snap_create(void);
+
+/**
+ * @brief 释放快照发布者及其所有快照 (调用前所有读者必须已释放)
+ * @param snap 发布者
+ */
+CINI_EXPORT void cini_snap_free(cini_snap_t *snap);
+
+/**
+ * @brief 发布新快照
+ * 冻结文档后以原子交换替换当前快照, 旧快照在所有可能引用它的读者离开后释放;
+ * 成功时文档归发布者所有, 调用者不可再修改或释放
+ * @param snap 发布者
+ * @param doc 文档
+ * @return bool 成功返回true，失败返回false (文档仍归调用者所有)
+ */
+CINI_EXPORT bool cini_snap_publish(cini_snap_t *snap, cini_doc_t *doc);
+
+/**
+ * @brief 加载配置文件并发布为新快照
+ * @param snap 发布者
+ * @param path 配置文件路径
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_snap_load(cini_snap_t *snap, const char *path);
+
+/**
+ * @brief 释放不再被任何读者引用的旧快照 (发布时自动调用)
+ * @param snap 发布者
+ */
+CINI_EXPORT void cini_snap_reclaim(cini_snap_t *snap);
+
+/**
+ * @brief 注册读者
+ * @param snap 发布者
+ * @return cini_snap_reader_t* 成功返回读者, 失败返回 NULL
+ */
+CINI_EXPORT cini_snap_reader_t *cini_snap_reader_create(cini_snap_t *snap);
+
+/**
+ * @brief 注销并释放读者
+ * @param reader 读者
+ */
+CINI_EXPORT void cini_snap_reader_free(cini_snap_reader_t *reader);
+
+/**
+ * @brief 进入读取区, 获取当前快照 (无等待, 不可嵌套)
+ * 返回的文档在 cini_snap_leave 之前保持有效, 只可调用只读接口
+ * @param reader 读者
+ * @return cini_doc_t* 当前快照, 尚未发布时返回 NULL
+ */
+CINI_EXPORT cini_doc_t *cini_snap_enter(cini_snap_reader_t *reader);
+
+/**
+ * @brief 离开读取区
+ * @param reader 读者
+ */
+CINI_EXPORT void cini_snap_leave(cini_snap_reader_t *reader);
+
+/**
+ * @brief 从当前快照获取指定组中指定键的值
+ * @param reader 读者
+ * @param group 组名称
+ * @param key 键名称
+ * @param default_value 默认值
+ * @param buffer 存储值的缓冲区
+ * @param max 缓冲区大小
+ * @return bool 键存在返回true，否则写入默认值并返回false
+ */
+CINI_EXPORT bool cini_snap_value_get(cini_snap_reader_t *reader, const char *group, const char *key,
+                                     const char *default_value, char *buffer, size_t max);
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "cini_stats.h"
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+/**
+ * @brief 读取计数快照 (宽松原子操作, 各字段分别读取)
+ * @param from 计数
+ * @param to 存储快照
+ */
+static inline void cini_stats_load(const cini_stats_t *from, cini_stats_t *to);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+cini_stats_t cini_stats_process = {0, 0, 0, 0, 0, 0, 0};
+
+void cini_stats_get(cini_t *self, cini_stats_t *stats)
+{
+    if (self && stats) {
+        cini_stats_load(&self->stats, stats);
+    }
+}
+
+void cini_stats_reset(cini_t *self)
+{
+    if (!self) {
+        return;
+    }
+    __atomic_store_n(&self->stats.files_opened, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.bytes_read, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.bytes_written, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.lines_scanned, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.rewrites, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.renames, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.splices, 0, __ATOMIC_RELAXED);
+}
+
+void cini_stats_global_get(cini_stats_t *stats)
+{
+    if (stats) {
+        cini_stats_load(&cini_stats_process, stats);
+    }
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline void cini_stats_load(const cini_stats_t *from, cini_stats_t *to)
+{
+    to->files_opened  = __atomic_load_n(&from->files_opened, __ATOMIC_RELAXED);
+    to->bytes_read    = __atomic_load_n(&from->bytes_read, __ATOMIC_RELAXED);
+    to->bytes_written = __atomic_load_n(&from->bytes_written, __ATOMIC_RELAXED);
+    to->lines_scanned = __atomic_load_n(&from->lines_scanned, __ATOMIC_RELAXED);
+    to->rewrites      = __atomic_load_n(&from->rewrites, __ATOMIC_RELAXED);
+    to->renames       = __atomic_load_n(&from->renames, __ATOMIC_RELAXED);
+    to->splices       = __atomic_load_n(&from->splices, __ATOMIC_RELAXED);
+}
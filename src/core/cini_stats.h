@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_STATS_H
+#define _CINI_STATS_H
+
+#include "cini.h"
+
+// 库内部使用: I/O 计数的累加与带计数的文档读写
+
+// 进程内所有文件访问的累计计数
+extern cini_stats_t cini_stats_process;
+
+/**
+ * @brief 累加计数 (宽松原子操作), 同时计入进程计数与 stats 指向的计数 (可为 NULL)
+ * @param stats 句柄计数
+ * @param field 计数字段
+ * @param value 增量
+ */
+#define cini_stats_add(stats, field, value)                                                                            \
+    do {                                                                                                               \
+        cini_stats_t  *_stats = (stats);                                                                               \
+        const uint64_t _value = (uint64_t)(value);                                                                     \
+        __atomic_fetch_add(&cini_stats_process.field, _value, __ATOMIC_RELAXED);                                       \
+        if (_stats) {                                                                                                  \
+            __atomic_fetch_add(&_stats->field, _value, __ATOMIC_RELAXED);                                              \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @brief 加载文件并计数 (同 cini_doc_load_alloc)
+ * @param allocator 内存分配器, 为 NULL 时使用 malloc
+ * @param io I/O 后端, 为 NULL 时直接访问文件
+ * @param path 文件路径
+ * @param threads 解析线程数, 0 或 1 表示单线程
+ * @param stats 句柄计数, 可为 NULL
+ * @return 成功返回文档, 否则返回 NULL
+ */
+cini_doc_t *cini_doc_load_stats(const cini_allocator_t *allocator, const cini_io_t *io, const char *path,
+                                unsigned threads, cini_stats_t *stats);
+
+/**
+ * @brief 保存文档并计数 (同 cini_doc_save_io 与 cini_doc_save_mode)
+ * @param doc 文档
+ * @param io I/O 后端, 为 NULL 时直接访问文件 (使用后端时总是整体替换内容)
+ * @param path 文件路径
+ * @param mode 保存方式 (enum cini_save_mode)
+ * @param stats 句柄计数, 可为 NULL
+ * @return 成功返回 true, 否则返回 false
+ */
+bool cini_doc_save_stats(cini_doc_t *doc, const cini_io_t *io, const char *path, int mode, cini_stats_t *stats);
+
+/**
+ * @brief 将文档序列化到内存 (内容与保存后的文件相同)
+ * @param doc 文档
+ * @param size 存储内容长度
+ * @return 成功返回内容 (由 malloc 分配, 调用者 free), 否则返回 NULL
+ */
+char *cini_doc_dump(const cini_doc_t *doc, size_t *size);
+
+/**
+ * @brief 以序列化的内容整体替换文件并计数
+ * @param io I/O 后端, 为 NULL 时直接访问文件 (写入 "<path>.tmp" 后重命名)
+ * @param path 文件路径
+ * @param data 内容
+ * @param size 内容长度
+ * @param stats 句柄计数, 可为 NULL
+ * @return 成功返回 true, 否则返回 false
+ */
+bool cini_dump_save(const cini_io_t *io, const char *path, const char *data, size_t size, cini_stats_t *stats);
+
+/**
+ * @brief 判断文件是否变化并计数 (同 cini_doc_changed)
+ * 使用 I/O 后端时比较后端报告的内容版本, 后端未提供版本时视为已变化
+ * @param doc 文档
+ * @param io I/O 后端, 为 NULL 时直接访问文件
+ * @param path 文件路径
+ * @param content 状态变化时是否比较内容哈希值
+ * @param stats 句柄计数, 可为 NULL
+ * @return 变化返回 true, 否则返回 false
+ */
+bool cini_doc_changed_stats(cini_doc_t *doc, const cini_io_t *io, const char *path, bool content,
+                            cini_stats_t *stats);
+
+#endif
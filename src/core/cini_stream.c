@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cini_stats.h"
+#include "cini_stream.h"
+
+#ifdef __C_PLATFORM_WIN
+#include <io.h>
+#define cini_stream_open(path) _open(path, _O_RDONLY | _O_BINARY)
+#define cini_stream_read(fd, buffer, size) _read(fd, buffer, (unsigned)(size))
+#define cini_stream_close(fd) _close(fd)
+#else
+#include <unistd.h>
+#define cini_stream_open(path) open(path, O_RDONLY)
+#define cini_stream_read(fd, buffer, size) read(fd, buffer, size)
+#define cini_stream_close(fd) close(fd)
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#define CINI_STREAM_CHUNK 65536  // 读取缓冲区的初始大小, 行超过缓冲区时加倍
+
+// 解析状态
+typedef struct cini_stream_state {
+    const cini_stream_t *stream;          // 回调
+    char                *group;           // 当前组名称 (复制, 读取缓冲区会被覆盖)
+    size_t               group_size;      // 当前组名称长度
+    size_t               group_capacity;  // 组名称缓冲区大小
+    bool                 grouped;         // 是否在有效的组内
+    uint64_t             lines;           // 已解析的行数 (结束时计入进程计数)
+} cini_stream_state_t;
+
+/**
+ * @brief 解析一行
+ * @param state 解析状态
+ * @param text 行文本 (不含 '\n')
+ * @param length 行长度
+ * @return 继续解析返回 true, 内存不足或回调停止返回 false
+ */
+static inline bool cini_stream_line(cini_stream_state_t *state, const char *text, size_t length);
+
+/**
+ * @brief 解析内存中的若干行, 最后一行可以没有换行符
+ * @param state 解析状态
+ * @param data 内容
+ * @param size 内容长度
+ * @return 继续解析返回 true, 内存不足或回调停止返回 false
+ */
+static inline bool cini_stream_lines(cini_stream_state_t *state, const char *data, size_t size);
+
+/**
+ * @brief 设置当前组
+ * @param state 解析状态
+ * @param name 组名称
+ * @param size 组名称长度
+ * @return 成功返回 true, 内存不足返回 false
+ */
+static inline bool cini_stream_group_set(cini_stream_state_t *state, const char *name, size_t size);
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+bool cini_stream_file(const char *path, const cini_stream_t *stream)
+{
+    if (!path || !stream) {
+        return false;
+    }
+    const int fd = cini_stream_open(path);
+    if (fd < 0) {
+        return false;
+    }
+    cini_stats_add((cini_stats_t *)NULL, files_opened, 1);
+    const bool isok = cini_stream_fd(fd, stream);
+    cini_stream_close(fd);
+    return isok;
+}
+
+bool cini_stream_fd(int fd, const cini_stream_t *stream)
+{
+    if (fd < 0 || !stream) {
+        return false;
+    }
+    size_t capacity = CINI_STREAM_CHUNK;
+    char  *buffer   = (char *)malloc(capacity);
+    if (!buffer) {
+        return false;
+    }
+
+    cini_stream_state_t state = {.stream = stream};
+    size_t              used  = 0;
+    uint64_t            bytes = 0;
+    bool                isok  = true;
+    for (;;) {
+        // 缓冲区中只剩一个不完整的行
+        if (used == capacity) {
+            char *grown = (char *)realloc(buffer, capacity * 2);
+            if (!grown) {
+                isok = false;
+                break;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        const long count = (long)cini_stream_read(fd, buffer + used, capacity - used);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            isok = count == 0;
+            break;
+        }
+        bytes += (uint64_t)count;
+
+        // 只在新读入的部分查找换行符
+        const char *start = buffer;
+        const char *scan  = buffer + used;
+        const char *end   = scan + count;
+        const char *eol   = NULL;
+        while ((eol = (const char *)memchr(scan, '\n', (size_t)(end - scan))) != NULL) {
+            isok  = cini_stream_line(&state, start, (size_t)(eol - start));
+            start = eol + 1;
+            scan  = start;
+            if (!isok) {
+                break;
+            }
+        }
+        if (!isok) {
+            break;
+        }
+        used = (size_t)(end - start);
+        memmove(buffer, start, used);
+    }
+
+    // 最后一行没有换行符
+    if (isok && used > 0) {
+        isok = cini_stream_line(&state, buffer, used);
+    }
+    cini_stats_add((cini_stats_t *)NULL, bytes_read, bytes);
+    cini_stats_add((cini_stats_t *)NULL, lines_scanned, state.lines);
+    free(buffer);
+    free(state.group);
+    return isok;
+}
+
+bool cini_stream_buffer(const char *data, size_t size, const cini_stream_t *stream)
+{
+    if ((!data && size) || !stream) {
+        return false;
+    }
+    cini_stream_state_t state = {.stream = stream};
+    const bool          isok  = cini_stream_lines(&state, data, size);
+    cini_stats_add((cini_stats_t *)NULL, lines_scanned, state.lines);
+    free(state.group);
+    return isok;
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline bool cini_stream_lines(cini_stream_state_t *state, const char *data, size_t size)
+{
+    const char *end = data + size;
+    while (data < end) {
+        const char *eol = (const char *)memchr(data, '\n', (size_t)(end - data));
+        if (!eol) {
+            eol = end;
+        }
+        if (!cini_stream_line(state, data, (size_t)(eol - data))) {
+            return false;
+        }
+        data = eol + 1;
+    }
+    return true;
+}
+
+static inline bool cini_stream_line(cini_stream_state_t *state, const char *text, size_t length)
+{
+    const cini_stream_t *stream = state->stream;
+    ++state->lines;
+    if (length > 0 && text[length - 1] == '\r') {
+        --length;
+    }
+    if (length == 0) {
+        return true;
+    }
+
+    // 组标题, 格式错误的组标题之后的键值对不属于任何组
+    if (text[0] == '[') {
+        state->grouped = false;
+        if (length < 2 || text[length - 1] != ']') {
+            return true;
+        }
+        if (!cini_stream_group_set(state, text + 1, length - 2)) {
+            return false;
+        }
+        if (!stream->on_section) {
+            return true;
+        }
+        const cini_entry_t entry = {.group = state->group, .group_size = state->group_size};
+        return stream->on_section(&entry, stream->arg);
+    }
+
+    size_t index = 0;
+    while (index < length && (text[index] == ' ' || text[index] == '\t')) {
+        ++index;
+    }
+    if (index < length && (text[index] == ';' || text[index] == '#')) {
+        return stream->on_comment ? stream->on_comment(text + index, length - index, stream->arg) : true;
+    }
+
+    // 键以字母或数字开头, 与 '=' 之间只允许空白 (与文档的解析规则一致)
+    if (!stream->on_pair || index != 0) {
+        return true;
+    }
+    if (!((text[0] >= '0' && text[0] <= '9') || (text[0] >= 'a' && text[0] <= 'z') ||
+          (text[0] >= 'A' && text[0] <= 'Z'))) {
+        return true;
+    }
+    const char *equal = (const char *)memchr(text, '=', length);
+    if (!equal) {
+        return true;
+    }
+    const size_t position = (size_t)(equal - text);
+    index                 = 1;
+    while (index < position && text[index] != ' ' && text[index] != '\t') {
+        ++index;
+    }
+    const size_t key_length = index;
+    while (index < position && (text[index] == ' ' || text[index] == '\t')) {
+        ++index;
+    }
+    if (index != position) {
+        return true;
+    }
+    ++index;
+    while (index < length && (text[index] == ' ' || text[index] == '\t')) {
+        ++index;
+    }
+
+    const cini_entry_t entry = {
+        .group      = state->grouped ? state->group : NULL,
+        .group_size = state->grouped ? state->group_size : 0,
+        .key        = text,
+        .key_size   = key_length,
+        .value      = text + index,
+        .value_size = length - index,
+    };
+    return stream->on_pair(&entry, stream->arg);
+}
+
+static inline bool cini_stream_group_set(cini_stream_state_t *state, const char *name, size_t size)
+{
+    if (size + 1 > state->group_capacity) {
+        const size_t capacity = size + 1 > 64 ? size + 1 : 64;
+        char        *group    = (char *)realloc(state->group, capacity);
+        if (!group) {
+            return false;
+        }
+        state->group          = group;
+        state->group_capacity = capacity;
+    }
+    memcpy(state->group, name, size);
+    state->group[size] = '\0';
+    state->group_size  = size;
+    state->grouped     = true;
+    return true;
+}
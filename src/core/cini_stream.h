@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_STREAM_H
+#define _CINI_STREAM_H
+
+#include "cini.h"
+
+/**
+ * @brief 组或键值对回调
+ * 组标题行的 key 与 value 为 NULL; 不属于任何组的键值对 group 为 NULL.
+ * 字符串只在回调期间有效
+ * @param entry 条目
+ * @param arg 用户参数
+ * @return bool 继续解析返回true，停止解析返回false
+ */
+typedef bool (*cini_stream_func_t)(const cini_entry_t *entry, void *arg);
+
+/**
+ * @brief 注释回调
+ * @param text 注释行 (含 ';' 或 '#', 不含行结束符), 只在回调期间有效
+ * @param size 注释行长度
+ * @param arg 用户参数
+ * @return bool 继续解析返回true，停止解析返回false
+ */
+typedef bool (*cini_comment_func_t)(const char *text, size_t size, void *arg);
+
+/**
+ * @brief 流式解析回调, 不需要的回调可为 NULL
+ * 与文档不同, 同名组与同名键不去重, 按出现顺序逐个报告
+ */
+typedef struct cini_stream {
+    cini_stream_func_t  on_section;  // 组标题
+    cini_stream_func_t  on_pair;     // 键值对
+    cini_comment_func_t on_comment;  // 注释
+    void               *arg;         // 用户参数
+} cini_stream_t;
+
+/**
+ * @brief 流式解析文件
+ * 单次顺序读取, 内存占用只与最长的行有关, 与文件大小无关, 行长度不受限制
+ * @param path 文件路径
+ * @param stream 回调
+ * @return bool 解析完整个文件返回true，读取失败、内存不足或回调停止返回false
+ */
+CINI_EXPORT bool cini_stream_file(const char *path, const cini_stream_t *stream);
+
+/**
+ * @brief 流式解析文件描述符 (可为管道或套接字), 读取到文件结束为止
+ * @param fd 文件描述符, 不会被关闭
+ * @param stream 回调
+ * @return bool 解析到文件结束返回true，读取失败、内存不足或回调停止返回false
+ */
+CINI_EXPORT bool cini_stream_fd(int fd, const cini_stream_t *stream);
+
+/**
+ * @brief 流式解析内存中的内容, 不复制
+ * @param data 内容
+ * @param size 内容长度
+ * @param stream 回调
+ * @return bool 解析完全部内容返回true，内存不足或回调停止返回false
+ */
+CINI_EXPORT bool cini_stream_buffer(const char *data, size_t size, const cini_stream_t *stream);
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include "cini_task.h"
+
+#if defined(__C_PLATFORM_LINUX) || defined(__C_PLATFORM_MAC)
+#include <pthread.h>
+#define CINI_USE_TASK
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#ifdef CINI_USE_TASK
+
+#define CINI_TASK_THREADS 63  // 常驻线程的最大数量 (与并行解析的最大分块数相同, 当前线程执行一块)
+
+// 共享线程池
+typedef struct cini_task_pool {
+    pthread_mutex_t mutex;     // 保护任务队列与线程数
+    pthread_cond_t  ready;     // 队列中有新任务
+    pthread_cond_t  done;      // 有任务完成
+    cini_task_t    *head;      // 队列中的第一个任务
+    cini_task_t    *tail;      // 队列中的最后一个任务
+    unsigned        threads;   // 已创建的常驻线程数
+    bool            forkable;  // 是否已注册 fork 处理函数 (未注册时不创建线程)
+} cini_task_pool_t;
+
+// 进程内共享的线程池
+static cini_task_pool_t cini_task_pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0, false,
+};
+
+/**
+ * @brief 取出队列中的第一个任务 (调用者持有锁)
+ * @return 任务, 队列为空时返回 NULL
+ */
+static inline cini_task_t *cini_task_pop(void);
+
+/**
+ * @brief 执行任务并更新所属批次 (调用者持有锁, 执行期间释放)
+ * @param task 任务
+ */
+static inline void cini_task_execute(cini_task_t *task);
+
+/**
+ * @brief 常驻线程入口, 等待并执行队列中的任务
+ * @param arg 未使用
+ * @return 不返回
+ */
+static void *cini_task_main(void *arg);
+
+/**
+ * @brief fork 前加锁, 子进程中不会留下其他线程持有的锁
+ */
+static void cini_task_prepare(void);
+
+/**
+ * @brief fork 后在父进程中解锁
+ */
+static void cini_task_parent(void);
+
+/**
+ * @brief fork 后在子进程中清空线程池 (常驻线程不会被复制), 之后按需重新创建
+ */
+static void cini_task_child(void);
+
+#endif
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+void cini_task_run(cini_task_t *tasks, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+#ifdef CINI_USE_TASK
+    cini_task_pool_t *pool    = &cini_task_pool;
+    size_t            pending = count - 1;
+
+    pthread_mutex_lock(&pool->mutex);
+    if (!pool->forkable) {
+        pool->forkable = pthread_atfork(cini_task_prepare, cini_task_parent, cini_task_child) == 0;
+    }
+    // 按需补足常驻线程, 创建失败时由当前线程执行剩余任务
+    while (pool->forkable && pool->threads < count - 1 && pool->threads < CINI_TASK_THREADS) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, cini_task_main, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        pool->threads++;
+    }
+    for (size_t index = 1; index < count; ++index) {
+        tasks[index].next    = NULL;
+        tasks[index].pending = &pending;
+        if (pool->tail) {
+            pool->tail->next = &tasks[index];
+        } else {
+            pool->head = &tasks[index];
+        }
+        pool->tail = &tasks[index];
+    }
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    tasks[0].func(tasks[0].arg);
+
+    // 等待期间执行队列中的任务 (可能属于其他批次), 常驻线程不足时也能完成
+    pthread_mutex_lock(&pool->mutex);
+    while (pending > 0) {
+        cini_task_t *task = cini_task_pop();
+        if (task) {
+            cini_task_execute(task);
+        } else {
+            pthread_cond_wait(&pool->done, &pool->mutex);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+#else
+    for (size_t index = 0; index < count; ++index) {
+        tasks[index].func(tasks[index].arg);
+    }
+#endif
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+#ifdef CINI_USE_TASK
+
+static inline cini_task_t *cini_task_pop(void)
+{
+    cini_task_pool_t *pool = &cini_task_pool;
+    cini_task_t      *task = pool->head;
+    if (task) {
+        pool->head = task->next;
+        if (!pool->head) {
+            pool->tail = NULL;
+        }
+    }
+    return task;
+}
+
+static inline void cini_task_execute(cini_task_t *task)
+{
+    cini_task_pool_t *pool = &cini_task_pool;
+    pthread_mutex_unlock(&pool->mutex);
+    task->func(task->arg);
+    pthread_mutex_lock(&pool->mutex);
+
+    // 批次完成后任务可能随调用者的栈失效, 之后不再访问
+    if (--*task->pending == 0) {
+        pthread_cond_broadcast(&pool->done);
+    }
+}
+
+static void *cini_task_main(void *arg)
+{
+    (void)arg;
+    cini_task_pool_t *pool = &cini_task_pool;
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        cini_task_t *task = cini_task_pop();
+        if (task) {
+            cini_task_execute(task);
+        } else {
+            pthread_cond_wait(&pool->ready, &pool->mutex);
+        }
+    }
+    return NULL;
+}
+
+static void cini_task_prepare(void)
+{
+    pthread_mutex_lock(&cini_task_pool.mutex);
+}
+
+static void cini_task_parent(void)
+{
+    pthread_mutex_unlock(&cini_task_pool.mutex);
+}
+
+static void cini_task_child(void)
+{
+    cini_task_pool_t *pool = &cini_task_pool;
+    pool->head             = NULL;
+    pool->tail             = NULL;
+    pool->threads          = 0;
+    pthread_cond_init(&pool->ready, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+#endif
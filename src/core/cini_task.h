@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_TASK_H
+#define _CINI_TASK_H
+
+#include "cini.h"
+
+// 库内部使用: 并行解析等短任务共享的线程池
+
+// 线程池任务
+typedef struct cini_task {
+    struct cini_task *next;     // 队列中的下一个任务
+    void (*func)(void *arg);    // 任务函数
+    void             *arg;      // 任务参数
+    size_t           *pending;  // 所属批次未完成的任务数
+} cini_task_t;
+
+/**
+ * @brief 并行执行一批任务, 全部完成后返回
+ * 第一个任务由当前线程执行, 其余任务交给进程内共享的常驻线程 (按需创建, 之后的调用复用, 不随调用创建与退出);
+ * 等待期间当前线程也执行队列中的任务, 线程无法创建时全部由当前线程执行. 不支持线程的平台上依次执行
+ * @param tasks 任务, 只需设置 func 与 arg
+ * @param count 任务数
+ */
+void cini_task_run(cini_task_t *tasks, size_t count);
+
+#endif
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "cini_watch.h"
+
+#ifdef __C_PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define CINI_USE_INOTIFY
+#endif
+
+// -------------------------[STATIC DECLARATION]-------------------------
+
+#ifdef CINI_USE_INOTIFY
+
+#define CINI_WATCH_BUFFER 4096  // 每次读取 inotify 事件的缓冲区大小
+#define CINI_WATCH_MASK   (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)
+
+typedef struct cini_listener cini_listener_t;
+
+// 键值变化回调
+struct cini_listener {
+    cini_listener_t  *next;   // 下一个回调
+    char             *group;  // 组名称, NULL 表示所有组
+    char             *key;    // 键名称, NULL 表示组内所有键
+    cini_watch_func_t func;   // 回调函数
+    void             *arg;    // 用户参数
+};
+
+// 文件监视器
+struct cini_watch {
+    char            *path;       // 文件路径
+    const char      *name;       // 文件名 (指向 path 内部)
+    cini_doc_t      *doc;        // 最近一次解析的文档
+    cini_listener_t *listeners;  // 回调链表
+    char            *buffer;     // 回调参数缓冲区
+    size_t           capacity;   // 回调参数缓冲区大小
+    int              fd;         // inotify 文件描述符
+    int              wakeup[2];  // 用于唤醒后台线程的管道
+    pthread_t        thread;     // 后台线程
+    pthread_mutex_t  mutex;      // 保护回调链表与文档
+    bool             running;    // 后台线程是否运行
+};
+
+/**
+ * @brief 等待目标文件的 inotify 事件
+ * @param watch 监视器
+ * @param timeout 超时时间 (毫秒), 负数表示一直等待
+ * @return 收到目标文件的事件返回 true, 超时或被唤醒返回 false
+ */
+static inline bool cini_watch_wait(cini_watch_t *watch, int timeout);
+
+/**
+ * @brief 重新解析文件, 对变化的键分发回调
+ * @param watch 监视器
+ * @return 文件内容变化返回 true, 否则返回 false
+ */
+static inline bool cini_watch_reload(cini_watch_t *watch);
+
+/**
+ * @brief 将一项键值变化分发给匹配的回调
+ * @param change 键值变化
+ * @param arg 监视器
+ */
+static void cini_watch_dispatch(const cini_change_t *change, void *arg);
+
+/**
+ * @brief 后台线程入口
+ * @param arg 监视器
+ * @return NULL
+ */
+static void *cini_watch_main(void *arg);
+
+/**
+ * @brief 复制字符串
+ * @param data 字符串 (可为 NULL)
+ * @param length 字符串长度
+ * @param copy 存储副本 (data 为 NULL 时存储 NULL)
+ * @return 成功返回 true, 否则返回 false
+ */
+static inline bool cini_watch_strdup(const char *data, size_t length, char **copy);
+
+#endif
+
+// -------------------------[GLOBAL DEFINITION]-------------------------
+
+#ifdef CINI_USE_INOTIFY
+
+cini_watch_t *cini_watch_create(cini_t *self)
+{
+    if (!self || !self->path || !self->path[0]) {
+        return NULL;
+    }
+    cini_watch_t *watch = (cini_watch_t *)calloc(1, sizeof(cini_watch_t));
+    if (!watch) {
+        return NULL;
+    }
+    watch->fd        = -1;
+    watch->wakeup[0] = -1;
+    watch->wakeup[1] = -1;
+    if (pthread_mutex_init(&watch->mutex, NULL) != 0) {
+        free(watch);
+        return NULL;
+    }
+
+    // 监视所在目录, 以便感知先写临时文件再重命名的替换方式
+    const size_t length = strlen(self->path);
+    char        *dir    = NULL;
+    bool         isok   = cini_watch_strdup(self->path, length, &watch->path) &&
+                 cini_watch_strdup(self->path, length, &dir);
+    if (isok) {
+        char *slash = strrchr(dir, '/');
+        if (!slash) {
+            dir[0] = '.';
+            dir[1] = '\0';
+        } else {
+            slash[slash == dir ? 1 : 0] = '\0';
+        }
+        const char *name = strrchr(watch->path, '/');
+        watch->name      = name ? name + 1 : watch->path;
+
+        watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        isok      = watch->fd >= 0 && inotify_add_watch(watch->fd, dir, CINI_WATCH_MASK) >= 0;
+    }
+    if (isok && pipe(watch->wakeup) == 0) {
+        for (int index = 0; index < 2; ++index) {
+            fcntl(watch->wakeup[index], F_SETFL, O_NONBLOCK);
+            fcntl(watch->wakeup[index], F_SETFD, FD_CLOEXEC);
+        }
+    } else {
+        watch->wakeup[0] = -1;
+        isok             = false;
+    }
+    free(dir);
+
+    if (isok) {
+        watch->doc = cini_doc_load(watch->path);
+        if (!watch->doc) {
+            watch->doc = cini_doc_create();
+        }
+        isok = cini_doc_detach(watch->doc);
+    }
+    if (!isok) {
+        cini_watch_free(watch);
+        return NULL;
+    }
+    return watch;
+}
+
+void cini_watch_free(cini_watch_t *watch)
+{
+    if (!watch) {
+        return;
+    }
+    cini_watch_stop(watch);
+    while (watch->listeners) {
+        cini_listener_t *next = watch->listeners->next;
+        free(watch->listeners->group);
+        free(watch->listeners->key);
+        free(watch->listeners);
+        watch->listeners = next;
+    }
+    if (watch->fd >= 0) {
+        close(watch->fd);
+    }
+    if (watch->wakeup[0] >= 0) {
+        close(watch->wakeup[0]);
+        close(watch->wakeup[1]);
+    }
+    pthread_mutex_destroy(&watch->mutex);
+    cini_doc_free(watch->doc);
+    free(watch->buffer);
+    free(watch->path);
+    free(watch);
+}
+
+bool cini_watch_add(cini_watch_t *watch, const char *group, const char *key, cini_watch_func_t func, void *arg)
+{
+    if (!watch || !func) {
+        return false;
+    }
+    cini_listener_t *listener = (cini_listener_t *)calloc(1, sizeof(cini_listener_t));
+    if (!listener) {
+        return false;
+    }
+    if (!cini_watch_strdup(group, group ? strlen(group) : 0, &listener->group) ||
+        !cini_watch_strdup(key, key ? strlen(key) : 0, &listener->key)) {
+        free(listener->group);
+        free(listener);
+        return false;
+    }
+    listener->func = func;
+    listener->arg  = arg;
+
+    // 按注册顺序调用
+    pthread_mutex_lock(&watch->mutex);
+    cini_listener_t **tail = &watch->listeners;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    *tail = listener;
+    pthread_mutex_unlock(&watch->mutex);
+    return true;
+}
+
+bool cini_watch_poll(cini_watch_t *watch, int timeout)
+{
+    if (!watch || !cini_watch_wait(watch, timeout)) {
+        return false;
+    }
+    return cini_watch_reload(watch);
+}
+
+bool cini_watch_start(cini_watch_t *watch)
+{
+    if (!watch || __atomic_load_n(&watch->running, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    __atomic_store_n(&watch->running, true, __ATOMIC_RELEASE);
+    if (pthread_create(&watch->thread, NULL, cini_watch_main, watch) != 0) {
+        __atomic_store_n(&watch->running, false, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+void cini_watch_stop(cini_watch_t *watch)
+{
+    if (!watch || !__atomic_load_n(&watch->running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_store_n(&watch->running, false, __ATOMIC_RELEASE);
+    const char byte = 0;
+    while (write(watch->wakeup[1], &byte, 1) < 0 && errno == EINTR) {
+    }
+    pthread_join(watch->thread, NULL);
+}
+
+#else
+
+cini_watch_t *cini_watch_create(cini_t *self)
+{
+    (void)self;
+    return NULL;
+}
+
+void cini_watch_free(cini_watch_t *watch)
+{
+    (void)watch;
+}
+
+bool cini_watch_add(cini_watch_t *watch, const char *group, const char *key, cini_watch_func_t func, void *arg)
+{
+    (void)watch;
+    (void)group;
+    (void)key;
+    (void)func;
+    (void)arg;
+    return false;
+}
+
+bool cini_watch_poll(cini_watch_t *watch, int timeout)
+{
+    (void)watch;
+    (void)timeout;
+    return false;
+}
+
+bool cini_watch_start(cini_watch_t *watch)
+{
+    (void)watch;
+    return false;
+}
+
+void cini_watch_stop(cini_watch_t *watch)
+{
+    (void)watch;
+}
+
+#endif
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+#ifdef CINI_USE_INOTIFY
+
+static inline bool cini_watch_wait(cini_watch_t *watch, int timeout)
+{
+    struct pollfd fds[2] = {
+        {.fd = watch->fd, .events = POLLIN},
+        {.fd = watch->wakeup[0], .events = POLLIN},
+    };
+    if (poll(fds, 2, timeout) <= 0) {
+        return false;
+    }
+
+    char buffer[CINI_WATCH_BUFFER] __attribute__((aligned(__alignof__(struct inotify_event))));
+    if (fds[1].revents & POLLIN) {
+        while (read(watch->wakeup[0], buffer, sizeof(buffer)) > 0) {
+        }
+        return false;
+    }
+
+    // 读出所有事件, 只关心目标文件
+    bool found = false;
+    for (;;) {
+        const ssize_t length = read(watch->fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (const char *current = buffer; current < buffer + length;) {
+            const struct inotify_event *event = (const struct inotify_event *)(const void *)current;
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len && strcmp(event->name, watch->name) == 0)) {
+                found = true;
+            }
+            current += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return found;
+}
+
+static inline bool cini_watch_reload(cini_watch_t *watch)
+{
+    pthread_mutex_lock(&watch->mutex);
+
+    // 内容未变化 (如重写了相同内容) 时不重新解析
+    if (!cini_doc_changed(watch->doc, watch->path, true)) {
+        pthread_mutex_unlock(&watch->mutex);
+        return false;
+    }
+    cini_doc_t *doc = cini_doc_load(watch->path);
+    if (!doc) {
+        doc = cini_doc_create();
+    }
+    if (!cini_doc_detach(doc)) {
+        cini_doc_free(doc);
+        pthread_mutex_unlock(&watch->mutex);
+        return false;
+    }
+    cini_doc_diff(watch->doc, doc, cini_watch_dispatch, watch);
+    cini_doc_free(watch->doc);
+    watch->doc = doc;
+
+    pthread_mutex_unlock(&watch->mutex);
+    return true;
+}
+
+static void cini_watch_dispatch(const cini_change_t *change, void *arg)
+{
+    cini_watch_t *watch = (cini_watch_t *)arg;
+
+    // 将组、键与值复制为以'\0'结尾的字符串
+    const size_t size = change->group_size + change->key_size + change->old_size + change->new_size + 4;
+    if (size > watch->capacity) {
+        char *buffer = (char *)realloc(watch->buffer, size);
+        if (!buffer) {
+            return;
+        }
+        watch->buffer   = buffer;
+        watch->capacity = size;
+    }
+    char *group     = watch->buffer;
+    char *key       = group + change->group_size + 1;
+    char *old_value = key + change->key_size + 1;
+    char *new_value = old_value + change->old_size + 1;
+    memcpy(group, change->group, change->group_size);
+    memcpy(key, change->key, change->key_size);
+    if (change->old_value) {
+        memcpy(old_value, change->old_value, change->old_size);
+    }
+    if (change->new_value) {
+        memcpy(new_value, change->new_value, change->new_size);
+    }
+    group[change->group_size]   = '\0';
+    key[change->key_size]       = '\0';
+    old_value[change->old_size] = '\0';
+    new_value[change->new_size] = '\0';
+
+    for (const cini_listener_t *listener = watch->listeners; listener; listener = listener->next) {
+        if ((listener->group && strcmp(listener->group, group) != 0) ||
+            (listener->key && strcmp(listener->key, key) != 0)) {
+            continue;
+        }
+        listener->func(group, key, change->old_value ? old_value : NULL, change->new_value ? new_value : NULL,
+                       listener->arg);
+    }
+}
+
+static void *cini_watch_main(void *arg)
+{
+    cini_watch_t *watch = (cini_watch_t *)arg;
+    while (__atomic_load_n(&watch->running, __ATOMIC_ACQUIRE)) {
+        if (cini_watch_wait(watch, -1)) {
+            cini_watch_reload(watch);
+        }
+    }
+    return NULL;
+}
+
+static inline bool cini_watch_strdup(const char *data, size_t length, char **copy)
+{
+    *copy = NULL;
+    if (!data) {
+        return true;
+    }
+    *copy = (char *)malloc(length + 1);
+    if (!*copy) {
+        return false;
+    }
+    memcpy(*copy, data, length);
+    (*copy)[length] = '\0';
+    return true;
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2023 Tayne
+ *
+ * This file is part of cini.
+ *
+ * cini is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cini is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cini.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CINI_WATCH_H
+#define _CINI_WATCH_H
+
+#include "cini.h"
+
+// 文件监视器
+typedef struct cini_watch cini_watch_t;
+
+/**
+ * @brief 键值变化回调
+ * @param group 组名称
+ * @param key 键名称
+ * @param old_value 原值, 键新增时为 NULL
+ * @param new_value 新值, 键移除时为 NULL
+ * @param arg 用户参数
+ */
+typedef void (*cini_watch_func_t)(const char *group, const char *key, const char *old_value, const char *new_value,
+                                  void *arg);
+
+/**
+ * @brief 创建文件监视器 (仅支持 Linux, 基于 inotify)
+ * 监视 cini_t.path 所在目录, 文件被写入、替换或删除时重新解析,
+ * 并只对值发生变化的键调用回调
+ * @param self cini指针
+ * @return cini_watch_t* 成功返回监视器, 不支持的平台或失败返回 NULL
+ */
+CINI_EXPORT cini_watch_t *cini_watch_create(cini_t *self);
+
+/**
+ * @brief 释放文件监视器 (后台线程运行时先停止)
+ * @param watch 监视器
+ */
+CINI_EXPORT void cini_watch_free(cini_watch_t *watch);
+
+/**
+ * @brief 注册键值变化回调
+ * 回调在调用 cini_watch_poll 的线程或后台线程中执行, 回调中不可再调用本监视器的接口
+ * @param watch 监视器
+ * @param group 组名称 (NULL 表示所有组)
+ * @param key 键名称 (NULL 表示组内所有键)
+ * @param func 回调函数
+ * @param arg 用户参数
+ * @return bool 成功返回true，失败返回false
+ */
+CINI_EXPORT bool cini_watch_add(cini_watch_t *watch, const char *group, const char *key, cini_watch_func_t func,
+                                void *arg);
+
+/**
+ * @brief 等待文件变化并分发回调 (用于自行驱动的事件循环, 不可与后台线程同时使用)
+ * @param watch 监视器
+ * @param timeout 超时时间 (毫秒), 负数表示一直等待
+ * @return bool 文件内容变化并已重新解析返回true，否则返回false
+ */
+CINI_EXPORT bool cini_watch_poll(cini_watch_t *watch, int timeout);
+
+/**
+ * @brief 启动后台线程, 在后台重新解析并分发回调
+ * @param watch 监视器
+ * @return bool 成功返回true，已启动或创建线程失败返回false
+ */
+CINI_EXPORT bool cini_watch_start(cini_watch_t *watch);
+
+/**
+ * @brief 停止后台线程
+ * @param watch 监视器
+ */
+CINI_EXPORT void cini_watch_stop(cini_watch_t *watch);
+
+#endif
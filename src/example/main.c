@@ -17,6 +17,7 @@
  * along with cini.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "core/cini.h"
+#include "core/cini_image.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -100,6 +101,25 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (strcmp(argv[1], "compile") == 0) {
+        if (argc < 5 || strcmp(argv[3], "-o") != 0) {
+            printf("Invalid number of arguments for 'compile' command. Use 'help' command for instructions.\n");
+            return 1;
+        }
+        cini_doc_t *doc = cini_doc_load(argv[2]);
+        if (!doc) {
+            printf("Failed to load ini file '%s'.\n", argv[2]);
+            return 1;
+        }
+        const bool isok = cini_image_publish(doc, argv[4]);
+        cini_doc_free(doc);
+        if (!isok) {
+            printf("Failed to write image file '%s'.\n", argv[4]);
+            return 1;
+        }
+        return 0;
+    }
+
     printf("Invalid command. Use 'help' command for instructions.\n");
     return 1;
 }
@@ -118,6 +138,7 @@ static inline void print_command_instructions(void)
     printf("  set [path] [group] [key] [value]: Set the value of key 'key' in group 'group' of ini file 'path' to "
            "'value'.\n");
     printf("  rm [path] [group] [key]: Remove the key 'key' in group 'group' of ini file 'path'.\n");
+    printf("  compile [path] -o [output]: Compile ini file 'path' into the binary image 'output'.\n");
 }
 
 static inline void print_project_version(void)
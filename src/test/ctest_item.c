@@ -17,11 +17,135 @@
  * along with cini.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "ctest_item.h"
+#include <pthread.h>
+#include <stdlib.h>
 #include "core/cini.h"
+#include "core/cini_arena.h"
+#include "core/cini_image.h"
+#include "core/cini_io.h"
+#include "core/cini_scan.h"
+#include "core/cini_snap.h"
+#include "core/cini_stream.h"
+#include "core/cini_watch.h"
+
+#ifdef __C_PLATFORM_LINUX
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // -------------------------[STATIC DECLARATION]-------------------------
 
-#define CINI_TEST_FILE "test.ini"
+#define CINI_TEST_FILE  "test.ini"
+#define CINI_TEST_IMAGE "test.cinib"
+
+/**
+ * @brief 写入测试文件
+ * @param path 文件路径
+ * @param content 文件内容
+ */
+static inline void ctest_file_write(const char *path, const char *content);
+
+/**
+ * @brief 读取测试文件
+ * @param path 文件路径
+ * @param buffer 存储内容的缓冲区
+ * @param max 缓冲区大小
+ */
+static inline void ctest_file_read(const char *path, char *buffer, size_t max);
+
+// 监视回调记录
+typedef struct ctest_watch_record {
+    int  count;      // 回调次数
+    char last[256];  // 最近一次变化 "group.key:old->new"
+} ctest_watch_record_t;
+
+/**
+ * @brief 记录键值变化 (监视回调)
+ * @param group 组名称
+ * @param key 键名称
+ * @param old_value 原值
+ * @param new_value 新值
+ * @param arg 回调记录
+ */
+static void ctest_watch_func(const char *group, const char *key, const char *old_value, const char *new_value,
+                             void *arg);
+
+/**
+ * @brief 统计键值变化 (文档比较回调)
+ * @param change 键值变化
+ * @param arg 计数
+ */
+static void ctest_diff_count(const cini_change_t *change, void *arg);
+
+/**
+ * @brief 快照读取线程: 反复读取并检查同一快照中的两个键是否一致
+ * @param arg 快照发布者
+ * @return 不一致返回非 NULL
+ */
+static void *ctest_snap_reader(void *arg);
+
+// 流式解析记录
+typedef struct ctest_stream_record {
+    int    sections;    // 组数
+    int    pairs;       // 键值对数
+    int    comments;    // 注释数
+    int    stop;        // 解析到第几个键值对时停止, 0 表示不停止
+    size_t value_size;  // 最长的值长度
+    char   last[256];   // 最近一个键值对 "group.key=value"
+} ctest_stream_record_t;
+
+/**
+ * @brief 记录组与键值对 (流式解析回调)
+ * @param entry 条目
+ * @param arg 解析记录
+ * @return 是否继续解析
+ */
+static bool ctest_stream_entry(const cini_entry_t *entry, void *arg);
+
+/**
+ * @brief 记录注释 (流式解析回调)
+ * @param text 注释行
+ * @param size 注释行长度
+ * @param arg 解析记录
+ * @return 是否继续解析
+ */
+static bool ctest_stream_comment(const char *text, size_t size, void *arg);
+
+// 分配器调用计数
+typedef struct ctest_alloc_count {
+    size_t allocs;  // 分配次数
+    size_t frees;   // 释放次数
+} ctest_alloc_count_t;
+
+/**
+ * @brief 分配内存并计数 (分配器回调)
+ * @param arg 调用计数
+ * @param size 大小
+ * @return 内存
+ */
+static void *ctest_alloc(void *arg, size_t size);
+
+/**
+ * @brief 释放内存并计数 (分配器回调)
+ * @param arg 调用计数
+ * @param ptr 内存
+ */
+static void ctest_free(void *arg, void *ptr);
+
+#ifdef __C_PLATFORM_LINUX
+/**
+ * @brief 判断进程中是否映射了指定文件 (读取 /proc/self/maps)
+ * @param name 文件名
+ * @return 已映射返回 true
+ */
+static bool ctest_file_mapped(const char *name);
+
+/**
+ * @brief 获取进程的线程数 (读取 /proc/self/status)
+ * @return 线程数, 无法读取时返回 0
+ */
+static int ctest_thread_count(void);
+#endif
 
 // -------------------------[GLOBAL DEFINITION]-------------------------
 
@@ -68,10 +192,1629 @@ int ctest_func_cini(int argc, char **argv)
         cini_group_end(&cini);
         ctest_assert_string(cini_group_get(&cini), STR_NULL);
     }
+
+    // 组内存在多个同名键时全部修改与移除
+    ctest_file_write(CINI_TEST_FILE, "[g]\nk=1\nk=2\n");
+    cini_group_begin(&cini, "g");
+    cini_value_set(&cini, "k", "9");
+    ctest_file_read(CINI_TEST_FILE, result, sizeof(result));
+    ctest_assert_string(result, "[g]\nk=9\nk=9\n");
+    cini_value_remove(&cini, "k");
+    ctest_assert_bool(!cini_value_contains(&cini, "k"));
+    ctest_file_read(CINI_TEST_FILE, result, sizeof(result));
+    ctest_assert_string(result, "[g]\n");
+    cini_group_end(&cini);
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_doc(int argc, char **argv)
+{
+    ctest_file_write(CINI_TEST_FILE,
+                     "; comment\r\n[net]\r\nhost = localhost\r\nport=80\r\n\r\n[net]\r\nport=81\r\n[log]\r\nlevel=1");
+
+    cini_doc_t *doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+
+    char   result[256] = {0};
+    size_t start       = 0;
+    size_t end         = 0;
+
+    // 读取
+    ctest_assert_bool(cini_doc_value_get(doc, "net", "host", "default", result, sizeof(result)));
+    ctest_assert_string(result, "localhost");
+    ctest_assert_bool(cini_doc_value_get(doc, "net", "port", "default", result, sizeof(result)));
+    ctest_assert_string(result, "80");
+    ctest_assert_bool(!cini_doc_value_get(doc, "net", "user", "default", result, sizeof(result)));
+    ctest_assert_string(result, "default");
+    ctest_assert_bool(cini_doc_value_get(doc, "net", "host", "default", result, 5));
+    ctest_assert_string(result, "loca");
+    ctest_assert_bool(cini_doc_group_find(doc, "net", &start, &end));
+    ctest_assert_bool(start == 2 && end == 4);
+    ctest_assert_bool(cini_doc_group_find(doc, "log", &start, &end));
+    ctest_assert_bool(start == 8 && end == 9);
+
+    // 修改
+    ctest_assert_bool(cini_doc_value_set(doc, "net", "user", "root"));
+    ctest_assert_bool(cini_doc_value_set(doc, "log", "level", "2"));
+    ctest_assert_bool(cini_doc_value_set(doc, "new", "key", "value"));
+    ctest_assert_bool(cini_doc_value_remove(doc, "net", "port"));
+    ctest_assert_bool(!cini_doc_value_remove(doc, "net", "port"));
+    ctest_assert_bool(cini_doc_group_find(doc, "log", &start, &end));
+    ctest_assert_bool(start == 8 && end == 9);
+    ctest_assert_bool(cini_doc_group_find(doc, "new", &start, &end));
+    ctest_assert_bool(start == 11 && end == 12);
+    ctest_assert_bool(cini_doc_save(doc, CINI_TEST_FILE));
+    cini_doc_free(doc);
+
+    // 未修改的行保持原样
+    ctest_file_read(CINI_TEST_FILE, result, sizeof(result));
+    ctest_assert_string(result,
+                        "; comment\r\n[net]\r\nhost = localhost\r\nuser=root" STR_NEWLINE
+                        "\r\n[net]\r\nport=81\r\n[log]\r\nlevel=2" STR_NEWLINE STR_NEWLINE "[new]" STR_NEWLINE
+                        "key=value" STR_NEWLINE);
+
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    ctest_assert_bool(!cini_doc_value_contains(doc, "net", "port"));
+    ctest_assert_bool(cini_doc_value_contains(doc, "net", "user"));
+    ctest_assert_bool(cini_doc_value_contains(doc, "new", "key"));
+    cini_doc_free(doc);
+
+    // 同组重复键: 仅第一个生效, 修改与移除时组内的同名键全部修改与移除 (之后的同名组不受影响)
+    ctest_file_write(CINI_TEST_FILE, "[dup]\na=1\na=2\n[dup]\na=3\n");
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    cini_doc_value_get(doc, "dup", "a", "default", result, sizeof(result));
+    ctest_assert_string(result, "1");
+    ctest_assert_bool(cini_doc_value_set(doc, "dup", "a", "9"));
+    ctest_assert_bool(cini_doc_save(doc, CINI_TEST_FILE));
+    ctest_file_read(CINI_TEST_FILE, result, sizeof(result));
+    ctest_assert_string(result, "[dup]\na=9\na=9\n[dup]\na=3\n");
+    ctest_assert_bool(cini_doc_value_remove(doc, "dup", "a"));
+    ctest_assert_bool(!cini_doc_value_contains(doc, "dup", "a"));
+    ctest_assert_bool(cini_doc_save(doc, CINI_TEST_FILE));
+    ctest_file_read(CINI_TEST_FILE, result, sizeof(result));
+    ctest_assert_string(result, "[dup]\n[dup]\na=3\n");
+
+    // 大组
+    char key[32]   = {0};
+    char value[32] = {0};
+    int  index     = 0;
+    for (index = 0; index < 5000; ++index) {
+        snprintf(key, sizeof(key), "key_%d", index);
+        snprintf(value, sizeof(value), "value_%d", index);
+        ctest_assert_bool(cini_doc_value_set(doc, "big", key, value));
+    }
+    for (index = 0; index < 5000; index += 2) {
+        snprintf(key, sizeof(key), "key_%d", index);
+        ctest_assert_bool(cini_doc_value_remove(doc, "big", key));
+    }
+    for (index = 0; index < 5000; ++index) {
+        snprintf(key, sizeof(key), "key_%d", index);
+        snprintf(value, sizeof(value), "value_%d", index);
+        ctest_assert_bool(cini_doc_value_contains(doc, "big", key) == (index % 2 == 1));
+        if (index % 2 == 1) {
+            cini_doc_value_get(doc, "big", key, "default", result, sizeof(result));
+            ctest_assert_string(result, value);
+        }
+    }
+    ctest_assert_bool(cini_doc_group_find(doc, "big", &start, &end));
+    ctest_assert_bool(start == 5 && end == 2505);
+    cini_doc_free(doc);
+
+    // 空文件
+    ctest_file_write(CINI_TEST_FILE, "");
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    ctest_assert_bool(!cini_doc_group_find(doc, "big", NULL, NULL));
+    cini_doc_free(doc);
+
+#if defined(__C_PLATFORM_LINUX) || defined(__C_PLATFORM_MAC)
+    // 无法映射的文件
+    doc = cini_doc_load("/dev/null");
+    ctest_assert_bool(doc != NULL);
+    cini_doc_free(doc);
+#endif
+
+    remove(CINI_TEST_FILE);
+    ctest_assert_bool(cini_doc_load(CINI_TEST_FILE) == NULL);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_txn(int argc, char **argv)
+{
+    cini_t cini        = CINI_INITIALIZATION;
+    char   key[32]     = {0};
+    char   value[32]   = {0};
+    char   result[256] = {0};
+    int    index       = 0;
+
+    remove(CINI_TEST_FILE);
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_group_begin(&cini, "txn");
+
+    // 提交前不写文件, 事务内可读到未提交的修改
+    ctest_assert_bool(cini_txn_begin(&cini));
+    ctest_assert_bool(!cini_txn_begin(&cini));
+    for (index = 0; index < 300; ++index) {
+        snprintf(key, sizeof(key), "key_%d", index);
+        snprintf(value, sizeof(value), "value_%d", index);
+        cini_value_set(&cini, key, value);
+    }
+    cini_value_remove(&cini, "key_0");
+    ctest_assert_bool(!cini_value_contains(&cini, "key_0"));
+    cini_value_get(&cini, "key_299", "default", result, sizeof(result));
+    ctest_assert_string(result, "value_299");
+    ctest_assert_bool(cini_doc_load(CINI_TEST_FILE) == NULL);
+    ctest_assert_bool(cini_txn_commit(&cini));
+    ctest_assert_bool(!cini_txn_commit(&cini));
+
+    cini_t other = CINI_INITIALIZATION;
+    cini_path_set(&other, CINI_TEST_FILE);
+    cini_group_begin(&other, "txn");
+    cini_value_get(&other, "key_150", "default", result, sizeof(result));
+    ctest_assert_string(result, "value_150");
+    ctest_assert_bool(!cini_value_contains(&other, "key_0"));
+
+    // 放弃事务
+    ctest_assert_bool(cini_txn_begin(&cini));
+    cini_value_set(&cini, "key_1", "changed");
+    cini_value_set(&cini, "extra", "1");
+    cini_txn_abort(&cini);
+    cini_value_get(&cini, "key_1", "default", result, sizeof(result));
+    ctest_assert_string(result, "value_1");
+    ctest_assert_bool(!cini_value_contains(&cini, "extra"));
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_cache(int argc, char **argv)
+{
+    cini_t      cini        = CINI_INITIALIZATION;
+    char        result[256] = {0};
+    const char *view        = NULL;
+    size_t      size        = 0;
+
+    // 未开启缓存时无法返回文档中的值
+    ctest_file_write(CINI_TEST_FILE, "[cache]\nname=first\n");
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_group_begin(&cini, "cache");
+    ctest_assert_bool(!cini_value_view(&cini, "name", &view, &size) && view == NULL);
+
+    cini_cache_set(&cini, CINI_CACHE_STAT);
+    cini_group_begin(&cini, "cache");
+
+    // 文件未变化时复用同一文档
+    cini_doc_t *cached = cini.cache;
+    ctest_assert_bool(cached != NULL);
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    ctest_assert_string(result, "first");
+    ctest_assert_bool(cini.cache == cached);
+    ctest_assert_bool(cini_value_view(&cini, "name", &view, &size));
+    ctest_assert_bool(size == 5 && memcmp(view, "first", size) == 0);
+    ctest_assert_bool(!cini_value_view(&cini, "missing", &view, &size) && view == NULL && size == 0);
+
+    // 自身的写入更新状态戳, 不会使缓存失效
+    cini_value_set(&cini, "count", "1");
+    ctest_assert_bool(cini.cache == cached);
+    ctest_assert_bool(!cini_doc_changed(cached, CINI_TEST_FILE, false));
+
+    // 外部修改后重新加载
+    ctest_file_write(CINI_TEST_FILE, "[cache]\nname=second value\n");
+    ctest_assert_bool(cini_doc_changed(cini.cache, CINI_TEST_FILE, false));
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    ctest_assert_string(result, "second value");
+    ctest_assert_bool(!cini_value_contains(&cini, "count"));
+
+    // 重写相同内容: 状态变化, 内容哈希值相同
+    cini_cache_set(&cini, CINI_CACHE_CONTENT);
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    cached = cini.cache;
+    ctest_file_write(CINI_TEST_FILE, "[cache]\nname=second value\n");
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    ctest_assert_string(result, "second value");
+    ctest_assert_bool(cini.cache == cached);
+    ctest_file_write(CINI_TEST_FILE, "[cache]\nname=second VALUE\n");
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    ctest_assert_string(result, "second VALUE");
+
+    // 事务提交后的文档作为缓存
+    ctest_assert_bool(cini_txn_begin(&cini));
+    ctest_assert_bool(cini.cache == NULL);
+    cini_value_set(&cini, "name", "third");
+    ctest_assert_bool(cini_txn_commit(&cini));
+    ctest_assert_bool(cini.cache != NULL);
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    ctest_assert_string(result, "third");
+
+    // 文件被删除
+    remove(CINI_TEST_FILE);
+    ctest_assert_bool(cini_doc_changed(cini.cache, CINI_TEST_FILE, true));
+    cini_value_get(&cini, "name", "default", result, sizeof(result));
+    ctest_assert_string(result, "default");
+
+    cini_release(&cini);
+    ctest_assert_bool(cini.cache == NULL);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_watch(int argc, char **argv)
+{
+    // 文档比较: 修改、新增、移除, 同名键以生效的值为准
+    {
+        int         count   = 0;
+        cini_doc_t *old_doc = cini_doc_create();
+        cini_doc_t *new_doc = cini_doc_create();
+        cini_doc_value_set(old_doc, "a", "same", "1");
+        cini_doc_value_set(old_doc, "a", "changed", "1");
+        cini_doc_value_set(old_doc, "a", "removed", "1");
+        cini_doc_value_set(old_doc, "gone", "key", "1");
+        cini_doc_value_set(new_doc, "a", "same", "1");
+        cini_doc_value_set(new_doc, "a", "changed", "2");
+        cini_doc_value_set(new_doc, "a", "added", "1");
+        cini_doc_diff(old_doc, new_doc, ctest_diff_count, &count);
+        ctest_assert_bool(count == 4);
+        count = 0;
+        cini_doc_diff(new_doc, new_doc, ctest_diff_count, &count);
+        ctest_assert_bool(count == 0);
+        cini_doc_free(old_doc);
+        cini_doc_free(new_doc);
+    }
+
+#ifdef __C_PLATFORM_LINUX
+    cini_t               cini        = CINI_INITIALIZATION;
+    ctest_watch_record_t port        = {0};
+    ctest_watch_record_t all         = {0};
+    char                 result[256] = {0};
+    int                  index       = 0;
+
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=80\nhost=a\n[log]\nlevel=1\n");
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_watch_t *watch = cini_watch_create(&cini);
+    ctest_assert_bool(watch != NULL);
+    ctest_assert_bool(cini_watch_add(watch, "net", "port", ctest_watch_func, &port));
+    ctest_assert_bool(cini_watch_add(watch, NULL, NULL, ctest_watch_func, &all));
+
+    // 替换文件 (先写临时文件再重命名), 只有变化的键触发回调
+    cini_group_begin(&cini, "log");
+    cini_value_set(&cini, "level", "2");
+    ctest_assert_bool(cini_watch_poll(watch, 1000));
+    ctest_assert_bool(port.count == 0);
+    ctest_assert_bool(all.count == 1);
+    ctest_assert_string(all.last, "log.level:1->2");
+
+    // 重写相同内容不触发回调
+    ctest_file_read(CINI_TEST_FILE, result, sizeof(result));
+    ctest_file_write(CINI_TEST_FILE, result);
+    ctest_assert_bool(!cini_watch_poll(watch, 1000));
+    ctest_assert_bool(all.count == 1);
+
+    // 后台线程
+    ctest_assert_bool(cini_watch_start(watch));
+    ctest_assert_bool(!cini_watch_start(watch));
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=8080\n[log]\nlevel=2\n");
+    for (index = 0; index < 200 && __atomic_load_n(&all.count, __ATOMIC_ACQUIRE) < 3; ++index) {
+        usleep(10000);
+    }
+    cini_watch_stop(watch);
+    ctest_assert_bool(port.count == 1);
+    ctest_assert_string(port.last, "net.port:80->8080");
+    ctest_assert_bool(all.count == 3);
+    ctest_assert_string(all.last, "net.host:a->(null)");
+
+    cini_watch_free(watch);
+    remove(CINI_TEST_FILE);
+#endif
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_snap(int argc, char **argv)
+{
+    char   buffer[32] = {0};
+    size_t index      = 0;
+
+    cini_snap_t *snap = cini_snap_create();
+    ctest_assert_bool(snap != NULL);
+    cini_snap_reader_t *reader = cini_snap_reader_create(snap);
+    ctest_assert_bool(reader != NULL);
+
+    // 尚未发布
+    ctest_assert_bool(!cini_snap_value_get(reader, "snap", "key", "none", buffer, sizeof(buffer)));
+    ctest_assert_string(buffer, "none");
+
+    // 读取区内持有的快照不受后续发布影响, 发布后的文档被冻结
+    cini_doc_t *doc = cini_doc_create();
+    cini_doc_value_set(doc, "snap", "key", "first");
+    ctest_assert_bool(cini_snap_publish(snap, doc));
+    ctest_assert_bool(!cini_doc_value_set(doc, "snap", "key", "changed"));
+    cini_doc_t *held = cini_snap_enter(reader);
+    doc              = cini_doc_create();
+    cini_doc_value_set(doc, "snap", "key", "second");
+    ctest_assert_bool(cini_snap_publish(snap, doc));
+    cini_snap_reclaim(snap);
+    ctest_assert_bool(cini_doc_value_get(held, "snap", "key", "none", buffer, sizeof(buffer)));
+    ctest_assert_string(buffer, "first");
+    const char *view = NULL;
+    size_t      size = 0;
+    ctest_assert_bool(cini_doc_value_view(held, "snap", "key", &view, &size));
+    ctest_assert_bool(size == 5 && memcmp(view, "first", size) == 0);
+    cini_snap_leave(reader);
+    ctest_assert_bool(cini_snap_value_get(reader, "snap", "key", "none", buffer, sizeof(buffer)));
+    ctest_assert_string(buffer, "second");
+
+    // 多个读取线程与一个发布线程并发
+    pthread_t threads[4];
+    for (index = 0; index < 4; ++index) {
+        ctest_assert_bool(pthread_create(&threads[index], NULL, ctest_snap_reader, snap) == 0);
+    }
+    for (index = 0; index < 2000; ++index) {
+        snprintf(buffer, sizeof(buffer), "%zu", index);
+        doc = cini_doc_create();
+        cini_doc_value_set(doc, "snap", "a", buffer);
+        cini_doc_value_set(doc, "snap", "b", buffer);
+        ctest_assert_bool(cini_snap_publish(snap, doc));
+    }
+    doc = cini_doc_create();
+    cini_doc_value_set(doc, "snap", "a", "stop");
+    cini_doc_value_set(doc, "snap", "b", "stop");
+    ctest_assert_bool(cini_snap_publish(snap, doc));
+    for (index = 0; index < 4; ++index) {
+        void *result = NULL;
+        pthread_join(threads[index], &result);
+        ctest_assert_bool(result == NULL);
+    }
+
+    cini_snap_reader_free(reader);
+    cini_snap_free(snap);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_image(int argc, char **argv)
+{
+    char key[32]     = {0};
+    char value[32]   = {0};
+    char result[256] = {0};
+    int  index       = 0;
+
+    // 同名组与同名键以第一个组、生效的键为准
+    ctest_file_write(CINI_TEST_FILE,
+                     "; comment\n[net]\nport=80\nport=81\n[empty]\n[net]\nhost=b\n[log]\nlevel = 3 \n");
+    cini_doc_t *doc = cini_doc_load(CINI_TEST_FILE);
+    for (index = 0; index < 1000; ++index) {
+        snprintf(key, sizeof(key), "key_%d", index);
+        snprintf(value, sizeof(value), "value_%d", index);
+        cini_doc_value_set(doc, "many", key, value);
+    }
+    remove(CINI_TEST_IMAGE);
+    ctest_assert_bool(cini_image_publish(doc, CINI_TEST_IMAGE));
+
+    cini_image_t *image = cini_image_open(CINI_TEST_IMAGE);
+    ctest_assert_bool(image != NULL);
+    ctest_assert_bool(cini_image_generation(image) == 1);
+    ctest_assert_bool(!cini_image_stale(image));
+    ctest_assert_bool(cini_image_group_contains(image, "empty"));
+    ctest_assert_bool(!cini_image_group_contains(image, "missing"));
+    ctest_assert_bool(cini_image_value_get(image, "net", "port", "none", result, sizeof(result)));
+    ctest_assert_string(result, "80");
+    ctest_assert_bool(!cini_image_value_contains(image, "net", "host"));
+    const char *view = NULL;
+    size_t      size = 0;
+    ctest_assert_bool(cini_image_value_view(image, "net", "port", &view, &size) && size == 2);
+    ctest_assert_string(view, "80");
+    ctest_assert_bool(!cini_image_value_view(image, "net", "host", &view, &size) && view == NULL);
+    cini_image_value_get(image, "log", "level", "none", result, sizeof(result));
+    ctest_assert_string(result, "3 ");
+    for (index = 0; index < 1000; ++index) {
+        snprintf(key, sizeof(key), "key_%d", index);
+        snprintf(value, sizeof(value), "value_%d", index);
+        cini_image_value_get(image, "many", key, "none", result, sizeof(result));
+        ctest_assert_string(result, value);
+    }
+    ctest_assert_bool(!cini_image_value_get(image, "many", "key_1000", "none", result, sizeof(result)));
+    ctest_assert_string(result, "none");
+
+    // 重新发布: 旧映像被标记为已替换但仍可读取
+    cini_doc_value_set(doc, "net", "port", "8080");
+    ctest_assert_bool(cini_image_publish(doc, CINI_TEST_IMAGE));
+#ifndef __C_PLATFORM_WIN
+    ctest_assert_bool(cini_image_stale(image));
+#endif
+    ctest_assert_bool(cini_image_verify(image));
+    cini_image_value_get(image, "net", "port", "none", result, sizeof(result));
+    ctest_assert_string(result, "80");
+    cini_image_free(image);
+    image = cini_image_open(CINI_TEST_IMAGE);
+    ctest_assert_bool(cini_image_generation(image) == 2);
+    ctest_assert_bool(!cini_image_stale(image));
+    ctest_assert_bool(cini_image_verify(image));
+    cini_image_value_get(image, "net", "port", "none", result, sizeof(result));
+    ctest_assert_string(result, "8080");
+    cini_image_free(image);
+
+    // 内容损坏: 结构仍有效, 校验和不一致
+    FILE *fd = fopen(CINI_TEST_IMAGE, "r+b");
+    ctest_assert_bool(fd != NULL);
+    fseek(fd, -2, SEEK_END);
+    fputc('#', fd);
+    fclose(fd);
+    image = cini_image_open(CINI_TEST_IMAGE);
+    ctest_assert_bool(image != NULL);
+    ctest_assert_bool(!cini_image_verify(image));
+    cini_image_free(image);
+
+    // 格式错误
+    ctest_file_write(CINI_TEST_IMAGE, "[net]\nport=80\n");
+    ctest_assert_bool(cini_image_open(CINI_TEST_IMAGE) == NULL);
+
+    cini_doc_free(doc);
+    remove(CINI_TEST_FILE);
+    remove(CINI_TEST_IMAGE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_scan(int argc, char **argv)
+{
+    char     buffer[512] = {0};
+    unsigned seed        = 1;
+    size_t   index       = 0;
+
+    // 随机填充, 结构字符较稀疏
+    for (index = 0; index < sizeof(buffer); ++index) {
+        seed              = seed * 1103515245U + 12345U;
+        const size_t pick = (seed >> 16) % 64;
+        buffer[index]     = pick < 4 ? "\n=[]"[pick] : (char)('a' + pick % 26);
+    }
+
+    const cini_scan_func_t scalar = cini_scan_func(CINI_SCAN_SCALAR);
+    ctest_assert_bool(scalar != NULL);
+
+    int kind = 0;
+    for (kind = CINI_SCAN_SCALAR; kind <= CINI_SCAN_AVX2; ++kind) {
+        const cini_scan_func_t func = cini_scan_func(kind);
+        if (!func) {
+            continue;
+        }
+        size_t begin = 0;
+        size_t end   = 0;
+        for (begin = 0; begin < 80; ++begin) {
+            for (end = begin; end < sizeof(buffer); end += 7) {
+                ctest_assert_bool(func(buffer + begin, buffer + end) == scalar(buffer + begin, buffer + end));
+            }
+        }
+        // 没有结构字符时返回 end
+        char plain[100] = {0};
+        memset(plain, 'x', sizeof(plain));
+        ctest_assert_bool(func(plain, plain + sizeof(plain)) == plain + sizeof(plain));
+        plain[99] = ']';
+        ctest_assert_bool(func(plain, plain + sizeof(plain)) == plain + 99);
+    }
+    ctest_assert_bool(cini_scan(buffer, buffer + sizeof(buffer)) == scalar(buffer, buffer + sizeof(buffer)));
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_typed(int argc, char **argv)
+{
+    char     buffer[64] = {0};
+    int64_t  number     = 0;
+    uint64_t uvalue     = 0;
+    double   real       = 0;
+    bool     flag       = false;
+
+    ctest_file_write(CINI_TEST_FILE, "[num]\nint = -42\nhex=0x1F\nuint=18446744073709551615\nreal=2.5\nflag=Yes\n"
+                                     "bad=12abc\nover=9223372036854775808\n[unit]\nwait=1h30m\nms=250\nsize=64 KiB\n"
+                                     "big=2g\nodd=5x\n");
+    cini_doc_t *doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+
+    ctest_assert_bool(cini_doc_int_get(doc, "num", "int", 0, &number) && number == -42);
+    ctest_assert_bool(cini_doc_int_get(doc, "num", "hex", 0, &number) && number == 31);
+    ctest_assert_bool(cini_doc_uint_get(doc, "num", "uint", 0, &uvalue) && uvalue == UINT64_MAX);
+    ctest_assert_bool(cini_doc_double_get(doc, "num", "real", 0, &real) && real == 2.5);
+    ctest_assert_bool(cini_doc_bool_get(doc, "num", "flag", false, &flag) && flag);
+    ctest_assert_bool(cini_doc_duration_get(doc, "unit", "wait", 0, &number) && number == 5400000);
+    ctest_assert_bool(cini_doc_duration_get(doc, "unit", "ms", 0, &number) && number == 250);
+    ctest_assert_bool(cini_doc_size_get(doc, "unit", "size", 0, &uvalue) && uvalue == 65536);
+    ctest_assert_bool(cini_doc_size_get(doc, "unit", "big", 0, &uvalue) && uvalue == (2ULL << 30));
+
+    // 缓存的结果重复读取一致, 以其他类型读取时重新转换
+    ctest_assert_bool(cini_doc_int_get(doc, "num", "int", 0, &number) && number == -42);
+    ctest_assert_bool(cini_doc_double_get(doc, "num", "int", 0, &real) && real == -42.0);
+    ctest_assert_bool(!cini_doc_uint_get(doc, "num", "int", 7, &uvalue) && uvalue == 7);
+
+    // 无效值、溢出与不存在的键返回默认值
+    ctest_assert_bool(!cini_doc_int_get(doc, "num", "bad", -1, &number) && number == -1);
+    ctest_assert_bool(!cini_doc_int_get(doc, "num", "over", -1, &number) && number == -1);
+    ctest_assert_bool(!cini_doc_bool_get(doc, "num", "bad", true, &flag) && flag);
+    ctest_assert_bool(!cini_doc_duration_get(doc, "unit", "odd", 3, &number) && number == 3);
+    ctest_assert_bool(!cini_doc_size_get(doc, "unit", "odd", 3, &uvalue) && uvalue == 3);
+    ctest_assert_bool(!cini_doc_int_get(doc, "num", "missing", 9, &number) && number == 9);
+    ctest_assert_bool(!cini_doc_int_get(NULL, "num", "int", 9, &number) && number == 9);
+
+    // 设置后文本与缓存同时更新
+    ctest_assert_bool(cini_doc_int_set(doc, "num", "int", INT64_MIN));
+    ctest_assert_bool(cini_doc_int_get(doc, "num", "int", 0, &number) && number == INT64_MIN);
+    cini_doc_value_get(doc, "num", "int", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "-9223372036854775808");
+    ctest_assert_bool(cini_doc_value_set(doc, "num", "int", "17"));
+    ctest_assert_bool(cini_doc_int_get(doc, "num", "int", 0, &number) && number == 17);
+    cini_doc_double_set(doc, "num", "real", 0.1);
+    cini_doc_value_get(doc, "num", "real", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "0.1");
+    cini_doc_bool_set(doc, "num", "flag", false);
+    cini_doc_value_get(doc, "num", "flag", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "false");
+    cini_doc_duration_set(doc, "unit", "wait", 90000);
+    cini_doc_value_get(doc, "unit", "wait", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "90s");
+    cini_doc_size_set(doc, "unit", "size", 3ULL << 20);
+    cini_doc_value_get(doc, "unit", "size", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "3M");
+    cini_doc_uint_set(doc, "new", "uint", 12345);
+    ctest_assert_bool(cini_doc_uint_get(doc, "new", "uint", 0, &uvalue) && uvalue == 12345);
+    cini_doc_free(doc);
+
+    // cini对象接口
+    cini_t cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_cache_set(&cini, CINI_CACHE_STAT);
+    cini_group_begin(&cini, "unit");
+    ctest_assert_bool(cini_value_duration_get(&cini, "wait", 0) == 5400000);
+    ctest_assert_bool(cini_value_duration_get(&cini, "wait", 0) == 5400000);
+    ctest_assert_bool(cini_value_int_get(&cini, "missing", -5) == -5);
+    cini_value_size_set(&cini, "size", 1ULL << 40);
+    cini_value_bool_set(&cini, "enable", true);
+    ctest_assert_bool(cini_value_size_get(&cini, "size", 0) == (1ULL << 40));
+    ctest_assert_bool(cini_value_bool_get(&cini, "enable", false));
+    cini_value_get(&cini, "size", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "1T");
+    cini_group_end(&cini);
+    cini_release(&cini);
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_stream(int argc, char **argv)
+{
+    const char *content = "; head\r\nroot=1\n[net]\r\nport = 80\r\n  # indent\nport=81\n bad=1\n[broken\nlost=1\n"
+                          "[log]\nlevel=3";
+    ctest_stream_record_t record = {0};
+    cini_stream_t         stream = {ctest_stream_entry, ctest_stream_entry, ctest_stream_comment, &record};
+
+    // 同名键不去重, 组外的键值对不带组名称
+    ctest_assert_bool(cini_stream_buffer(content, strlen(content), &stream));
+    ctest_assert_bool(record.sections == 2 && record.pairs == 5 && record.comments == 2);
+    ctest_assert_string(record.last, "log.level=3");
+
+    // 回调停止解析
+    memset(&record, 0, sizeof(record));
+    record.stop = 2;
+    ctest_assert_bool(!cini_stream_buffer(content, strlen(content), &stream));
+    ctest_assert_string(record.last, "net.port=80");
+
+    // 文件: 超过读取缓冲区的长行
+    const size_t length = 300000;
+    char        *text   = (char *)malloc(length + 64);
+    ctest_assert_bool(text != NULL);
+    strcpy(text, "[big]\nkey=");
+    memset(text + 10, 'v', length);
+    strcpy(text + 10 + length, "\ntail=end\n");
+    ctest_file_write(CINI_TEST_FILE, text);
+    memset(&record, 0, sizeof(record));
+    ctest_assert_bool(cini_stream_file(CINI_TEST_FILE, &stream));
+    ctest_assert_bool(record.pairs == 2 && record.value_size == length);
+    ctest_assert_string(record.last, "big.tail=end");
+    free(text);
+    ctest_assert_bool(!cini_stream_file("missing.ini", &stream));
+
+#ifdef __C_PLATFORM_LINUX
+    // 管道
+    int fds[2];
+    ctest_assert_bool(pipe(fds) == 0);
+    ctest_assert_bool(write(fds[1], content, strlen(content)) == (ssize_t)strlen(content));
+    close(fds[1]);
+    memset(&record, 0, sizeof(record));
+    ctest_assert_bool(cini_stream_fd(fds[0], &stream));
+    close(fds[0]);
+    ctest_assert_bool(record.sections == 2 && record.pairs == 5 && record.comments == 2);
+#endif
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_stats(int argc, char **argv)
+{
+    const char  *content = "[net]\nport=80\nhost=local\n";
+    char         buffer[64];
+    cini_stats_t stats;
+    cini_stats_t global;
+    cini_stats_t before;
+
+    ctest_file_write(CINI_TEST_FILE, content);
+    cini_stats_global_get(&before);
+
+    // 无缓存时每次访问都读取文件, 修改时写临时文件后重命名
+    cini_t cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_group_begin(&cini, "net");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "80");
+    cini_value_set(&cini, "port", "8080");
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.files_opened == 4 && stats.rewrites == 1 && stats.renames == 1);
+    ctest_assert_bool(stats.bytes_read == 3 * strlen(content) && stats.lines_scanned == 9);
+
+    FILE *fd = fopen(CINI_TEST_FILE, "rb");
+    ctest_assert_bool(fd != NULL);
+    fseek(fd, 0, SEEK_END);
+    ctest_assert_bool(stats.bytes_written == (uint64_t)ftell(fd));
+    fclose(fd);
+
+    // 进程计数包含所有句柄的计数
+    cini_stats_global_get(&global);
+    ctest_assert_bool(global.files_opened - before.files_opened >= stats.files_opened);
+    ctest_assert_bool(global.bytes_read - before.bytes_read >= stats.bytes_read);
+    ctest_assert_bool(global.renames - before.renames >= stats.renames);
+
+    // 缓存命中时不读取文件
+    cini_stats_reset(&cini);
+    cini_cache_set(&cini, CINI_CACHE_STAT);
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    cini_value_get(&cini, "host", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "local");
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.files_opened == 1 && stats.lines_scanned == 3 && stats.bytes_written == 0);
+    cini_group_end(&cini);
+    cini_release(&cini);
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_io(int argc, char **argv)
+{
+    const char  *content  = "[net]\nport=80\n";
+    const char  *expected = "[net]\nport=80\nhost=local\n";
+    const char  *data     = NULL;
+    char         buffer[64];
+    size_t       size = 0;
+    cini_stats_t stats;
+
+    // 内存后端: 不访问文件系统, 修改写回后端
+    cini_io_t *memory = cini_io_memory_create(content, strlen(content));
+    ctest_assert_bool(memory != NULL);
+    cini_t cini = CINI_NULL;
+    cini_io_set(&cini, memory);
+    cini_cache_set(&cini, CINI_CACHE_STAT);
+    cini_group_begin(&cini, "net");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "80");
+    cini_value_set(&cini, "host", "local");
+    data = cini_io_data(memory, &size);
+    ctest_assert_bool(size == strlen(expected) && memcmp(data, expected, size) == 0);
+
+    // 版本不变时复用缓存, 内容被替换后重新读取
+    cini_stats_reset(&cini);
+    cini_value_get(&cini, "host", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "local");
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.files_opened == 0);
+    cini_doc_t *doc = cini_doc_load_io(memory, STR_NULL);
+    ctest_assert_bool(doc != NULL && cini_doc_value_set(doc, "net", "port", "81"));
+    ctest_assert_bool(cini_doc_save_io(doc, memory, STR_NULL));
+    cini_doc_free(doc);
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "81");
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.files_opened == 1);
+    cini_group_end(&cini);
+    cini_release(&cini);
+    cini_io_free(memory);
+
+    // 嵌入内容后端: 文档直接引用内容, 不可写入
+    static const char blob[] = "[app]\nname=demo\n";
+    cini_io_t        *embed  = cini_io_blob_create(blob, sizeof(blob) - 1);
+    ctest_assert_bool(embed != NULL);
+    doc = cini_doc_load_io(embed, STR_NULL);
+    ctest_assert_bool(cini_doc_value_view(doc, "app", "name", &data, &size));
+    ctest_assert_bool(data >= blob && data < blob + sizeof(blob) && size == 4);
+    ctest_assert_bool(cini_doc_value_set(doc, "app", "name", "other"));
+    ctest_assert_bool(!cini_doc_save_io(doc, embed, STR_NULL));
+    cini_doc_free(doc);
+    data = cini_io_data(embed, &size);
+    ctest_assert_bool(data == blob && size == sizeof(blob) - 1);
+    cini_io_free(embed);
+
+    // 文件后端
+    ctest_file_write(CINI_TEST_FILE, content);
+    doc = cini_doc_load_io(cini_io_file(), CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && cini_doc_value_set(doc, "net", "port", "82"));
+    ctest_assert_bool(cini_doc_save_io(doc, cini_io_file(), CINI_TEST_FILE));
+    cini_doc_free(doc);
+    ctest_assert_bool(cini_doc_load_io(cini_io_file(), "missing.ini") == NULL);
+
+    cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_io_set(&cini, cini_io_file());
+    cini_cache_set(&cini, CINI_CACHE_STAT);
+    cini_group_begin(&cini, "net");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "82");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.files_opened == 1);
+    cini_group_end(&cini);
+    cini_release(&cini);
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_arena(int argc, char **argv)
+{
+    static unsigned char storage[65536];
+    char                 buffer[64];
+    cini_arena_t         arena;
+    ctest_alloc_count_t  count = {0, 0};
+
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=80\nhost=local\n[log]\nlevel=3\n");
+
+    // 静态模式: 只使用调用者提供的内存, 释放文档不回收内存
+    cini_arena_init(&arena, storage, sizeof(storage), 0);
+    cini_doc_t *doc = cini_doc_load_alloc(&arena.allocator, NULL, CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    ctest_assert_bool(cini_doc_value_set(doc, "net", "port", "8080") && cini_doc_value_set(doc, "new", "key", "1"));
+    cini_doc_value_get(doc, "net", "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "8080");
+    const size_t used = cini_arena_used(&arena);
+    ctest_assert_bool(used > 0 && used <= sizeof(storage));
+    cini_doc_free(doc);
+    ctest_assert_bool(cini_arena_used(&arena) == used);
+    cini_arena_reset(&arena);
+    ctest_assert_bool(cini_arena_used(&arena) == 0);
+
+    // 空间不足时加载失败
+    cini_arena_init(&arena, storage, 256, 0);
+    ctest_assert_bool(cini_doc_load_alloc(&arena.allocator, NULL, CINI_TEST_FILE) == NULL);
+
+    // 增长模式: 超过块大小的请求独占一块
+    cini_arena_init(&arena, NULL, 0, 4096);
+    doc = cini_doc_load_alloc(&arena.allocator, NULL, CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && cini_doc_detach(doc));
+    cini_doc_value_get(doc, "log", "level", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "3");
+    cini_arena_reset(&arena);
+
+#ifdef __C_PLATFORM_LINUX
+    // 文件内容读入竞技场而不映射, 回收竞技场前无需释放文档
+    cini_arena_init(&arena, storage, sizeof(storage), 0);
+    doc = cini_doc_load_alloc(&arena.allocator, NULL, CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && !ctest_file_mapped(CINI_TEST_FILE));
+    cini_doc_value_get(doc, "net", "host", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "local");
+    cini_arena_reset(&arena);
+    ctest_assert_bool(!ctest_file_mapped(CINI_TEST_FILE));
+
+    // 可释放内存的分配器仍映射文件
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && ctest_file_mapped(CINI_TEST_FILE));
+    cini_doc_free(doc);
+    ctest_assert_bool(!ctest_file_mapped(CINI_TEST_FILE));
+#endif
+
+    // 自定义分配器: 所有分配都被释放
+    cini_allocator_t allocator = {ctest_alloc, ctest_free, &count};
+    doc                        = cini_doc_load_alloc(&allocator, NULL, CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && cini_doc_value_set(doc, "net", "host", "remote"));
+    ctest_assert_bool(cini_doc_save(doc, CINI_TEST_FILE));
+    cini_doc_free(doc);
+    ctest_assert_bool(count.allocs > 0 && count.allocs == count.frees);
+
+    // cini对象
+    cini_arena_init(&arena, NULL, 0, 65536);
+    cini_t cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_alloc_set(&cini, &arena.allocator);
+    cini_group_begin(&cini, "net");
+    cini_value_get(&cini, "host", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "remote");
+    cini_value_set(&cini, "port", "81");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "81");
+    cini_group_end(&cini);
+    cini_release(&cini);
+    cini_arena_reset(&arena);
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_intern(int argc, char **argv)
+{
+    static char content[65536];
+    char        buffer[64];
+    char        group[32];
+    char        key[32];
+    int64_t     value  = 0;
+    size_t      length = 0;
+    int         count  = 0;
+
+    // 多个组重复使用同一组键名称
+    for (int index = 0; index < 200; ++index) {
+        length += (size_t)snprintf(content + length, sizeof(content) - length, "[group_%d]\n", index);
+        for (int item = 0; item < 30; ++item) {
+            length += (size_t)snprintf(content + length, sizeof(content) - length, "key_%d=%d\n", item, index + item);
+        }
+    }
+    length += (size_t)snprintf(content + length, sizeof(content) - length, "[dup]\nkey_0=first\nkey_0=second\n");
+    ctest_file_write(CINI_TEST_FILE, content);
+
+    cini_doc_t *doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    for (int index = 0; index < 200; index += 37) {
+        for (int item = 0; item < 30; item += 7) {
+            snprintf(group, sizeof(group), "group_%d", index);
+            snprintf(key, sizeof(key), "key_%d", item);
+            ctest_assert_bool(cini_doc_int_get(doc, group, key, -1, &value) && value == index + item);
+        }
+    }
+    ctest_assert_bool(!cini_doc_value_contains(doc, "group_0", "key_30"));
+    ctest_assert_bool(!cini_doc_value_contains(doc, "key_0", "key_0"));
+
+    // 首个重复键生效, 移除时重复键全部移除
+    cini_doc_value_get(doc, "dup", "key_0", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "first");
+    ctest_assert_bool(cini_doc_value_remove(doc, "dup", "key_0"));
+    ctest_assert_bool(!cini_doc_value_contains(doc, "dup", "key_0"));
+
+    // 已存在的名称与新名称
+    ctest_assert_bool(cini_doc_value_set(doc, "group_5", "key_3", "x"));
+    ctest_assert_bool(cini_doc_value_set(doc, "key_1", "group_1", "y"));
+    cini_doc_value_get(doc, "key_1", "group_1", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "y");
+    ctest_assert_bool(!cini_doc_value_contains(doc, "group_1", "group_1"));
+
+    // 两个文档的符号各自独立
+    cini_doc_t *other = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(other != NULL);
+    cini_doc_diff(other, doc, ctest_diff_count, &count);
+    ctest_assert_bool(count == 3);
+    cini_doc_free(other);
+
+    ctest_assert_bool(cini_doc_detach(doc) && cini_doc_save(doc, CINI_TEST_FILE));
+    cini_doc_free(doc);
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    cini_doc_value_get(doc, "group_5", "key_3", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "x");
+    cini_doc_free(doc);
+
     remove(CINI_TEST_FILE);
     return 0;
     __c_unused(argc);
     __c_unused(argv);
 }
 
-// -------------------------[STATIC DEFINITION]-------------------------
\ No newline at end of file
+int ctest_func_cini_key(int argc, char **argv)
+{
+    char        buffer[64];
+    const char *value = NULL;
+    size_t      size  = 0;
+    int64_t     port  = 0;
+    bool        flag  = false;
+
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=80\nhost=local\n[log]\nverbose=yes\n");
+    cini_doc_t *doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+
+    cini_key_t key_port    = cini_key_prepare("net", "port");
+    cini_key_t key_host    = cini_key_prepare("net", "host");
+    cini_key_t key_verbose = cini_key_prepare("log", "verbose");
+    cini_key_t key_missing = cini_key_prepare("net", "timeout");
+    for (int index = 0; index < 3; ++index) {
+        ctest_assert_bool(cini_doc_key_int_get(doc, &key_port, 0, &port) && port == 80);
+        ctest_assert_bool(cini_doc_key_bool_get(doc, &key_verbose, false, &flag) && flag);
+        ctest_assert_bool(cini_doc_key_view(doc, &key_host, &value, &size) && size == 5);
+        ctest_assert_bool(!cini_doc_key_contains(doc, &key_missing));
+    }
+    cini_doc_key_get(doc, &key_missing, "none", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "none");
+
+    // 修改已存在的键: 缓存的行仍然有效
+    ctest_assert_bool(cini_doc_value_set(doc, "net", "port", "8080"));
+    ctest_assert_bool(cini_doc_key_int_get(doc, &key_port, 0, &port) && port == 8080);
+
+    // 增删键使缓存失效
+    ctest_assert_bool(cini_doc_value_set(doc, "net", "timeout", "30"));
+    cini_doc_key_get(doc, &key_missing, "none", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "30");
+    ctest_assert_bool(cini_doc_value_remove(doc, "net", "host"));
+    ctest_assert_bool(!cini_doc_key_view(doc, &key_host, &value, &size) && value == NULL);
+
+    // 在另一个文档中使用同一个键
+    cini_doc_t *other = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(other != NULL);
+    ctest_assert_bool(cini_doc_key_int_get(other, &key_port, 0, &port) && port == 80);
+    ctest_assert_bool(cini_doc_key_contains(other, &key_host) && !cini_doc_key_contains(doc, &key_host));
+    cini_doc_free(other);
+
+    // 无效参数
+    cini_key_t key_null = cini_key_prepare(NULL, "port");
+    ctest_assert_bool(!cini_doc_key_contains(doc, &key_null) && !cini_doc_key_contains(NULL, &key_port));
+    ctest_assert_bool(!cini_doc_key_int_get(doc, &key_host, -1, &port) && port == -1);
+    cini_doc_free(doc);
+
+    remove(CINI_TEST_FILE);
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_parallel(int argc, char **argv)
+{
+    const size_t max     = 2 << 20;
+    char        *content = (char *)malloc(max);
+    char        *saved   = (char *)malloc(max);
+    size_t       length  = 0;
+    size_t       start   = 0;
+    size_t       end     = 0;
+    int          count   = 0;
+    ctest_assert_bool(content && saved);
+
+    // 组名称循环出现 (之后的同名组不生效), 含重复键、注释、CRLF、组外的键与格式错误的组标题
+    length += (size_t)snprintf(content + length, max - length, "orphan=1\n");
+    for (int index = 0; length < max - 4096; ++index) {
+        length += (size_t)snprintf(content + length, max - length, "[group_%d]\r\n", index % 5000);
+        for (int item = 0; item < 8; ++item) {
+            length += (size_t)snprintf(content + length, max - length, "key_%d=%d\n", item % 6, index + item);
+        }
+        length += (size_t)snprintf(content + length, max - length, index % 7 ? "; note\n\n" : "[broken\nlost=1\n");
+    }
+    length += (size_t)snprintf(content + length, max - length, "[last]\nkey=end");
+    ctest_file_write(CINI_TEST_FILE, content);
+
+    cini_doc_t *serial   = cini_doc_load(CINI_TEST_FILE);
+    cini_doc_t *parallel = cini_doc_load_parallel(CINI_TEST_FILE, 4);
+    ctest_assert_bool(serial != NULL && parallel != NULL);
+    cini_doc_diff(serial, parallel, ctest_diff_count, &count);
+    ctest_assert_bool(count == 0);
+    for (int index = 0; index < 5000; index += 499) {
+        char group[32];
+        snprintf(group, sizeof(group), "group_%d", index);
+        ctest_assert_bool(cini_doc_group_find(parallel, group, &start, &end));
+        size_t serial_start = 0;
+        size_t serial_end   = 0;
+        ctest_assert_bool(cini_doc_group_find(serial, group, &serial_start, &serial_end));
+        ctest_assert_bool(start == serial_start && end == serial_end);
+    }
+    ctest_assert_bool(!cini_doc_value_contains(parallel, "broken", "lost"));
+    ctest_assert_bool(cini_doc_value_remove(parallel, "group_3", "key_1"));
+    ctest_assert_bool(!cini_doc_value_contains(parallel, "group_3", "key_1"));
+
+    // 重新加载后保存的内容与原文件相同
+    cini_doc_free(parallel);
+    parallel = cini_doc_load_parallel(CINI_TEST_FILE, 16);
+    ctest_assert_bool(parallel != NULL && cini_doc_save(parallel, CINI_TEST_FILE ".out"));
+    ctest_file_read(CINI_TEST_FILE ".out", saved, max);
+    ctest_assert_bool(strlen(saved) == length && memcmp(saved, content, length) == 0);
+    cini_doc_free(parallel);
+    cini_doc_free(serial);
+
+#ifdef __C_PLATFORM_LINUX
+    // 线程池的线程常驻并被之后的解析复用, 不随每次加载创建
+    const int threads = ctest_thread_count();
+    for (int index = 0; index < 4; ++index) {
+        parallel = cini_doc_load_parallel(CINI_TEST_FILE, 16);
+        ctest_assert_bool(parallel != NULL);
+        cini_doc_free(parallel);
+    }
+    ctest_assert_bool(threads > 1 && ctest_thread_count() == threads);
+
+#endif
+
+    // cini对象
+    cini_t cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_cache_set(&cini, CINI_CACHE_STAT);
+    cini_threads_set(&cini, 8);
+    cini_group_begin(&cini, "last");
+    ctest_assert_bool(cini_value_contains(&cini, "key"));
+    cini_group_end(&cini);
+    cini_release(&cini);
+
+    // 从竞技场分配: 空间只够存放文件内容时在解析中途失败, 足够时正常解析
+    cini_arena_t arena;
+    char        *storage = (char *)malloc(max * 2);
+    ctest_assert_bool(storage != NULL);
+    cini_arena_init(&arena, storage, max * 2, 0);
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_alloc_set(&cini, &arena.allocator);
+    cini_threads_set(&cini, 4);
+    cini_group_begin(&cini, "last");
+    ctest_assert_bool(!cini_value_contains(&cini, "key"));
+    cini_group_end(&cini);
+    cini_release(&cini);
+    cini_arena_init(&arena, NULL, 0, 1 << 20);
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_alloc_set(&cini, &arena.allocator);
+    cini_threads_set(&cini, 4);
+    cini_group_begin(&cini, "group_4999");
+    cini_value_get(&cini, "key_5", "", saved, max);
+    ctest_assert_string(saved, "5004");
+    cini_group_end(&cini);
+    cini_release(&cini);
+    cini_arena_reset(&arena);
+    free(storage);
+
+    free(content);
+    free(saved);
+    remove(CINI_TEST_FILE);
+    remove(CINI_TEST_FILE ".out");
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_layers(int argc, char **argv)
+{
+#ifdef __C_PLATFORM_LINUX
+    const char *paths[] = {CINI_TEST_FILE, "test_env.ini"};
+    char        buffer[64];
+    size_t      layer = 0;
+
+    mkdir("test.d", 0755);
+    ctest_file_write(CINI_TEST_FILE, "include=test_site.ini\n[net]\nport=3\n");
+    ctest_file_write("test_site.ini", "include = test.d\n[net]\nport=2\nhost=site\n[log]\nlevel=2\n");
+    ctest_file_write("test.d/20-b.ini", "[log]\nlevel=20\n");
+    ctest_file_write("test.d/10-a.ini", "[log]\nlevel=10\nfile=a\n");
+    ctest_file_write("test.d/skip.txt", "[log]\nlevel=99\n");
+    ctest_file_write("test_env.ini", "[log]\nlevel=5\n[env]\nname=prod\n");
+
+    // 层: test.d/10-a.ini, test.d/20-b.ini, test_site.ini, test.ini, test_env.ini
+    cini_doc_t *doc = cini_doc_load_layers(paths, 2);
+    ctest_assert_bool(doc != NULL && cini_doc_layer_count(doc) == 5);
+    ctest_assert_string(cini_doc_layer_path(doc, 0), "test.d/10-a.ini");
+    ctest_assert_string(cini_doc_layer_path(doc, 3), CINI_TEST_FILE);
+    ctest_assert_bool(cini_doc_layer_path(doc, 5) == NULL);
+
+    cini_doc_value_get(doc, "net", "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "3");
+    ctest_assert_bool(cini_doc_value_layer(doc, "net", "port", &layer) && layer == 3);
+    cini_doc_value_get(doc, "net", "host", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "site");
+    ctest_assert_bool(cini_doc_value_layer(doc, "net", "host", &layer) && layer == 2);
+    cini_doc_value_get(doc, "log", "level", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "5");
+    ctest_assert_bool(cini_doc_value_layer(doc, "log", "file", &layer) && layer == 0);
+    ctest_assert_bool(cini_doc_value_layer(doc, "env", "name", &layer) && layer == 4);
+    ctest_assert_bool(!cini_doc_value_contains(doc, "", "include"));
+
+    // 在内存中修改的值不属于任何层
+    ctest_assert_bool(cini_doc_value_set(doc, "net", "port", "4"));
+    ctest_assert_bool(!cini_doc_value_layer(doc, "net", "port", &layer));
+    cini_doc_free(doc);
+
+    // 循环包含与缺失的层
+    ctest_file_write("test_env.ini", "include=test_env.ini\n");
+    ctest_assert_bool(cini_doc_load_layers(paths, 2) == NULL);
+    ctest_file_write("test_env.ini", "include=test_missing.ini\n");
+    ctest_assert_bool(cini_doc_load_layers(paths, 2) == NULL);
+
+    remove(CINI_TEST_FILE);
+    remove("test_site.ini");
+    remove("test_env.ini");
+    remove("test.d/20-b.ini");
+    remove("test.d/10-a.ini");
+    remove("test.d/skip.txt");
+    rmdir("test.d");
+#endif
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_behind(int argc, char **argv)
+{
+#ifdef __C_PLATFORM_LINUX
+    char   buffer[256];
+    cini_t cini = CINI_NULL;
+
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=1\n");
+    cini_path_set(&cini, CINI_TEST_FILE);
+    ctest_assert_bool(cini_behind_set(&cini, 3600000, 3));
+    ctest_assert_bool(!cini_txn_begin(&cini));
+
+    // 修改立即可见, 文件在写入前保持不变; 同一个键的多次修改只计一次
+    cini_group_begin(&cini, "net");
+    cini_value_set(&cini, "port", "2");
+    cini_value_set(&cini, "port", "3");
+    cini_value_set(&cini, "host", "a");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "3");
+    usleep(50000);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nport=1\n");
+
+    // 第三个不同的键触发写入
+    cini_value_set(&cini, "mode", "b");
+    for (int wait = 0; wait < 200; ++wait) {
+        ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+        if (strcmp(buffer, "[net]\nport=1\n") != 0) {
+            break;
+        }
+        usleep(10000);
+    }
+    ctest_assert_string(buffer, "[net]\nport=3\nhost=a\nmode=b\n");
+
+    // 显式写入
+    cini_value_remove(&cini, "host");
+    ctest_assert_bool(cini_flush(&cini));
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nport=3\nmode=b\n");
+    cini_group_end(&cini);
+
+    // 按时间写入
+    ctest_assert_bool(cini_behind_set(&cini, 20, 0));
+    cini_group_begin(&cini, "net");
+    cini_value_set(&cini, "port", "4");
+    cini_group_end(&cini);
+    for (int wait = 0; wait < 200; ++wait) {
+        ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+        if (strcmp(buffer, "[net]\nport=3\nmode=b\n") != 0) {
+            break;
+        }
+        usleep(10000);
+    }
+    ctest_assert_string(buffer, "[net]\nport=4\nmode=b\n");
+
+    // 释放时写入剩余的修改
+    cini_group_begin(&cini, "net");
+    cini_value_set(&cini, "port", "5");
+    cini_group_end(&cini);
+    cini_release(&cini);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nport=5\nmode=b\n");
+
+    // 设置新建当前组后, 组内的键立即可读与移除
+    cini_path_set(&cini, CINI_TEST_FILE);
+    ctest_assert_bool(cini_behind_set(&cini, 3600000, 0));
+    cini_group_begin(&cini, "new");
+    ctest_assert_bool(!cini_value_contains(&cini, "k"));
+    cini_value_set(&cini, "k", "v");
+    cini_value_get(&cini, "k", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "v");
+    ctest_assert_bool(cini_value_contains(&cini, "k"));
+    cini_value_remove(&cini, "k");
+    ctest_assert_bool(!cini_value_contains(&cini, "k"));
+    cini_group_end(&cini);
+    cini_release(&cini);
+    remove(CINI_TEST_FILE);
+#endif
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_splice(int argc, char **argv)
+{
+#ifdef __C_PLATFORM_LINUX
+    char         buffer[256];
+    struct stat  before;
+    struct stat  after;
+    cini_stats_t stats;
+
+    // 长度不变的修改写在原位置, 文件不被替换
+    ctest_file_write(CINI_TEST_FILE, "[a]\nkey=1\n[b]\nport=80\nhost=x\n");
+    stat(CINI_TEST_FILE, &before);
+    cini_doc_t *doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && cini_doc_value_set(doc, "b", "port", "81"));
+    ctest_assert_bool(cini_doc_save_mode(doc, CINI_TEST_FILE, CINI_SAVE_SPLICE | CINI_SAVE_SYNC));
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[a]\nkey=1\n[b]\nport=81\nhost=x\n");
+    stat(CINI_TEST_FILE, &after);
+    ctest_assert_bool(before.st_ino == after.st_ino);
+
+    // 文件变长时改写其后的内容; 文件会变短时整体重写, 不截断文件
+    ctest_assert_bool(cini_doc_value_set(doc, "b", "port", "8080"));
+    ctest_assert_bool(cini_doc_save_mode(doc, CINI_TEST_FILE, CINI_SAVE_SPLICE));
+    stat(CINI_TEST_FILE, &after);
+    ctest_assert_bool(before.st_ino == after.st_ino);
+    cini_doc_t *other = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(cini_doc_value_remove(doc, "b", "host"));
+    ctest_assert_bool(cini_doc_value_set(doc, "a", "key", "2"));
+    ctest_assert_bool(cini_doc_save_mode(doc, CINI_TEST_FILE, CINI_SAVE_SPLICE));
+    cini_doc_value_get(other, "b", "host", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "x");
+    cini_doc_free(other);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[a]\nkey=2\n[b]\nport=8080\n");
+    cini_doc_value_get(doc, "b", "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "8080");
+    stat(CINI_TEST_FILE, &after);
+    ctest_assert_bool(before.st_ino != after.st_ino);
+
+    // 整体重写后可继续原地改写
+    stat(CINI_TEST_FILE, &before);
+    ctest_assert_bool(cini_doc_value_set(doc, "a", "key", "5"));
+    ctest_assert_bool(cini_doc_save_mode(doc, CINI_TEST_FILE, CINI_SAVE_SPLICE));
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[a]\nkey=5\n[b]\nport=8080\n");
+    stat(CINI_TEST_FILE, &after);
+    ctest_assert_bool(before.st_ino == after.st_ino);
+
+    // 文件被外部修改后整体重写
+    ctest_file_write(CINI_TEST_FILE, "[a]\nkey=3\n");
+    ctest_assert_bool(cini_doc_value_set(doc, "a", "key", "4"));
+    ctest_assert_bool(cini_doc_save_mode(doc, CINI_TEST_FILE, CINI_SAVE_SPLICE));
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[a]\nkey=4\n[b]\nport=8080\n");
+    stat(CINI_TEST_FILE, &after);
+    ctest_assert_bool(before.st_ino != after.st_ino);
+    cini_doc_free(doc);
+
+    // 进程内其他文档映射着文件时整体重写, 其他文档的内容与值视图不变
+    const char *view = NULL;
+    size_t      size = 0;
+    ctest_file_write(CINI_TEST_FILE, "[a]\nx=1\n[b]\ny=hello\n");
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL && cini_doc_value_view(doc, "a", "x", &view, &size));
+    cini_t cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_save_mode_set(&cini, CINI_SAVE_SPLICE);
+    cini_group_begin(&cini, "a");
+    cini_value_set(&cini, "x", "2");
+    cini_group_end(&cini);
+    ctest_assert_bool(size == 1 && view[0] == '1');
+    cini_doc_free(doc);
+    doc = cini_doc_load(CINI_TEST_FILE);
+    ctest_assert_bool(doc != NULL);
+    cini_group_begin(&cini, "a");
+    cini_value_set(&cini, "x", "123456");
+    cini_group_end(&cini);
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.splices == 0 && stats.renames == 2);
+    cini_doc_value_get(doc, "b", "y", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "hello");
+    cini_doc_free(doc);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[a]\nx=123456\n[b]\ny=hello\n");
+
+    // 没有其他文档映射时原地改写
+    cini_group_begin(&cini, "b");
+    cini_value_set(&cini, "y", "world");
+    cini_group_end(&cini);
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.splices == 1 && stats.renames == 2);
+    cini_release(&cini);
+
+    // 修改大文件末尾的键只写入末尾的内容
+    const size_t max     = 1 << 20;
+    char        *content = (char *)malloc(max);
+    size_t       length  = 0;
+    for (int index = 0; index < 10000; ++index) {
+        length += (size_t)snprintf(content + length, max - length, "[group_%d]\nkey=%d\n", index, index);
+    }
+    snprintf(content + length, max - length, "[last]\nkey=end\n");
+    ctest_file_write(CINI_TEST_FILE, content);
+
+    cini = CINI_NULL;
+    cini_path_set(&cini, CINI_TEST_FILE);
+    cini_save_mode_set(&cini, CINI_SAVE_SPLICE);
+    cini_group_begin(&cini, "last");
+    cini_value_set(&cini, "key", "tail");
+    cini_group_end(&cini);
+    cini_stats_get(&cini, &stats);
+    ctest_assert_bool(stats.splices == 1 && stats.renames == 0 && stats.bytes_written == sizeof("key=tail\n") - 1);
+    cini_group_begin(&cini, "group_0");
+    cini_value_set(&cini, "key", "zero");
+    cini_value_get(&cini, "key", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "zero");
+    cini_group_end(&cini);
+    cini_group_begin(&cini, "last");
+    cini_value_get(&cini, "key", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "tail");
+    cini_group_end(&cini);
+    cini_release(&cini);
+
+    free(content);
+    remove(CINI_TEST_FILE);
+#endif
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+int ctest_func_cini_journal(int argc, char **argv)
+{
+#ifdef __C_PLATFORM_LINUX
+    char        buffer[256];
+    struct stat st;
+    cini_t      cini = CINI_NULL;
+
+    // 启用时应用已有的日志, 丢弃末尾不完整的记录
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=1\n");
+    ctest_file_write(CINI_TEST_FILE ".journal", "=3,4,1:netport5\n=3,4,1:nethostb\n-3,4:nethost\n=3,4,2:netpo");
+    cini_path_set(&cini, CINI_TEST_FILE);
+    ctest_assert_bool(cini_journal_set(&cini, 1 << 20));
+    ctest_assert_bool(!cini_txn_begin(&cini) && !cini_behind_set(&cini, 10, 0));
+    cini_group_begin(&cini, "net");
+    cini_value_get(&cini, "port", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "5");
+    ctest_assert_bool(!cini_value_contains(&cini, "host"));
+    ctest_file_read(CINI_TEST_FILE ".journal", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "=3,4,1:netport5\n=3,4,1:nethostb\n-3,4:nethost\n");
+
+    // 修改只追加到日志, 配置文件不变
+    cini_value_set(&cini, "host", "a=b");
+    cini_value_remove(&cini, "port");
+    cini_value_int_set(&cini, "retry", 3);
+    cini_group_end(&cini);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nport=1\n");
+    ctest_file_read(CINI_TEST_FILE ".journal", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "=3,4,1:netport5\n=3,4,1:nethostb\n-3,4:nethost\n=3,4,3:nethosta=b\n-3,4:netport\n"
+                                "=3,5,1:netretry3\n");
+
+    // 合并后日志为空
+    ctest_assert_bool(cini_flush(&cini));
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nhost=a=b\nretry=3\n");
+    ctest_assert_bool(stat(CINI_TEST_FILE ".journal", &st) == 0 && st.st_size == 0);
+
+    // 日志超过阈值时由后台线程合并
+    ctest_assert_bool(cini_journal_set(&cini, 64));
+    cini_group_begin(&cini, "net");
+    for (int index = 0; index < 100; ++index) {
+        cini_value_int_set(&cini, "retry", index);
+    }
+    cini_group_end(&cini);
+    for (int wait = 0; wait < 200; ++wait) {
+        ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+        if (strcmp(buffer, "[net]\nhost=a=b\nretry=3\n") != 0) {
+            break;
+        }
+        usleep(10000);
+    }
+    ctest_assert_bool(strcmp(buffer, "[net]\nhost=a=b\nretry=3\n") != 0);
+
+    // 释放时合并并移除日志
+    cini_release(&cini);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nhost=a=b\nretry=99\n");
+    ctest_assert_bool(stat(CINI_TEST_FILE ".journal", &st) != 0);
+
+    // 大文档中新增与移除键只追加记录, 不遍历所有行
+    const size_t max     = 4 << 20;
+    char        *content = (char *)malloc(max);
+    size_t       length  = 0;
+    for (int index = 0; index < 100000; ++index) {
+        length += (size_t)snprintf(content + length, max - length, "[group_%d]\nkey=%d\n", index, index);
+    }
+    ctest_file_write(CINI_TEST_FILE, content);
+    free(content);
+
+    // 逐条修改只增加日志记录的字节数, 不重新解析也不重写文件
+    cini_stats_t before;
+    cini_stats_t after;
+    size_t       appended = 0;
+    ctest_assert_bool(cini_journal_set(&cini, (size_t)1 << 30));
+    cini_stats_get(&cini, &before);
+    for (int index = 0; index < 2000; ++index) {
+        char key[32];
+        const int size = snprintf(key, sizeof(key), "new_%d", index);
+        cini_group_begin(&cini, "group_0");
+        cini_value_set(&cini, key, "1");
+        appended += (size_t)snprintf(buffer, sizeof(buffer), "=7,%d,1:group_0%s1\n", size, key);
+        if (index % 2) {
+            cini_value_remove(&cini, key);
+            appended += (size_t)snprintf(buffer, sizeof(buffer), "-7,%d:group_0%s\n", size, key);
+        }
+        cini_group_end(&cini);
+    }
+    cini_stats_get(&cini, &after);
+    ctest_assert_bool(after.lines_scanned == before.lines_scanned && after.files_opened == before.files_opened);
+    ctest_assert_bool(after.rewrites == before.rewrites && after.renames == before.renames);
+    ctest_assert_bool(after.bytes_written - before.bytes_written == appended);
+    ctest_assert_bool(stat(CINI_TEST_FILE ".journal", &st) == 0 && (size_t)st.st_size == appended);
+    cini_group_begin(&cini, "group_0");
+    ctest_assert_bool(cini_value_contains(&cini, "new_1998") && !cini_value_contains(&cini, "new_1999"));
+    cini_group_end(&cini);
+
+    // 设置新建当前组后, 组内的键立即可读与移除
+    cini_group_begin(&cini, "new");
+    ctest_assert_bool(!cini_value_contains(&cini, "k"));
+    cini_value_set(&cini, "k", "v");
+    cini_value_get(&cini, "k", "", buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "v");
+    ctest_assert_bool(cini_value_contains(&cini, "k"));
+    cini_value_remove(&cini, "k");
+    ctest_assert_bool(!cini_value_contains(&cini, "k"));
+    cini_group_end(&cini);
+    cini_release(&cini);
+
+    // 合并失败后间隔一段时间再重试, 期间的修改只追加到日志
+    ctest_file_write(CINI_TEST_FILE, "[net]\nport=1\n");
+    ctest_assert_bool(cini_journal_set(&cini, 16));
+    remove(CINI_TEST_FILE);
+    mkdir(CINI_TEST_FILE, 0755);
+    cini_stats_get(&cini, &before);
+    cini_group_begin(&cini, "net");
+    for (int index = 0; index < 20; ++index) {
+        cini_value_int_set(&cini, "port", index);
+        usleep(10000);
+    }
+    cini_group_end(&cini);
+    cini_stats_get(&cini, &after);
+    ctest_assert_bool(after.rewrites - before.rewrites >= 1 && after.rewrites - before.rewrites <= 3);
+    rmdir(CINI_TEST_FILE);
+    cini_release(&cini);
+    ctest_file_read(CINI_TEST_FILE, buffer, sizeof(buffer));
+    ctest_assert_string(buffer, "[net]\nport=19\n");
+    remove(CINI_TEST_FILE);
+#endif
+    return 0;
+    __c_unused(argc);
+    __c_unused(argv);
+}
+
+// -------------------------[STATIC DEFINITION]-------------------------
+
+static inline void ctest_file_write(const char *path, const char *content)
+{
+    FILE *fd = fopen(path, "wb");
+    if (fd) {
+        fputs(content, fd);
+        fclose(fd);
+    }
+}
+
+static inline void ctest_file_read(const char *path, char *buffer, size_t max)
+{
+    buffer[0] = '\0';
+    FILE *fd  = fopen(path, "rb");
+    if (fd) {
+        const size_t length = fread(buffer, 1, max - 1, fd);
+        buffer[length]      = '\0';
+        fclose(fd);
+    }
+}
+
+static void ctest_watch_func(const char *group, const char *key, const char *old_value, const char *new_value,
+                             void *arg)
+{
+    ctest_watch_record_t *record = (ctest_watch_record_t *)arg;
+    snprintf(record->last, sizeof(record->last), "%s.%s:%s->%s", group, key, old_value ? old_value : "(null)",
+             new_value ? new_value : "(null)");
+    __atomic_add_fetch(&record->count, 1, __ATOMIC_RELEASE);
+}
+
+static void ctest_diff_count(const cini_change_t *change, void *arg)
+{
+    ++*(int *)arg;
+    __c_unused(change);
+}
+
+static void *ctest_snap_reader(void *arg)
+{
+    cini_snap_reader_t *reader = cini_snap_reader_create((cini_snap_t *)arg);
+    char                a[32]  = {0};
+    char                b[32]  = {0};
+    void               *result = reader ? NULL : arg;
+
+    while (reader && strcmp(a, "stop") != 0) {
+        cini_doc_t *doc = cini_snap_enter(reader);
+        cini_doc_value_get(doc, "snap", "a", "", a, sizeof(a));
+        cini_doc_value_get(doc, "snap", "b", "", b, sizeof(b));
+        cini_snap_leave(reader);
+        if (strcmp(a, b) != 0) {
+            result = arg;
+            break;
+        }
+    }
+    cini_snap_reader_free(reader);
+    return result;
+}
+
+static bool ctest_stream_entry(const cini_entry_t *entry, void *arg)
+{
+    ctest_stream_record_t *record = (ctest_stream_record_t *)arg;
+    if (!entry->key) {
+        ++record->sections;
+        return true;
+    }
+    ++record->pairs;
+    if (entry->value_size > record->value_size) {
+        record->value_size = entry->value_size;
+    }
+    snprintf(record->last, sizeof(record->last), "%.*s%s%.*s=%.*s", (int)entry->group_size,
+             entry->group ? entry->group : "", entry->group ? "." : "", (int)entry->key_size, entry->key,
+             (int)(entry->value_size < 64 ? entry->value_size : 64), entry->value);
+    return record->pairs != record->stop;
+}
+
+static bool ctest_stream_comment(const char *text, size_t size, void *arg)
+{
+    ctest_stream_record_t *record = (ctest_stream_record_t *)arg;
+    ++record->comments;
+    return text[0] == ';' || text[0] == '#' || size == 0;
+}
+
+static void *ctest_alloc(void *arg, size_t size)
+{
+    ++((ctest_alloc_count_t *)arg)->allocs;
+    return malloc(size);
+}
+
+static void ctest_free(void *arg, void *ptr)
+{
+    ++((ctest_alloc_count_t *)arg)->frees;
+    free(ptr);
+}
+
+#ifdef __C_PLATFORM_LINUX
+static bool ctest_file_mapped(const char *name)
+{
+    char  line[1024];
+    bool  mapped = false;
+    FILE *maps   = fopen("/proc/self/maps", "r");
+    if (!maps) {
+        return false;
+    }
+    const size_t length = strlen(name);
+    while (!mapped && fgets(line, sizeof(line), maps)) {
+        // 路径在行末, 已删除的文件带 " (deleted)" 后缀
+        const char *path = strrchr(line, '/');
+        if (path && strncmp(path + 1, name, length) == 0) {
+            mapped = path[length + 1] == '\n' || path[length + 1] == ' ';
+        }
+    }
+    fclose(maps);
+    return mapped;
+}
+
+static int ctest_thread_count(void)
+{
+    char  line[256];
+    int   count  = 0;
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), status)) {
+        if (sscanf(line, "Threads: %d", &count) == 1) {
+            break;
+        }
+    }
+    fclose(status);
+    return count;
+}
+#endif
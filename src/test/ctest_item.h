@@ -22,5 +22,24 @@
 #include "ctest_define.h"
 
 C_TEST_FUNC_DECL(cini);
+C_TEST_FUNC_DECL(cini_doc);
+C_TEST_FUNC_DECL(cini_txn);
+C_TEST_FUNC_DECL(cini_cache);
+C_TEST_FUNC_DECL(cini_watch);
+C_TEST_FUNC_DECL(cini_snap);
+C_TEST_FUNC_DECL(cini_image);
+C_TEST_FUNC_DECL(cini_scan);
+C_TEST_FUNC_DECL(cini_typed);
+C_TEST_FUNC_DECL(cini_stream);
+C_TEST_FUNC_DECL(cini_stats);
+C_TEST_FUNC_DECL(cini_io);
+C_TEST_FUNC_DECL(cini_arena);
+C_TEST_FUNC_DECL(cini_intern);
+C_TEST_FUNC_DECL(cini_key);
+C_TEST_FUNC_DECL(cini_parallel);
+C_TEST_FUNC_DECL(cini_layers);
+C_TEST_FUNC_DECL(cini_behind);
+C_TEST_FUNC_DECL(cini_splice);
+C_TEST_FUNC_DECL(cini_journal);
 
 #endif
\ No newline at end of file
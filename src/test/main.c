@@ -38,6 +38,25 @@
 
 static const ctest_item_t ctest_item_all[] = {
     C_TEST_FUNC_ITEM(cini),
+    C_TEST_FUNC_ITEM(cini_doc),
+    C_TEST_FUNC_ITEM(cini_txn),
+    C_TEST_FUNC_ITEM(cini_cache),
+    C_TEST_FUNC_ITEM(cini_watch),
+    C_TEST_FUNC_ITEM(cini_snap),
+    C_TEST_FUNC_ITEM(cini_image),
+    C_TEST_FUNC_ITEM(cini_scan),
+    C_TEST_FUNC_ITEM(cini_typed),
+    C_TEST_FUNC_ITEM(cini_stream),
+    C_TEST_FUNC_ITEM(cini_stats),
+    C_TEST_FUNC_ITEM(cini_io),
+    C_TEST_FUNC_ITEM(cini_arena),
+    C_TEST_FUNC_ITEM(cini_intern),
+    C_TEST_FUNC_ITEM(cini_key),
+    C_TEST_FUNC_ITEM(cini_parallel),
+    C_TEST_FUNC_ITEM(cini_layers),
+    C_TEST_FUNC_ITEM(cini_behind),
+    C_TEST_FUNC_ITEM(cini_splice),
+    C_TEST_FUNC_ITEM(cini_journal),
 };
 
 #define ctest_item_count       __c_array_size(ctest_item_all)